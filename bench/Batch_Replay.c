@@ -0,0 +1,246 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Command batch replay
+
+  Runs pipelined command batches (AT_Cmd_BatchBegin) through the AT command
+  parser on a host. The serial driver is replaced by a scripted modem: each
+  command sent by the parser is answered with the next scripted final
+  response once the parser has sent all commands the pipeline allows.
+
+    - batch answered with OK/ERROR/OK/OK: per-command results, a single
+      AT_NOTIFY_RESPONSE_GENERIC and MOD_EG915U_CMD_PIPELINE_DEPTH commands
+      in flight
+    - batch ended before all responses arrived (Modem_BatchWait timeout):
+      late responses are discarded, response of the next single command is
+      reported, commands not sent yet are dropped
+
+  Build and run (command batches require pipeline depth above 1):
+    make -C bench batch DEPTH=4
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "EG915U.h"
+#include "EG915U_Serial.h"
+#include "Modem_EG915U_Os.h"
+
+#include "host_bench.h"
+#include "host_serial.h"
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH < 2)
+#error "Command batch replay requires MOD_EG915U_CMD_PIPELINE_DEPTH above 1"
+#endif
+
+/* Scripted modem */
+typedef struct {
+  uint32_t cmd_sent;          /* Command lines sent by the parser     */
+  uint32_t cmd_resp;          /* Command lines answered               */
+  uint32_t inflight_max;      /* Commands in flight (peak)            */
+  uint32_t generic;           /* AT_NOTIFY_RESPONSE_GENERIC count     */
+} MODEM_SIM;
+
+static MODEM_SIM Sim;
+
+/* ---------------------------------------------------------------------------
+   Scripted modem
+   ------------------------------------------------------------------------- */
+
+/* Transmit hook: count command lines, modem answers them in order */
+static void ModemTx (const uint8_t *buf, uint32_t len) {
+  uint32_t i;
+
+  for (i = 0U; i < len; i++) {
+    if (buf[i] == '\n') {
+      Sim.cmd_sent++;
+    }
+  }
+
+  if (Sim.inflight_max < (Sim.cmd_sent - Sim.cmd_resp)) {
+    Sim.inflight_max = Sim.cmd_sent - Sim.cmd_resp;
+  }
+}
+
+/* Drop response lines not read by the application */
+static void RespDrop (void) {
+  uint8_t buf[16];
+
+  (void)AT_Resp_GetVersion (buf, sizeof(buf));
+}
+
+void AT_Notify (uint32_t event, void *arg) {
+  (void)arg;
+
+  if (event == AT_NOTIFY_RESPONSE_GENERIC) {
+    Sim.generic++;
+
+    RespDrop();
+  }
+}
+
+/* Answer the oldest command in flight and let the parser process it */
+static void ModemRespond (const char *resp) {
+  char     buf[32];
+  uint32_t len;
+
+  len = (uint32_t)snprintf (buf, sizeof(buf), "\r\n%s\r\n", resp);
+
+  Host_SerialRxPut ((const uint8_t *)buf, len);
+  Sim.cmd_resp++;
+
+  AT_Parser_Execute();
+}
+
+/* Run parser until it sends no more commands */
+static void ModemIdle (void) {
+  uint32_t n;
+
+  do {
+    n = Sim.cmd_sent;
+
+    AT_Parser_Execute();
+  }
+  while (n != Sim.cmd_sent);
+}
+
+/* Queue four configuration commands into a new batch */
+static int32_t BatchQueue (void) {
+  int32_t rval;
+
+  rval  = AT_Cmd_BatchBegin();
+  if (rval == 0) {
+    rval |= AT_Cmd_HTTP_Config (HTTP_OPTION_CONTEXT_ID, (void *)1);
+    rval |= AT_Cmd_HTTP_Config (HTTP_OPTION_REQUESTHEADER, (void *)1);
+    rval |= AT_Cmd_SSL_Config  (SSL_CONFIG_VERSION, 1U, (void *)SSL_PARAM_VERSION_ALL);
+    rval |= AT_Cmd_SSL_Config  (SSL_CONFIG_SECLEVEL, 1U, (void *)SSL_PARAM_SECLEVEL_FREE);
+  }
+  return (rval);
+}
+
+/* Batch answered with OK/ERROR/OK/OK */
+static uint32_t Test_Batch (void) {
+  static const char *script[4] = { "OK", "ERROR", "OK", "OK" };
+  uint32_t i, fail, sent;
+
+  fail = 0U;
+
+  memset (&Sim, 0, sizeof(Sim));
+  Host_SerialRxFlush();
+
+  fail += Check ("batch queued",        BatchQueue() == 0);
+  fail += Check ("batch submitted",     AT_Cmd_BatchSubmit() == 4);
+
+  ModemIdle();
+
+  sent = Sim.cmd_sent;
+
+  for (i = 0U; i < 4U; i++) {
+    ModemRespond (script[i]);
+    ModemIdle();
+  }
+
+  fail += Check ("commands in flight",  (sent == ((MOD_EG915U_CMD_PIPELINE_DEPTH < 4) ? MOD_EG915U_CMD_PIPELINE_DEPTH : 4)) &&
+                                        (Sim.inflight_max == sent));
+  fail += Check ("all commands sent",   Sim.cmd_sent == 4U);
+  fail += Check ("results OK/ERROR/OK/OK", (AT_Resp_Batch (0U) == AT_RESP_OK)    &&
+                                        (AT_Resp_Batch (1U) == AT_RESP_ERROR) &&
+                                        (AT_Resp_Batch (2U) == AT_RESP_OK)    &&
+                                        (AT_Resp_Batch (3U) == AT_RESP_OK));
+  fail += Check ("single generic notify", Sim.generic == 1U);
+  fail += Check ("batch end count",     AT_Cmd_BatchEnd() == 4);
+
+  return (fail);
+}
+
+/* Batch ended after the first response, as on Modem_BatchWait timeout */
+static uint32_t Test_Drain (void) {
+  uint32_t i, fail, late, sent;
+
+  fail = 0U;
+
+  memset (&Sim, 0, sizeof(Sim));
+  Host_SerialRxFlush();
+
+  BatchQueue();
+  AT_Cmd_BatchSubmit();
+
+  ModemIdle();
+  ModemRespond ("OK");
+
+  /* Application gives up, following commands must not be sent */
+  sent = Sim.cmd_sent;
+
+  fail += Check ("drain end count",     AT_Cmd_BatchEnd() == 1);
+
+  ModemIdle();
+
+  late = Sim.cmd_sent - Sim.cmd_resp;
+
+  fail += Check ("drain stops sending", Sim.cmd_sent == sent);
+  fail += Check ("drain blocks new batch", (late == 0U) || (AT_Cmd_BatchBegin() == -1));
+
+  /* Next single command is sent before the late responses arrive */
+  AT_Cmd_HTTP_Config (HTTP_OPTION_RESPONSEHEADER, (void *)1);
+
+  for (i = 0U; i < late; i++) {
+    ModemRespond ("OK");
+  }
+
+  fail += Check ("late responses discarded", Sim.generic == 0U);
+
+  ModemRespond ("ERROR");
+
+  fail += Check ("single command response", (Sim.generic == 1U) && (AT_Resp_Generic() == AT_RESP_ERROR));
+
+  /* Batch is available again */
+  fail += Check ("new batch after drain", BatchQueue() == 0);
+
+  AT_Cmd_BatchEnd();
+
+  return (fail);
+}
+
+int main (void) {
+  uint32_t fail;
+
+  if (AT_Parser_Initialize() < 0) {
+    fprintf (stderr, "parser initialization failed\n");
+    return (1);
+  }
+
+  printf ("pipeline depth %d\n", MOD_EG915U_CMD_PIPELINE_DEPTH);
+
+  Host_SerialTxHook (ModemTx);
+
+  fail  = Test_Batch();
+  fail += Test_Drain();
+
+  AT_Parser_Uninitialize();
+
+  printf ("%s\n", (fail == 0U) ? "PASSED" : "FAILED");
+
+  return ((fail == 0U) ? 0 : 1);
+}
@@ -0,0 +1,385 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  BufList microbenchmark suite
+
+  Measures ns/op and MB/s of the buffer layer operations used by the
+  parser and the socket path for block sizes 128 to 4096 bytes:
+
+    write      BufWrite of a payload into an empty list
+    read       BufRead of a buffered payload
+    copy       BufCopy between lists using different pools (byte copy)
+    copy_pool  BufCopy between lists sharing the pool (block relink)
+    flush      BufFlush of a buffered payload
+    find_crlf  BufFind of CRLF at the end of the payload
+    find_line  BufFindLine of the same CRLF using the line index
+    cmp_plus   BufCompareString over the List_PlusResp table, as done by
+               GetCommandCode, with the line crossing a block boundary
+
+  Usage:
+    buflist_bench [--json] [--label <name>]
+
+  With --json results are printed as one JSON document, suitable to be
+  stored and compared between revisions.
+
+  Build:
+    make -C bench buflist_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "BufList.h"
+
+#include "host_bench.h"
+
+/* Payload size and number of payloads buffered per measurement round */
+#define PAYLOAD_SIZE     4096U
+#define BATCH            64U
+
+/* Number of measurement rounds (destructive operations) */
+#define ROUNDS           200U
+
+/* Number of iterations (non-destructive operations) */
+#define ITERATIONS       20000U
+
+/* Mirror of the parser List_PlusResp table (EG915U.c) */
+static const char *const List_PlusResp[] = {
+  "IPD",       "CWLAP",      "CWJAP",     "CWQAP",     "CWSAP",
+  "CWHOSTNAME","CIPSTAMAC",  "CIPAPMAC",  "CSQ",       "QIACT",
+  "CIPAP",     "CIPDNS",     "CWAUTOCONN","CWLIF",     "UART_CUR",
+  "SYSMSG",    "CIPSTATUS",  "CIPDOMAIN", "QIOPEN",    "QICLOSE",
+  "QPING",     "QISEND",     "CIPMUX",    "CIPSERVER", "CIPSERVERMAXCONN",
+  "RST",       "ATI",        "LINK_CONN", "STA_CONNECTED",
+  "STA_DISCONNECTED",        "QSCLK",     "CPIN",      "CSQ",
+  "QICSGP",    "QIACT",      "QIDEACT",   "QHTTPCFG",  "QHTTPURL",
+  "QHTTPPOST", "QHTTPREAD",  "QHTTPGET",  "QSSLCFG",   "IPR",
+  "E",         ""
+};
+
+#define PLUS_NUM         (sizeof(List_PlusResp) / sizeof(List_PlusResp[0]))
+
+/* Response lines looked up by cmp_plus, early, middle and late table entries */
+static const char *const Lines[] = {
+  "+IPD,0,1460:",
+  "+CSQ: 23,99\r\n",
+  "+QIOPEN: 0,0\r\n",
+  "+QHTTPGET: 0,200,4096\r\n",
+  "+QSSLCFG: \"sslversion\",1,4\r\n",
+};
+
+#define LINES_NUM        (sizeof(Lines) / sizeof(Lines[0]))
+
+static const uint32_t Block_Size[] = { 128U, 256U, 512U, 1024U, 2048U, 4096U };
+
+#define BLOCK_NUM        (sizeof(Block_Size) / sizeof(Block_Size[0]))
+
+/* Single measurement result */
+typedef struct {
+  const char *op;
+  uint32_t    bl_sz;
+  double      ns;
+  double      mbs;
+} RESULT;
+
+static RESULT   Result[BLOCK_NUM * 9U];
+static uint32_t Result_Num;
+
+static uint8_t Payload[PAYLOAD_SIZE];
+static uint8_t Scratch[PAYLOAD_SIZE];
+
+static volatile int32_t Sink;
+
+/* Record result of num operations on bytes each, taking ns nanoseconds */
+static void Record (const char *op, uint32_t bl_sz, double ns, uint32_t num, uint32_t bytes) {
+  RESULT *r = &Result[Result_Num++];
+
+  r->op    = op;
+  r->bl_sz = bl_sz;
+  r->ns    = ns / num;
+  r->mbs   = ((double)bytes * 1e3) / r->ns;
+}
+
+/* Number of pool blocks required to buffer one batch of payloads */
+static uint32_t BatchBlocks (uint32_t bl_sz) {
+  return (((BATCH * PAYLOAD_SIZE) / (bl_sz - 32U)) + BATCH + 2U);
+}
+
+/* BufWrite, BufRead and BufFlush */
+static void Bench_WriteRead (uint32_t bl_sz) {
+  osMemoryPoolId_t mp_id;
+  BUF_LIST list;
+  double   t0, t_wr, t_rd, t_fl;
+  uint32_t k, i;
+
+  mp_id = osMemoryPoolNew (BatchBlocks (bl_sz), bl_sz, NULL);
+  BufInit (mp_id, NULL, &list);
+
+  t_wr = 0.0;
+  t_rd = 0.0;
+  t_fl = 0.0;
+
+  for (k = 0U; k < ROUNDS; k++) {
+    t0 = TimeNs();
+    for (i = 0U; i < BATCH; i++) {
+      Sink = BufWrite (Payload, PAYLOAD_SIZE, &list);
+    }
+    t_wr += TimeNs() - t0;
+
+    t0 = TimeNs();
+    for (i = 0U; i < BATCH; i++) {
+      Sink = BufRead (Scratch, PAYLOAD_SIZE, &list);
+    }
+    t_rd += TimeNs() - t0;
+
+    for (i = 0U; i < BATCH; i++) {
+      BufWrite (Payload, PAYLOAD_SIZE, &list);
+    }
+
+    t0 = TimeNs();
+    for (i = 0U; i < BATCH; i++) {
+      Sink = (int32_t)BufFlush (PAYLOAD_SIZE, &list);
+    }
+    t_fl += TimeNs() - t0;
+  }
+
+  Record ("write", bl_sz, t_wr, ROUNDS * BATCH, PAYLOAD_SIZE);
+  Record ("read",  bl_sz, t_rd, ROUNDS * BATCH, PAYLOAD_SIZE);
+  Record ("flush", bl_sz, t_fl, ROUNDS * BATCH, PAYLOAD_SIZE);
+
+  BufUninit (&list);
+  osMemoryPoolDelete (mp_id);
+}
+
+/* BufCopy with different or shared pools */
+static void Bench_Copy (uint32_t bl_sz, uint32_t shared) {
+  osMemoryPoolId_t mp_src, mp_dst;
+  BUF_LIST src, dst;
+  double   t0, t;
+  uint32_t k, i;
+
+  mp_src = osMemoryPoolNew (BatchBlocks (bl_sz) * 2U, bl_sz, NULL);
+  mp_dst = mp_src;
+
+  if (shared == 0U) {
+    mp_dst = osMemoryPoolNew (BatchBlocks (bl_sz), bl_sz, NULL);
+  }
+
+  BufInit (mp_src, NULL, &src);
+  BufInit (mp_dst, NULL, &dst);
+
+  t = 0.0;
+
+  for (k = 0U; k < ROUNDS; k++) {
+    for (i = 0U; i < BATCH; i++) {
+      BufWrite (Payload, PAYLOAD_SIZE, &src);
+    }
+
+    t0 = TimeNs();
+    for (i = 0U; i < BATCH; i++) {
+      Sink = (int32_t)BufCopy (&dst, &src, PAYLOAD_SIZE);
+    }
+    t += TimeNs() - t0;
+
+    BufFlush (0U, &dst);
+  }
+
+  Record ((shared != 0U) ? "copy_pool" : "copy", bl_sz, t, ROUNDS * BATCH, PAYLOAD_SIZE);
+
+  BufUninit (&dst);
+  BufUninit (&src);
+
+  if (shared == 0U) {
+    osMemoryPoolDelete (mp_dst);
+  }
+  osMemoryPoolDelete (mp_src);
+}
+
+/* BufFind (CRLF) and BufFindLine over a buffered payload */
+static void Bench_Find (uint32_t bl_sz) {
+  osMemoryPoolId_t mp_id;
+  BUF_LINE_INDEX lidx;
+  BUF_LIST list;
+  double   t0;
+  uint32_t it;
+
+  mp_id = osMemoryPoolNew (BatchBlocks (bl_sz), bl_sz, NULL);
+  BufInit (mp_id, NULL, &list);
+
+  /* Payload without CRLF, line terminator at the very end */
+  Payload[PAYLOAD_SIZE - 2U] = '\r';
+  Payload[PAYLOAD_SIZE - 1U] = '\n';
+
+  BufWrite (Payload, PAYLOAD_SIZE, &list);
+
+  t0 = TimeNs();
+  for (it = 0U; it < ITERATIONS; it++) {
+    Sink = BufFind ((const uint8_t *)"\r\n", 2U, &list);
+  }
+  Record ("find_crlf", bl_sz, TimeNs() - t0, ITERATIONS, PAYLOAD_SIZE);
+
+  /* Same lookup using the line index */
+  BufLineIndex (&lidx, &list);
+
+  t0 = TimeNs();
+  for (it = 0U; it < ITERATIONS; it++) {
+    Sink = BufFindLine (&list);
+  }
+  Record ("find_line", bl_sz, TimeNs() - t0, ITERATIONS, PAYLOAD_SIZE);
+
+  Payload[PAYLOAD_SIZE - 2U] = 'y';
+  Payload[PAYLOAD_SIZE - 1U] = 'z';
+
+  BufUninit (&list);
+  osMemoryPoolDelete (mp_id);
+}
+
+/* GetCommandCode like table scan using BufCompareString */
+static uint32_t CommandCode (BUF_LIST *p) {
+  uint32_t i;
+
+  for (i = 0U; i < PLUS_NUM; i++) {
+    if (BufCompareString (List_PlusResp[i], 1U, p) > 0) {
+      break;
+    }
+  }
+
+  return (i);
+}
+
+/* BufCompareString over the List_PlusResp table */
+static void Bench_Compare (uint32_t bl_sz) {
+  osMemoryPoolId_t mp_id;
+  BUF_LIST list;
+  double   t0, t;
+  uint32_t n, it, len, bytes, pad;
+
+  mp_id = osMemoryPoolNew (8U, bl_sz, NULL);
+  BufInit (mp_id, NULL, &list);
+
+  t     = 0.0;
+  bytes = 0U;
+
+  for (n = 0U; n < LINES_NUM; n++) {
+    len = (uint32_t)strlen (Lines[n]);
+
+    /* Place the line across the first block boundary */
+    pad = BufGetSize (&list) - (len / 2U);
+
+    BufWrite (Payload, pad, &list);
+    BufWrite ((uint8_t *)Lines[n], len, &list);
+    BufFlush (pad, &list);
+
+    t0 = TimeNs();
+    for (it = 0U; it < ITERATIONS; it++) {
+      Sink = (int32_t)CommandCode (&list);
+    }
+    t += TimeNs() - t0;
+
+    bytes += len;
+
+    BufFlush (0U, &list);
+  }
+
+  Record ("cmp_plus", bl_sz, t, ITERATIONS * LINES_NUM, bytes / LINES_NUM);
+
+  BufUninit (&list);
+  osMemoryPoolDelete (mp_id);
+}
+
+static void PrintText (void) {
+  uint32_t i;
+
+  printf ("BufList microbenchmarks, payload %u bytes\n", PAYLOAD_SIZE);
+  printf ("  %-10s %6s %12s %12s\n", "op", "block", "ns/op", "MB/s");
+
+  for (i = 0U; i < Result_Num; i++) {
+    printf ("  %-10s %6u %12.1f %12.1f\n",
+            Result[i].op, Result[i].bl_sz, Result[i].ns, Result[i].mbs);
+  }
+}
+
+static void PrintJson (const char *label) {
+  uint32_t i;
+
+  printf ("{\n");
+  printf ("  \"benchmark\": \"buflist\",\n");
+  printf ("  \"label\": \"%s\",\n", label);
+  printf ("  \"payload\": %u,\n", PAYLOAD_SIZE);
+  printf ("  \"results\": [\n");
+
+  for (i = 0U; i < Result_Num; i++) {
+    printf ("    { \"op\": \"%s\", \"block_size\": %u, \"ns_per_op\": %.1f, \"mb_per_s\": %.1f }%s\n",
+            Result[i].op, Result[i].bl_sz, Result[i].ns, Result[i].mbs,
+            ((i + 1U) < Result_Num) ? "," : "");
+  }
+
+  printf ("  ]\n");
+  printf ("}\n");
+}
+
+int main (int argc, char *argv[]) {
+  const char *label;
+  uint32_t json;
+  uint32_t i;
+  int      n;
+
+  json  = 0U;
+  label = "";
+
+  for (n = 1; n < argc; n++) {
+    if (strcmp (argv[n], "--json") == 0) {
+      json = 1U;
+    }
+    else if ((strcmp (argv[n], "--label") == 0) && ((n + 1) < argc)) {
+      label = argv[++n];
+    }
+    else {
+      fprintf (stderr, "usage: %s [--json] [--label <name>]\n", argv[0]);
+      return (1);
+    }
+  }
+
+  /* HTTP body like payload without CR, LF or '+' */
+  for (i = 0U; i < PAYLOAD_SIZE; i++) {
+    Payload[i] = (uint8_t)('a' + (i % 26U));
+  }
+
+  for (i = 0U; i < BLOCK_NUM; i++) {
+    Bench_WriteRead (Block_Size[i]);
+    Bench_Copy      (Block_Size[i], 0U);
+    Bench_Copy      (Block_Size[i], 1U);
+    Bench_Find      (Block_Size[i]);
+    Bench_Compare   (Block_Size[i]);
+  }
+
+  if (json != 0U) {
+    PrintJson (label);
+  } else {
+    PrintText ();
+  }
+
+  return (0);
+}
@@ -0,0 +1,255 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  BufList size class benchmark
+
+  Replays modem receive traffic through the same buffer flow the driver uses:
+  serial data is written into the parser buffer, response lines are copied
+  into the response list and socket payloads into the socket buffer, which
+  is read by the application after a few packets. Parser and response list
+  share one set of pools, sockets use their own, as in the driver.
+
+  Reports peak RAM pinned by the pools and by held response lines, block
+  hops per payload and throughput for single block size and small/large
+  size class setups.
+
+  Build:
+    gcc -O2 -Ibench/host -Isrc/BufList bench/BufPool_Bench.c \
+        src/BufList/BufList.c src/BufList/BufAllocator.c src/BufList/LinkList.c -o bufpool_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "BufList.h"
+
+#include "host_bench.h"
+
+/* Receive traffic entry: response line, optionally followed by payload */
+typedef struct {
+  const char *line;
+  uint32_t    payload;
+} TRACE_ENTRY;
+
+/* Session excerpt: registration polling, socket download, HTTP read */
+static const TRACE_ENTRY Trace[] = {
+  { "\r\nOK\r\n",                           0U },
+  { "\r\n+CREG: 0,1\r\n",                   0U },
+  { "\r\n+CSQ: 23,99\r\n",                  0U },
+  { "\r\nOK\r\n",                           0U },
+  { "\r\n+QIURC: \"recv\",0,1460\r\n",   1460U },
+  { "\r\n+QIURC: \"recv\",0,1460\r\n",   1460U },
+  { "\r\n+QIURC: \"recv\",0,536\r\n",     536U },
+  { "\r\nSEND OK\r\n",                      0U },
+  { "\r\n+QIURC: \"recv\",0,1460\r\n",   1460U },
+  { "\r\n+QIURC: \"recv\",0,88\r\n",       88U },
+  { "\r\n+QHTTPGET: 0,200,4096\r\n",        0U },
+  { "\r\nCONNECT\r\n",                   1024U },
+  { "\r\nOK\r\n",                           0U },
+  { "\r\n+QIURC: \"recv\",0,12\r\n",       12U },
+  { "\r\n+QIURC: \"recv\",0,1460\r\n",   1460U },
+  { "\r\n+QIURC: \"recv\",0,1460\r\n",   1460U },
+  { "\r\n+CSQ: 22,99\r\n",                  0U },
+  { "\r\nOK\r\n",                           0U },
+};
+
+#define TRACE_NUM        (sizeof(Trace) / sizeof(Trace[0]))
+#define REPEAT           2000U
+
+/* Serial receive burst size (ReceiveData span writes) */
+#define RX_BURST         256U
+
+/* Number of payloads buffered before the application reads socket data */
+#define SOCK_HOLD        4U
+
+/* Number of response lines held by the response list */
+#define RESP_HOLD        2U
+
+/* Pool setup under test */
+typedef struct {
+  const char *name;
+  uint32_t    sm_size;
+  uint32_t    sm_count;
+  uint32_t    lg_size;
+  uint32_t    lg_count;
+} POOL_SETUP;
+
+static const POOL_SETUP Setup[] = {
+  { "single 512",         512U, 64U,    0U,  0U },
+  { "single 2048",       2048U, 16U,    0U,  0U },
+  { "small 128/lg 1664",  128U, 64U, 1664U, 16U },
+  { "small 64/lg 1664",    64U, 96U, 1664U, 16U },
+};
+
+/* Pools of one list group */
+typedef struct {
+  osMemoryPoolId_t sm;
+  osMemoryPoolId_t lg;
+} POOL_PAIR;
+
+static uint8_t Scratch[4096];
+
+static void PoolNew (const POOL_SETUP *s, POOL_PAIR *pp) {
+  pp->sm = osMemoryPoolNew (s->sm_count, s->sm_size, NULL);
+  pp->lg = NULL;
+
+  if (s->lg_count != 0U) {
+    pp->lg = osMemoryPoolNew (s->lg_count, s->lg_size, NULL);
+  }
+}
+
+static void PoolDelete (POOL_PAIR *pp) {
+  osMemoryPoolDelete (pp->sm);
+
+  if (pp->lg != NULL) {
+    osMemoryPoolDelete (pp->lg);
+  }
+}
+
+/* Number of bytes currently pinned by the pools */
+static uint32_t PoolUsed (POOL_PAIR *pp) {
+  uint32_t n;
+
+  n = osMemoryPoolGetCount (pp->sm) * osMemoryPoolGetBlockSize (pp->sm);
+
+  if (pp->lg != NULL) {
+    n += osMemoryPoolGetCount (pp->lg) * osMemoryPoolGetBlockSize (pp->lg);
+  }
+
+  return (n);
+}
+
+/* Write data into the parser buffer the way ReceiveData does */
+static void SerialReceive (const uint8_t *buf, uint32_t num, BUF_LIST *p) {
+  uint8_t *span;
+  uint32_t n, cnt;
+
+  for (n = 0U; n < num; n += cnt) {
+    cnt = BufGetWriteSpan (&span, p);
+
+    if (cnt > RX_BURST)   { cnt = RX_BURST; }
+    if (cnt > (num - n))  { cnt = num - n;  }
+
+    memcpy (span, &buf[n], cnt);
+    BufCommit (cnt, p);
+  }
+}
+
+static void Run (const POOL_SETUP *s) {
+  POOL_PAIR parser, socket;
+  BUF_LIST  mem, resp, sock;
+  BUF_SEG   seg[64];
+  uint32_t  i, k, len, held;
+  uint32_t  peak, used, bytes, resp_peak;
+  uint64_t  hops, payloads;
+  double    t0, t1;
+
+  PoolNew (s, &parser);
+  PoolNew (s, &socket);
+
+  BufInitEx (parser.sm, parser.lg, NULL, &mem);
+  BufInitEx (parser.sm, parser.lg, NULL, &resp);
+  BufInitEx (socket.sm, socket.lg, NULL, &sock);
+
+  peak      = 0U;
+  resp_peak = 0U;
+  bytes     = 0U;
+  hops      = 0U;
+  payloads  = 0U;
+  held      = 0U;
+
+  t0 = TimeNs();
+
+  for (k = 0U; k < REPEAT; k++) {
+    for (i = 0U; i < TRACE_NUM; i++) {
+      /* Response line */
+      len = (uint32_t)strlen (Trace[i].line);
+      SerialReceive ((const uint8_t *)Trace[i].line, len, &mem);
+
+      if (BufGetCount (&resp) > (RESP_HOLD * 32U)) {
+        /* Oldest responses processed */
+        BufFlush (0U, &resp);
+      }
+      BufCopy (&resp, &mem, len);
+      bytes += len;
+
+      if (Trace[i].payload != 0U) {
+        /* Socket payload */
+        SerialReceive (Scratch, Trace[i].payload, &mem);
+
+        BufCopy (&sock, &mem, Trace[i].payload);
+        bytes += Trace[i].payload;
+        held++;
+
+        if (held == SOCK_HOLD) {
+          /* Application reads socket data */
+          hops     += BufGetSegments (seg, 64U, 0U, BufGetCount (&sock), &sock);
+          payloads += held;
+
+          while (BufRead (Scratch, sizeof(Scratch), &sock) > 0) {}
+          held = 0U;
+        }
+      }
+
+      used = PoolUsed (&parser) + PoolUsed (&socket);
+
+      if (used > peak) {
+        peak = used;
+      }
+
+      /* Response lines are short and always use small blocks */
+      used = BufGetBlockCount (&resp) * s->sm_size;
+
+      if (used > resp_peak) {
+        resp_peak = used;
+      }
+    }
+  }
+
+  t1 = TimeNs();
+
+  printf ("  %-20s peak RAM %6u B  resp RAM %5u B  hops/payload %5.2f  %8.1f MB/s\n",
+          s->name, peak, resp_peak, (double)hops / (double)payloads,
+          ((double)bytes * 1e3) / (t1 - t0));
+
+  BufUninit (&sock);
+  BufUninit (&resp);
+  BufUninit (&mem);
+
+  PoolDelete (&socket);
+  PoolDelete (&parser);
+}
+
+int main (void) {
+  uint32_t i;
+
+  printf ("BufList size classes, %u trace entries x %u\n", (uint32_t)TRACE_NUM, REPEAT);
+
+  for (i = 0U; i < (sizeof(Setup) / sizeof(Setup[0])); i++) {
+    Run (&Setup[i]);
+  }
+
+  return (0);
+}
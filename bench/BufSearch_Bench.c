@@ -0,0 +1,236 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  BufList search kernels benchmark
+
+  Compares BufFind, BufFindByte and BufCompareString against the previous
+  scalar per-byte implementation (Legacy_ functions below) on a host.
+
+  Build (select kernel with -DBUF_FIND_KERNEL=0|1|2):
+    gcc -O2 -Ibench/host -Isrc/BufList bench/BufSearch_Bench.c \
+        src/BufList/BufList.c src/BufList/BufAllocator.c src/BufList/LinkList.c -o bufsearch_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "BufList.h"
+
+#include "host_bench.h"
+
+/* Mirror of the BufList internal block header */
+typedef struct {
+  Link_t   link;
+  uint16_t sz;
+  uint16_t cls;
+  uint16_t wri;
+  uint16_t rdi;
+  uint8_t  data[];
+} MEM_BUF;
+
+/* Previous BufFindByte implementation */
+static int32_t Legacy_BufFindByte (uint8_t data, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t offs, rdi;
+  int32_t n;
+
+  n    = -1;
+  rdi  = 0U;
+  offs = 0U;
+
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+  }
+
+  while (buf_cb != NULL) {
+    if (rdi == buf_cb->wri) {
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi = 0U;
+    }
+    else {
+      while (rdi < buf_cb->wri) {
+        if (data == buf_cb->data[rdi]) {
+          n = (int32_t)offs;
+          break;
+        }
+        offs++;
+        rdi++;
+      }
+      if (n != -1) {
+        break;
+      }
+    }
+  }
+  return (n);
+}
+
+/* Previous BufFind implementation */
+static int32_t Legacy_BufFind (const uint8_t *data, uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t offs, rdi;
+  uint32_t i;
+  int32_t n;
+
+  n    = -1;
+  i    = 0U;
+  rdi  = 0U;
+  offs = 0U;
+
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+  }
+
+  while (buf_cb != NULL) {
+    if (rdi == buf_cb->wri) {
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi = 0U;
+    }
+    else {
+      while (rdi < buf_cb->wri) {
+        if (data[i] != buf_cb->data[rdi]) {
+          if (i == 0) { offs += 1; }
+          else        { offs += i; }
+          i = 0U;
+        }
+        if (data[i] == buf_cb->data[rdi]) {
+          i++;
+        }
+        rdi++;
+        if (i == num) {
+          n = (int32_t)offs;
+          break;
+        }
+      }
+      if (n != -1) {
+        break;
+      }
+    }
+  }
+  return (n);
+}
+
+/* Previous BufCompareString implementation */
+static int32_t Legacy_BufCompareString (const char *string, uint32_t offs, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t rdi = 0U;
+  int32_t  n;
+
+  n = 0;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+  }
+
+  while (buf_cb != NULL) {
+    if (rdi == buf_cb->wri) {
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      if (buf_cb == NULL) {
+        n = -1;
+      }
+      rdi = 0U;
+    }
+    else {
+      if (offs != 0U) {
+        offs--;
+        rdi++;
+      }
+      else {
+        while (rdi < buf_cb->wri) {
+          if (string[n] == '\0') {
+            break;
+          }
+          if (string[n] != buf_cb->data[rdi]) {
+            n = 0;
+            break;
+          }
+          n++;
+          rdi++;
+        }
+        if ((n <= 0) || (string[n] == '\0')) {
+          break;
+        }
+      }
+    }
+  }
+  return (n);
+}
+
+#define PAYLOAD_SIZE    4096U
+#define ITERATIONS      20000U
+
+static volatile int32_t Sink;
+
+/* Run one measurement and print ns/op and MB/s */
+#define MEASURE(name, expr, bytes)                                        \
+  do {                                                                    \
+    double t0, t1, ns;                                                    \
+    uint32_t it;                                                          \
+    t0 = TimeNs();                                                        \
+    for (it = 0U; it < ITERATIONS; it++) { Sink = (expr); }               \
+    t1 = TimeNs();                                                        \
+    ns = (t1 - t0) / ITERATIONS;                                          \
+    printf ("  %-28s %10.1f ns/op %10.1f MB/s  (result %d)\n",            \
+            name, ns, ((double)(bytes) * 1e3) / ns, (int)Sink);           \
+  } while (0)
+
+int main (void) {
+  static const uint32_t bl_sz[] = { 128U, 512U, 2048U };
+  static uint8_t payload[PAYLOAD_SIZE];
+  osMemoryPoolId_t mp_id;
+  BUF_LIST list;
+  uint32_t i, k;
+
+  /* HTTP body like payload with CRLF and ':' only at the very end */
+  for (i = 0U; i < PAYLOAD_SIZE; i++) {
+    payload[i] = (uint8_t)('a' + (i % 26U));
+  }
+  memcpy (&payload[PAYLOAD_SIZE - 8U], "+IPD:\r\r\n", 8U);
+
+  for (k = 0U; k < (sizeof(bl_sz)/sizeof(bl_sz[0])); k++) {
+    mp_id = osMemoryPoolNew ((PAYLOAD_SIZE / 64U) + 2U, bl_sz[k], NULL);
+
+    BufInit (mp_id, NULL, &list);
+    BufWrite (payload, PAYLOAD_SIZE, &list);
+
+    printf ("block size %u, %u bytes buffered\n", bl_sz[k], BufGetCount (&list));
+
+    MEASURE ("Legacy_BufFind (CRLF)",     Legacy_BufFind ((const uint8_t *)"\r\n", 2U, &list), PAYLOAD_SIZE);
+    MEASURE ("BufFind (CRLF)",            BufFind        ((const uint8_t *)"\r\n", 2U, &list), PAYLOAD_SIZE);
+    MEASURE ("Legacy_BufFindByte (':')",  Legacy_BufFindByte (':', &list),                     PAYLOAD_SIZE);
+    MEASURE ("BufFindByte (':')",         BufFindByte        (':', &list),                     PAYLOAD_SIZE);
+    MEASURE ("Legacy_BufCompareString",   Legacy_BufCompareString ("+IPD:", PAYLOAD_SIZE - 8U, &list), 5U);
+    MEASURE ("BufCompareString",          BufCompareString        ("+IPD:", PAYLOAD_SIZE - 8U, &list), 5U);
+
+    BufUninit (&list);
+    osMemoryPoolDelete (mp_id);
+  }
+
+  return (0);
+}
@@ -0,0 +1,217 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Response classifier benchmark
+
+  Compares BufMatchKey on sorted key tables (parser GetCommandCode and
+  GetASCIIResponseCode) against the previous linear scan calling
+  BufCompareString for each table entry (Legacy_ functions below).
+  Key tables mirror EG915U.c, legacy tables keep the previous order.
+
+  Reports lines classified per second and lines classified differently,
+  which are the intended fixes of order dependent prefix matches.
+
+  Build:
+    make -C bench respclassify_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "BufList.h"
+
+#include "host_bench.h"
+
+/* Previous +CMD string list, code is the list index */
+static const char *Legacy_PlusResp[] = {
+  "IPD", "CWLAP", "CWJAP", "CWQAP", "CWSAP", "CWHOSTNAME", "CIPSTAMAC", "CIPAPMAC",
+  "CSQ", "QIACT", "CIPAP", "CIPDNS", "CWAUTOCONN", "CWLIF", "UART_CUR", "SYSMSG",
+  "CIPSTATUS", "CIPDOMAIN", "QIOPEN", "QICLOSE", "QPING", "QISEND", "CIPMUX", "CIPSERVER",
+  "CIPSERVERMAXCONN", "RST", "ATI", "LINK_CONN", "STA_CONNECTED", "STA_DISCONNECTED", "QSCLK", "CPIN",
+  "CSQ", "QICSGP", "QIACT", "QIDEACT", "QHTTPCFG", "QHTTPURL", "QHTTPPOST", "QHTTPREAD",
+  "QHTTPGET", "QSSLCFG", "IPR", "IFC", "E", ""
+};
+
+/* Previous generic response list, code is the list index */
+static const char *Legacy_ASCIIResp[] = {
+  "OK", "ERROR", "FAIL", "SEND OK", "SEND FAIL", "busy p...", "busy s...", "CONNECT",
+  "MODEM CONNECTED", "MODEM GOT IP", "MODEM DISCONNECT", "AT", "RDY", "READY", "CME ERROR"
+};
+
+/* Key tables as in EG915U.c, codes are CommandCode_t and AT_RESP_x values */
+static const BUF_KEY Key_PlusResp[] = {
+  { "ATI",              26 }, { "CEREG",            44 }, { "CIPAP",            10 },
+  { "CIPAPMAC",          7 }, { "CIPDNS",           11 }, { "CIPDOMAIN",        17 },
+  { "CIPMUX",           22 }, { "CIPSERVER",        23 }, { "CIPSERVERMAXCONN", 24 },
+  { "CIPSTAMAC",         6 }, { "CIPSTATUS",        16 }, { "CPIN",             31 },
+  { "CSQ",              32 }, { "CWAUTOCONN",       12 }, { "CWHOSTNAME",        5 },
+  { "CWJAP",             2 }, { "CWLAP",             1 }, { "CWLIF",            13 },
+  { "CWQAP",             3 }, { "CWSAP",             4 }, { "IFC",              43 },
+  { "IPD",               0 }, { "IPR",              42 }, { "LINK_CONN",        27 },
+  { "QHTTPCFG",         36 }, { "QHTTPGET",         40 }, { "QHTTPPOST",        38 },
+  { "QHTTPREAD",        39 }, { "QHTTPURL",         37 }, { "QIACT",            34 },
+  { "QICLOSE",          19 }, { "QICSGP",           33 }, { "QIDEACT",          35 },
+  { "QIOPEN",           18 }, { "QISEND",           21 }, { "QPING",            20 },
+  { "QSCLK",            30 }, { "QSSLCFG",          41 }, { "RST",              25 },
+  { "STA_CONNECTED",    28 }, { "STA_DISCONNECTED", 29 }, { "SYSMSG",           15 },
+  { "UART_CUR",         14 }
+};
+
+static const BUF_KEY Key_ASCIIResp[] = {
+  { "AT",               11 }, { "CME ERROR",        14 }, { "CONNECT",           7 },
+  { "ERROR",             1 }, { "FAIL",              2 }, { "MODEM CONNECTED",   8 },
+  { "MODEM DISCONNECT", 10 }, { "MODEM GOT IP",      9 }, { "OK",                0 },
+  { "RDY",              12 }, { "READY",            13 }, { "SEND FAIL",         4 },
+  { "SEND OK",           3 }, { "busy p...",         5 }, { "busy s...",         6 }
+};
+
+#define ARRAY_NUM(a)    (sizeof(a)/sizeof((a)[0]))
+#define CODE_UNKNOWN    0xFF
+
+/* Received lines, offs 1: +CMD response, offs 0: generic response */
+typedef struct {
+  const char *line;
+  uint32_t    plus;
+} LINE;
+
+static const LINE Line[] = {
+  { "+CSQ: 23,99\r\n",                    1U },
+  { "+QIACT: 1,1,1,\"10.20.30.40\"\r\n",  1U },
+  { "+QHTTPGET: 0,200,1024\r\n",          1U },
+  { "+QHTTPREAD: 0\r\n",                  1U },
+  { "+QISEND: 10,10,0\r\n",               1U },
+  { "+IPD,0,100:",                        1U },
+  { "+CPIN: READY\r\n",                   1U },
+  { "+QIURC: \"recv\",0\r\n",             1U },
+  { "+CEREG: 2,1\r\n",                    1U },
+  { "+CIPSERVERMAXCONN:5\r\n",            1U },
+  { "+UART_CUR:115200,8,1,0,0\r\n",       1U },
+  { "OK\r\n",                             0U },
+  { "ERROR\r\n",                          0U },
+  { "SEND OK\r\n",                        0U },
+  { "CONNECT\r\n",                        0U },
+  { "RDY\r\n",                            0U },
+  { "AT+CSQ\r\n",                         0U },
+  { "busy p...\r\n",                      0U },
+  { "NO CARRIER\r\n",                     0U }
+};
+
+/* Previous GetCommandCode / GetASCIIResponseCode */
+static uint8_t Legacy_Classify (const char **list, uint32_t num, uint32_t offs, BUF_LIST *p) {
+  uint32_t i;
+  uint8_t  code;
+
+  code = CODE_UNKNOWN;
+
+  BufBegin (p);
+
+  for (i = 0U; i < num; i++) {
+    if (BufCompareStringUnlocked (list[i], offs, p) > 0) {
+      code = (uint8_t)i;
+      break;
+    }
+  }
+
+  BufEnd (p);
+
+  return (code);
+}
+
+static uint8_t Legacy_Line (uint32_t plus, BUF_LIST *p) {
+  if (plus != 0U) {
+    return (Legacy_Classify (Legacy_PlusResp, ARRAY_NUM(Legacy_PlusResp), 1U, p));
+  }
+  return (Legacy_Classify (Legacy_ASCIIResp, ARRAY_NUM(Legacy_ASCIIResp), 0U, p));
+}
+
+static uint8_t Key_Line (uint32_t plus, BUF_LIST *p) {
+  int32_t val;
+
+  if (plus != 0U) {
+    val = BufMatchKey (Key_PlusResp, ARRAY_NUM(Key_PlusResp), 1U, BUF_KEY_TOKEN, p);
+  } else {
+    val = BufMatchKey (Key_ASCIIResp, ARRAY_NUM(Key_ASCIIResp), 0U, BUF_KEY_PREFIX, p);
+  }
+  return ((val >= 0) ? (uint8_t)val : CODE_UNKNOWN);
+}
+
+#define ITERATIONS      200000U
+
+static volatile uint8_t Sink;
+
+/* Classify all lines ITERATIONS times, return lines per second */
+static double Measure (uint8_t (*classify)(uint32_t, BUF_LIST *), BUF_LIST *list) {
+  double t0, t1;
+  uint32_t it, i;
+
+  t0 = TimeNs();
+  for (it = 0U; it < ITERATIONS; it++) {
+    for (i = 0U; i < ARRAY_NUM(Line); i++) {
+      Sink = classify (Line[i].plus, &list[i]);
+    }
+  }
+  t1 = TimeNs();
+
+  return (((double)ITERATIONS * ARRAY_NUM(Line) * 1e9) / (t1 - t0));
+}
+
+int main (void) {
+  static BUF_LIST list[ARRAY_NUM(Line)];
+  osMemoryPoolId_t mp_id;
+  double lps_legacy, lps_key;
+  uint8_t c_legacy, c_key;
+  uint32_t i;
+
+  mp_id = osMemoryPoolNew (ARRAY_NUM(Line), 512U, NULL);
+
+  for (i = 0U; i < ARRAY_NUM(Line); i++) {
+    BufInit (mp_id, NULL, &list[i]);
+    BufWrite ((uint8_t *)Line[i].line, strlen (Line[i].line), &list[i]);
+  }
+
+  printf ("%-34s %8s %8s\n", "line", "legacy", "key");
+
+  for (i = 0U; i < ARRAY_NUM(Line); i++) {
+    c_legacy = Legacy_Line (Line[i].plus, &list[i]);
+    c_key    = Key_Line    (Line[i].plus, &list[i]);
+
+    printf ("%-34.*s %8u %8u%s\n", (int)strcspn (Line[i].line, "\r"), Line[i].line,
+            c_legacy, c_key, (c_legacy != c_key) ? "  (differs)" : "");
+  }
+
+  lps_legacy = Measure (Legacy_Line, list);
+  lps_key    = Measure (Key_Line,    list);
+
+  printf ("\n");
+  printf ("Legacy linear scan   %10.2f Mlines/s\n", lps_legacy / 1e6);
+  printf ("BufMatchKey          %10.2f Mlines/s  (x%.1f)\n", lps_key / 1e6, lps_key / lps_legacy);
+
+  for (i = 0U; i < ARRAY_NUM(Line); i++) {
+    BufUninit (&list[i]);
+  }
+  osMemoryPoolDelete (mp_id);
+
+  return (0);
+}
@@ -0,0 +1,326 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Linux serial backend pty loopback test
+
+  Opens a pseudo terminal, points the Linux serial backend
+  (EG915U_Serial_Linux.c) to its slave with MOD_SERIAL_DEVICE and plays the
+  modem on the master side:
+
+    - Serial_SendBuf and Serial_SendSeg data is read back from the master
+    - Serial_SendBufNoCopy sends a buffer larger than all transmit
+      descriptors, Serial_GetTxPending must return to 0
+    - data written to the master is larger than the backend receive buffer,
+      Serial_ReadBuf must return it complete and in order
+
+  Serial_Cb events are counted and checked at the end.
+
+  Build and run:
+    make -C bench loopback
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "EG915U_Serial.h"
+
+#include "host_bench.h"
+
+/* No-copy transmit size, above SERIAL_TXDESC_NUM * SERIAL_TXEXT_SZ */
+#define LOOP_TX_SIZE      (80U * 1024U)
+
+/* Receive size, above SERIAL_RXBUF_SZ */
+#define LOOP_RX_SIZE      (20U * 1024U)
+
+/* Test timeout [ms] */
+#define LOOP_TIMEOUT      5000
+
+/* Master side of the pty */
+static int Master = -1;
+
+/* Serial_Cb event counters */
+static volatile uint32_t Ev_TxDone;
+static volatile uint32_t Ev_RxData;
+static volatile uint32_t Ev_Error;
+
+static uint8_t TxData[LOOP_TX_SIZE];
+static uint8_t RxData[LOOP_TX_SIZE];
+
+/* Serial event callback, called from the backend I/O thread */
+void Serial_Cb (uint32_t event) {
+
+  if (event & SERIAL_CB_TX_DATA_COMPLETED) {
+    __atomic_add_fetch (&Ev_TxDone, 1U, __ATOMIC_RELAXED);
+  }
+  if (event & SERIAL_CB_RX_DATA_AVAILABLE) {
+    __atomic_add_fetch (&Ev_RxData, 1U, __ATOMIC_RELAXED);
+  }
+  if (event & (SERIAL_CB_TX_ERROR | SERIAL_CB_RX_ERROR)) {
+    __atomic_add_fetch (&Ev_Error, 1U, __ATOMIC_RELAXED);
+  }
+}
+
+/* Fill buffer with a pattern that does not repeat within 251 bytes */
+static void Pattern (uint8_t *buf, uint32_t len, uint32_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < len; i++) {
+    buf[i] = (uint8_t)((i + seed) % 251U);
+  }
+}
+
+/* Read len bytes from the master, 0:ok, -1:timeout */
+static int32_t MasterRead (uint8_t *buf, uint32_t len) {
+  struct pollfd pfd;
+  uint32_t n;
+  ssize_t  rc;
+
+  n = 0U;
+
+  while (n < len) {
+    pfd.fd      = Master;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    if (poll (&pfd, 1U, LOOP_TIMEOUT) <= 0) {
+      return (-1);
+    }
+
+    rc = read (Master, &buf[n], len - n);
+
+    if (rc > 0) {
+      n += (uint32_t)rc;
+    }
+    else if ((rc < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+      return (-1);
+    }
+  }
+
+  return (0);
+}
+
+/* Master reader thread for the no-copy transmit */
+static void *Reader (void *arg) {
+  (void)arg;
+
+  return ((MasterRead (RxData, LOOP_TX_SIZE) == 0) ? RxData : NULL);
+}
+
+/* Master writer thread for the receive test */
+static void *Writer (void *arg) {
+  struct pollfd pfd;
+  const uint8_t *buf;
+  uint32_t n;
+  ssize_t  rc;
+
+  buf = arg;
+  n   = 0U;
+
+  while (n < LOOP_RX_SIZE) {
+    pfd.fd      = Master;
+    pfd.events  = POLLOUT;
+    pfd.revents = 0;
+
+    if (poll (&pfd, 1U, LOOP_TIMEOUT) <= 0) {
+      return (NULL);
+    }
+
+    rc = write (Master, &buf[n], LOOP_RX_SIZE - n);
+
+    if (rc > 0) {
+      n += (uint32_t)rc;
+    }
+  }
+
+  return (arg);
+}
+
+/* Copy send: Serial_SendBuf and Serial_SendSeg */
+static uint32_t Test_Send (void) {
+  static const uint8_t cmd[] = "AT+QIOPEN=1,0,\"TCP\",\"10.0.0.1\",80,0,0\r";
+  uint8_t  buf[64];
+  BUF_SEG  seg[3];
+  uint32_t fail;
+  int32_t  n;
+
+  fail = 0U;
+
+  n = Serial_SendBuf (cmd, sizeof(cmd) - 1U);
+
+  fail += Check ("SendBuf queued",   n == (int32_t)(sizeof(cmd) - 1U));
+  fail += Check ("SendBuf received", (MasterRead (buf, sizeof(cmd) - 1U) == 0) &&
+                                     (memcmp (buf, cmd, sizeof(cmd) - 1U) == 0));
+
+  seg[0].buf = (uint8_t *)"AT+QISEND=0,";
+  seg[0].len = 12U;
+  seg[1].buf = (uint8_t *)"5";
+  seg[1].len = 1U;
+  seg[2].buf = (uint8_t *)"\r";
+  seg[2].len = 1U;
+
+  n = Serial_SendSeg (seg, 3U);
+
+  fail += Check ("SendSeg queued",   n == 14);
+  fail += Check ("SendSeg received", (MasterRead (buf, 14U) == 0) &&
+                                     (memcmp (buf, "AT+QISEND=0,5\r", 14U) == 0));
+  return (fail);
+}
+
+/* No-copy send larger than all transmit descriptors */
+static uint32_t Test_SendNoCopy (void) {
+  pthread_t th;
+  void    *res;
+  uint32_t n, fail, tout;
+  int32_t  rc;
+
+  fail = 0U;
+
+  Pattern (TxData, LOOP_TX_SIZE, 7U);
+  memset (RxData, 0x00, LOOP_TX_SIZE);
+
+  pthread_create (&th, NULL, Reader, NULL);
+
+  n    = 0U;
+  tout = 0U;
+
+  while (((n < LOOP_TX_SIZE) || (Serial_GetTxPending() != 0U)) && (tout < LOOP_TIMEOUT)) {
+    if ((n < LOOP_TX_SIZE) && (Serial_GetTxPending() == 0U)) {
+      /* Queue next part once the previous one is transmitted */
+      rc = Serial_SendBufNoCopy (&TxData[n], LOOP_TX_SIZE - n);
+
+      if (rc < 0) {
+        break;
+      }
+      n += (uint32_t)rc;
+    }
+    usleep (1000U);
+    tout++;
+  }
+
+  pthread_join (th, &res);
+
+  fail += Check ("SendBufNoCopy queued",   n == LOOP_TX_SIZE);
+  fail += Check ("SendBufNoCopy pending 0", Serial_GetTxPending() == 0U);
+  fail += Check ("SendBufNoCopy received", (res != NULL) && (memcmp (RxData, TxData, LOOP_TX_SIZE) == 0));
+
+  return (fail);
+}
+
+/* Receive larger than the backend receive buffer */
+static uint32_t Test_Receive (void) {
+  pthread_t th;
+  void    *res;
+  uint32_t n, fail, tout;
+  int32_t  rc;
+
+  fail = 0U;
+
+  Pattern (TxData, LOOP_RX_SIZE, 13U);
+  memset (RxData, 0x00, LOOP_RX_SIZE);
+
+  pthread_create (&th, NULL, Writer, TxData);
+
+  n    = 0U;
+  tout = 0U;
+
+  while ((n < LOOP_RX_SIZE) && (tout < LOOP_TIMEOUT)) {
+    if (Serial_GetRxCount() == 0U) {
+      usleep (1000U);
+      tout++;
+      continue;
+    }
+
+    /* Odd read size, copy wraps around the receive buffer */
+    rc = Serial_ReadBuf (&RxData[n], ((LOOP_RX_SIZE - n) < 1000U) ? (LOOP_RX_SIZE - n) : 1000U);
+
+    if (rc > 0) {
+      n += (uint32_t)rc;
+    }
+  }
+
+  pthread_join (th, &res);
+
+  fail += Check ("ReadBuf count",    n == LOOP_RX_SIZE);
+  fail += Check ("ReadBuf data",     (res != NULL) && (memcmp (RxData, TxData, LOOP_RX_SIZE) == 0));
+  fail += Check ("RxCount 0",        Serial_GetRxCount() == 0U);
+
+  return (fail);
+}
+
+int main (void) {
+  struct termios tio;
+  const char *slave;
+  uint32_t fail;
+  int32_t  stat;
+
+  Master = posix_openpt (O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+  if ((Master < 0) || (grantpt (Master) != 0) || (unlockpt (Master) != 0) ||
+      ((slave = ptsname (Master)) == NULL)) {
+    fprintf (stderr, "pseudo terminal not available\n");
+    return (1);
+  }
+
+  /* Master side in raw mode, no echo and no line editing */
+  if (tcgetattr (Master, &tio) == 0) {
+    cfmakeraw (&tio);
+    tcsetattr (Master, TCSANOW, &tio);
+  }
+
+  setenv ("MOD_SERIAL_DEVICE", slave, 1);
+
+  stat = Serial_Initialize();
+
+  if (stat != 1) {
+    fprintf (stderr, "Serial_Initialize (%s) failed: %d\n", slave, stat);
+    return (1);
+  }
+
+  printf ("device %s\n", slave);
+
+  fail  = Test_Send();
+  fail += Test_SendNoCopy();
+  fail += Test_Receive();
+
+  Serial_Uninitialize();
+
+  fail += Check ("TX completed events", Ev_TxDone != 0U);
+  fail += Check ("RX data events",      Ev_RxData != 0U);
+  fail += Check ("No error events",     Ev_Error  == 0U);
+
+  close (Master);
+
+  printf ("%s\n", (fail == 0U) ? "PASSED" : "FAILED");
+
+  return ((fail == 0U) ? 0 : 1);
+}
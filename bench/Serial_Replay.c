@@ -0,0 +1,480 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Serial trace replay
+
+  Feeds a serial trace captured with Serial_TraceDump (MOD_EG915U_SERIAL_TRACE)
+  into the AT command parser on a host. The serial driver is replaced by the
+  trace: received records are made available to AT_Parser_Execute at their
+  original time (scaled by --speed) and AT_Notify plays the role of the modem
+  thread and the application. Socket data and HTTP content are consumed as
+  soon as they are received, response lines are dropped after each generic
+  response.
+
+  Transmit records are not sent anywhere, "AT+QHTTPREAD" commands are passed
+  to AT_Cmd_QHTTPREAD to switch the parser into HTTP content receive, as on
+  the target.
+
+  Reports notify event counts (including AT_NOTIFY_OUT_OF_MEMORY), parser
+  pool usage, parser throughput and system timer cycles per received byte
+  spent in each parser state (AT_Parser_GetProfile).
+
+  Build:
+    make -C bench serial_replay
+
+  Usage:
+    serial_replay [--speed <x>] <trace>      replay trace, speed 0: no delays
+    serial_replay --synth <trace> [<kB>]     write synthetic HTTP download trace
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "EG915U.h"
+#include "EG915U_Serial.h"
+#include "Modem_EG915U_Os.h"
+
+#include "host_bench.h"
+#include "host_serial.h"
+
+/* Number of AT_NOTIFY_xxx events */
+#define NOTIFY_NUM        (AT_NOTIFY_RX_ERROR + 1U)
+
+/* Replay control block */
+typedef struct {
+  const uint8_t *trc;         /* Trace records                        */
+  uint32_t       trc_len;     /* Trace records length                 */
+  uint32_t       pos;         /* Current record                       */
+  uint32_t       tick_freq;   /* Trace tick frequency [Hz]            */
+  uint64_t       tick;        /* Trace time of the current record     */
+  double         speed;       /* Replay speed, 0: as fast as possible */
+  double         t_start;     /* Replay start time [ns]               */
+  double         t_wait;      /* Time spent waiting for records [ns]  */
+  uint32_t       http_len;    /* HTTP content left to receive         */
+} REPLAY;
+
+/* Replay statistics */
+typedef struct {
+  uint64_t rx_bytes;          /* Received bytes fed to the parser     */
+  uint64_t tx_bytes;          /* Transmitted bytes in the trace       */
+  uint32_t rx_rec;            /* Receive records                      */
+  uint32_t tx_rec;            /* Transmit records                     */
+  uint64_t ipd_bytes;         /* Socket data received                 */
+  uint64_t http_bytes;        /* HTTP content received                */
+  uint32_t http_spin;         /* HTTP content polls without data      */
+  uint32_t http_trunc;        /* HTTP content cut by end of trace     */
+  uint32_t notify[NOTIFY_NUM];
+} REPLAY_STATS;
+
+static REPLAY       Rep;
+static REPLAY_STATS Stat;
+
+static const char *Notify_Name[NOTIFY_NUM] = {
+  "EXECUTE",            "CONNECTED",           "GOT_IP",            "DISCONNECTED",
+  "CONNECTION_OPEN",    "CONNECTION_CLOSED",   "STATION_CONNECTED", "STATION_DISCONNECTED",
+  "CONNECTION_RX_INIT", "CONNECTION_RX_DATA",  "REQUEST_TO_SEND",   "RESPONSE_GENERIC",
+  "TX_DONE",            "OUT_OF_MEMORY",       "ERR_CODE",          "READY",
+  "HTTP_RESPONSE",      "HTTP_CONTENT",        "RX_ERROR"
+};
+
+/* Parser state names, AT_STATE_x order */
+static const char *State_Name[AT_STATE_NUM] = {
+  "ANALYZE", "WAIT", "FLUSH", "RESP_DATA", "HTTP_CONTENT", "RESP_GEN",
+  "RECV_DATA", "SEND_DATA", "RESP_CTRL", "RESP_ECHO", "RESYNC"
+};
+
+/* ---------------------------------------------------------------------------
+   Trace feed
+   ------------------------------------------------------------------------- */
+
+/* Wait until the record time is reached at the selected speed */
+static void ReplayWait (void) {
+  struct timespec ts;
+  double t_rec, t_now, dt;
+
+  if (Rep.speed > 0.0) {
+    t_rec = ((double)Rep.tick * 1e9) / ((double)Rep.tick_freq * Rep.speed);
+    t_now = TimeNs() - Rep.t_start;
+
+    if (t_rec > t_now) {
+      dt = t_rec - t_now;
+
+      ts.tv_sec  = (time_t)(dt / 1e9);
+      ts.tv_nsec = (long)(dt - ((double)ts.tv_sec * 1e9));
+
+      nanosleep (&ts, NULL);
+
+      Rep.t_wait += TimeNs() - Rep.t_start - t_now;
+    }
+  }
+}
+
+/*
+  Process next trace record.
+
+  \return 0: transmit record, 1: receive data available, -1: end of trace
+*/
+static int32_t ReplayNext (void) {
+  SERIAL_TRACE_REC rec;
+  const uint8_t *data;
+  uint32_t len;
+  int32_t rval;
+
+  rval = -1;
+
+  if ((Rep.pos + sizeof(rec)) <= Rep.trc_len) {
+    memcpy (&rec, &Rep.trc[Rep.pos], sizeof(rec));
+
+    len  = rec.len_dir & SERIAL_TRACE_LEN_MAX;
+    data = &Rep.trc[Rep.pos + sizeof(rec)];
+
+    if ((Rep.pos + sizeof(rec) + len) <= Rep.trc_len) {
+      Rep.pos  += sizeof(rec) + len;
+      Rep.tick += rec.dt;
+
+      ReplayWait();
+
+      if (rec.len_dir & SERIAL_TRACE_TX) {
+        Stat.tx_rec++;
+        Stat.tx_bytes += len;
+
+        if ((len >= 12U) && (memcmp (data, "AT+QHTTPREAD", 12U) == 0)) {
+          /* Parser switches to HTTP content after CONNECT */
+          (void)AT_Cmd_QHTTPREAD (0U);
+        }
+        rval = 0;
+      }
+      else {
+        Stat.rx_rec++;
+        Stat.rx_bytes += len;
+
+        Host_SerialRxPut (data, len);
+
+        rval = 1;
+      }
+    }
+  }
+
+  return (rval);
+}
+
+/* ---------------------------------------------------------------------------
+   Modem thread and application
+   ------------------------------------------------------------------------- */
+
+/* Consume HTTP content, returns 0 when all content is received */
+static uintptr_t HttpContent (AT_PARSER_HANDLE *h) {
+  uint32_t n;
+
+  n = AT_MemGetCount (&h->mem);
+
+  if (n == 0U) {
+    /* Parser spins until content arrives, feed it from the trace */
+    Stat.http_spin++;
+
+    while ((Serial_GetRxCount() == 0U) && (ReplayNext() != -1));
+
+    if (Serial_GetRxCount() == 0U) {
+      /* End of trace */
+      Stat.http_trunc++;
+      Rep.http_len = 0U;
+    }
+  }
+
+  if (n > Rep.http_len) {
+    n = Rep.http_len;
+  }
+
+  n = AT_MemFlush (n, &h->mem);
+
+  Rep.http_len    -= n;
+  Stat.http_bytes += n;
+
+  return ((Rep.http_len != 0U) ? 1U : 0U);
+}
+
+/* Drop response lines not read by the application */
+static void RespDrop (void) {
+  uint8_t buf[16];
+
+  (void)AT_Resp_GetVersion (buf, sizeof(buf));
+}
+
+void AT_Notify (uint32_t event, void *arg) {
+  static uint32_t ipd_len;
+  uintptr_t *uptr;
+  uint32_t link_id, err, code, len;
+
+  if (event < NOTIFY_NUM) {
+    Stat.notify[event]++;
+  }
+
+  switch (event) {
+    case AT_NOTIFY_RESPONSE_GENERIC:
+      RespDrop();
+      break;
+
+    case AT_NOTIFY_CONNECTION_RX_INIT:
+      ipd_len = 0U;
+      if (AT_Resp_IPD (&link_id, &ipd_len, NULL, NULL) == 0) {
+        *(uint32_t *)arg = ipd_len;
+      }
+      RespDrop();
+      break;
+
+    case AT_NOTIFY_CONNECTION_RX_DATA:
+      uptr = (uintptr_t *)arg;
+      len  = AT_MemFlush (ipd_len, (AT_PARSER_MEM *)*uptr);
+
+      ipd_len        -= len;
+      Stat.ipd_bytes += len;
+
+      *uptr = ipd_len;
+      break;
+
+    case AT_NOTIFY_HTTP_RESPONSE:
+      len = 0U;
+      if (AT_Resp_HTTPErrCode (&err, &code, &len) >= 0) {
+        if (len != 0U) {
+          /* +QHTTPGET/+QHTTPPOST: <err>,<httprspcode>,<content_length> */
+          Rep.http_len = len;
+        }
+      }
+      RespDrop();
+      break;
+
+    case AT_NOTIFY_HTTP_CONTENT:
+      uptr  = (uintptr_t *)arg;
+      *uptr = HttpContent ((AT_PARSER_HANDLE *)*uptr);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Synthetic trace
+   ------------------------------------------------------------------------- */
+
+static FILE *Synth_Fp;
+
+static void SynthRec (uint32_t dt, uint32_t dir, const void *data, uint32_t len) {
+  SERIAL_TRACE_REC rec;
+
+  rec.dt      = (uint16_t)dt;
+  rec.len_dir = (uint16_t)(len | dir);
+
+  fwrite (&rec, sizeof(rec), 1U, Synth_Fp);
+  fwrite (data, 1U, len, Synth_Fp);
+}
+
+/* HTTP GET session: registration polling, request and content read in bursts */
+static int32_t Synth (const char *fname, uint32_t kb) {
+  static uint8_t body[1024];
+  SERIAL_TRACE_HDR hdr;
+  char line[64];
+  uint32_t i, n, len;
+
+  Synth_Fp = fopen (fname, "wb");
+
+  if (Synth_Fp == NULL) {
+    return (-1);
+  }
+
+  hdr.magic     = SERIAL_TRACE_MAGIC;
+  hdr.tick_freq = 1000U;
+  fwrite (&hdr, sizeof(hdr), 1U, Synth_Fp);
+
+  /* HTML like content, lines terminated with CRLF */
+  for (i = 0U; i < sizeof(body); i++) {
+    body[i] = ((i % 64U) == 62U) ? '\r' : ((i % 64U) == 63U) ? '\n' : (uint8_t)('a' + (i % 26U));
+  }
+
+  SynthRec (0U, SERIAL_TRACE_TX, "AT\r\n", 4U);
+  SynthRec (2U, 0U,              "\r\nOK\r\n", 6U);
+  SynthRec (5U, SERIAL_TRACE_TX, "AT+CSQ\r\n", 8U);
+  SynthRec (3U, 0U,              "\r\n+CSQ: 23,99\r\n\r\nOK\r\n", 21U);
+
+  len = kb * 1024U;
+  n   = (uint32_t)sprintf (line, "\r\n+QHTTPGET: 0,200,%u\r\n", len);
+
+  SynthRec (10U,  SERIAL_TRACE_TX, "AT+QHTTPGET=80\r\n", 16U);
+  SynthRec (4U,   0U,              "\r\nOK\r\n", 6U);
+  SynthRec (350U, 0U,              line, n);
+
+  SynthRec (5U, SERIAL_TRACE_TX, "AT+QHTTPREAD=80\r\n", 17U);
+  SynthRec (3U, 0U,              "\r\nCONNECT\r\n", 11U);
+
+  /* Content arrives in 1k bursts, about 100 bytes per ms at 921600 baud */
+  for (i = 0U; i < kb; i++) {
+    SynthRec (10U, 0U, body, sizeof(body));
+  }
+
+  SynthRec (1U, 0U, "\r\nOK\r\n\r\n+QHTTPREAD: 0\r\n", 23U);
+
+  fclose (Synth_Fp);
+
+  return (0);
+}
+
+/* ---------------------------------------------------------------------------
+   Main
+   ------------------------------------------------------------------------- */
+
+/* Load trace file, returns trace length or -1 on error */
+static int32_t Load (const char *fname, uint8_t **trc) {
+  FILE *fp;
+  long  sz;
+  int32_t rval;
+
+  rval = -1;
+  fp   = fopen (fname, "rb");
+
+  if (fp != NULL) {
+    fseek (fp, 0, SEEK_END);
+    sz = ftell (fp);
+    fseek (fp, 0, SEEK_SET);
+
+    *trc = malloc ((size_t)sz + 1U);
+
+    if ((*trc != NULL) && (fread (*trc, 1U, (size_t)sz, fp) == (size_t)sz)) {
+      rval = (int32_t)sz;
+    }
+    fclose (fp);
+  }
+
+  return (rval);
+}
+
+static void PrintStats (double ns) {
+  AT_PARSER_PROFILE prof;
+  uint32_t i;
+
+  printf ("records      rx %u, tx %u\n", Stat.rx_rec, Stat.tx_rec);
+  printf ("bytes        rx %llu, tx %llu\n", (unsigned long long)Stat.rx_bytes, (unsigned long long)Stat.tx_bytes);
+  printf ("socket data  %llu bytes\n", (unsigned long long)Stat.ipd_bytes);
+  printf ("http content %llu bytes, %u waits, %u truncated\n",
+          (unsigned long long)Stat.http_bytes, Stat.http_spin, Stat.http_trunc);
+  printf ("parser pool  %u blocks peak, %u allocation failures\n", Host_PoolStat.pool_high, Host_PoolStat.pool_fail);
+  printf ("notify events:\n");
+
+  for (i = 0U; i < NOTIFY_NUM; i++) {
+    if (Stat.notify[i] != 0U) {
+      printf ("  %-22s %u\n", Notify_Name[i], Stat.notify[i]);
+    }
+  }
+
+  printf ("parser time  %.3f ms, %.1f MB/s\n", ns / 1e6, ((double)Stat.rx_bytes * 1e3) / ns);
+
+  if ((AT_Parser_GetProfile (&prof) == 0) && (prof.rx_bytes != 0U)) {
+    printf ("parser states (timer %u Hz, %llu bytes):\n", prof.timer_freq, (unsigned long long)prof.rx_bytes);
+    printf ("  %-12s %10s %14s %10s\n", "state", "calls", "cycles", "cyc/byte");
+
+    for (i = 0U; i < AT_STATE_NUM; i++) {
+      if (prof.state[i].calls != 0U) {
+        printf ("  %-12s %10u %14llu %10.3f\n", State_Name[i], prof.state[i].calls,
+                (unsigned long long)prof.state[i].cycles, (double)prof.state[i].cycles / (double)prof.rx_bytes);
+      }
+    }
+  }
+}
+
+int main (int argc, char *argv[]) {
+  SERIAL_TRACE_HDR hdr;
+  const char *fname;
+  uint8_t *trc;
+  int32_t  len, n;
+  double   ns;
+
+  fname     = NULL;
+  Rep.speed = 1.0;
+
+  for (n = 1; n < argc; n++) {
+    if ((strcmp (argv[n], "--synth") == 0) && ((n + 1) < argc)) {
+      return ((Synth (argv[n + 1], ((n + 2) < argc) ? (uint32_t)atoi (argv[n + 2]) : 64U) == 0) ? 0 : 1);
+    }
+    else if ((strcmp (argv[n], "--speed") == 0) && ((n + 1) < argc)) {
+      Rep.speed = atof (argv[++n]);
+    }
+    else if ((fname == NULL) && (argv[n][0] != '-')) {
+      fname = argv[n];
+    }
+    else {
+      fname = NULL;
+      break;
+    }
+  }
+
+  if (fname == NULL) {
+    fprintf (stderr, "usage: %s [--speed <x>] <trace>\n", argv[0]);
+    fprintf (stderr, "       %s --synth <trace> [<kB>]\n", argv[0]);
+    return (1);
+  }
+
+  len = Load (fname, &trc);
+
+  if (len < (int32_t)sizeof(hdr)) {
+    fprintf (stderr, "%s: cannot read trace\n", fname);
+    return (1);
+  }
+
+  memcpy (&hdr, trc, sizeof(hdr));
+
+  if ((hdr.magic != SERIAL_TRACE_MAGIC) || (hdr.tick_freq == 0U)) {
+    fprintf (stderr, "%s: not a serial trace\n", fname);
+    return (1);
+  }
+
+  Rep.trc       = &trc[sizeof(hdr)];
+  Rep.trc_len   = (uint32_t)len - sizeof(hdr);
+  Rep.tick_freq = hdr.tick_freq;
+
+  if (AT_Parser_Initialize() < 0) {
+    fprintf (stderr, "parser initialization failed\n");
+    return (1);
+  }
+
+  Rep.t_start = TimeNs();
+
+  do {
+    n = ReplayNext();
+
+    if (n == 1) {
+      AT_Parser_Execute();
+    }
+  }
+  while (n != -1);
+
+  ns = TimeNs() - Rep.t_start - Rep.t_wait;
+
+  PrintStats (ns);
+
+  AT_Parser_Uninitialize();
+  free (trc);
+
+  return (0);
+}
@@ -0,0 +1,2 @@
+/* Host build: case sensitive file system include shim */
+#include "../../src/Driver_Modem.h"
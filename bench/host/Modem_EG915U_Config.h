@@ -0,0 +1,19 @@
+/* Host build: case sensitive file system include shim */
+#ifndef HOST_MODEM_EG915U_CONFIG_H__
+#define HOST_MODEM_EG915U_CONFIG_H__
+
+#include "../../src/Config/MODEM_EG915U_Config.h"
+
+/* Parser state profile, make serial_replay PROFILE=1 */
+#ifdef HOST_PARSER_PROFILE
+#undef  MOD_EG915U_PARSER_PROFILE
+#define MOD_EG915U_PARSER_PROFILE         HOST_PARSER_PROFILE
+#endif
+
+/* Command pipeline depth, make batch_replay DEPTH=n */
+#ifdef HOST_CMD_PIPELINE_DEPTH
+#undef  MOD_EG915U_CMD_PIPELINE_DEPTH
+#define MOD_EG915U_CMD_PIPELINE_DEPTH     HOST_CMD_PIPELINE_DEPTH
+#endif
+
+#endif /* HOST_MODEM_EG915U_CONFIG_H__ */
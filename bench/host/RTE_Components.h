@@ -0,0 +1,7 @@
+/* Host build: run time environment components */
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+#define CMSIS_device_header "host_device.h"
+
+#endif /* RTE_COMPONENTS_H */
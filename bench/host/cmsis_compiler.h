@@ -0,0 +1,15 @@
+/* Host build: compiler specific macros */
+#ifndef HOST_CMSIS_COMPILER_H__
+#define HOST_CMSIS_COMPILER_H__
+
+#ifndef __WEAK
+#define __WEAK                  __attribute__((weak))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE         static inline
+#endif
+
+#endif /* HOST_CMSIS_COMPILER_H__ */
@@ -0,0 +1,157 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Minimal CMSIS-RTOS2 subset for building the buffer layer on a host.
+  Memory pools are backed by malloc and mutexes are no-ops, benchmarks
+  run single threaded.
+*/
+#ifndef HOST_CMSIS_OS2_H__
+#define HOST_CMSIS_OS2_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef enum {
+  osOK            =  0,
+  osError         = -1,
+  osErrorResource = -3,
+  osErrorParameter= -4
+} osStatus_t;
+
+typedef void *osMutexId_t;
+typedef void *osMemoryPoolId_t;
+
+#define osWaitForever     0xFFFFFFFFU
+
+/* Object attributes (content ignored on host) */
+typedef struct {
+  const char *name;
+  uint32_t    attr_bits;
+  void       *cb_mem;
+  uint32_t    cb_size;
+  void       *mp_mem;
+  uint32_t    mp_size;
+} osMemoryPoolAttr_t;
+
+typedef struct {
+  const char *name;
+  uint32_t    attr_bits;
+  void       *cb_mem;
+  uint32_t    cb_size;
+} osMutexAttr_t, osEventFlagsAttr_t, osTimerAttr_t;
+
+typedef struct {
+  const char *name;
+  uint32_t    attr_bits;
+  void       *cb_mem;
+  uint32_t    cb_size;
+  void       *stack_mem;
+  uint32_t    stack_size;
+  int32_t     priority;
+  uint32_t    tz_module;
+  uint32_t    reserved;
+} osThreadAttr_t;
+
+/* Host memory pool control block */
+typedef struct {
+  uint32_t block_size;
+  uint32_t block_count;
+  uint32_t used;
+} HOST_MEMPOOL;
+
+static inline osMemoryPoolId_t osMemoryPoolNew (uint32_t block_count, uint32_t block_size, const void *attr) {
+  HOST_MEMPOOL *mp = malloc (sizeof(HOST_MEMPOOL));
+  (void)attr;
+  if (mp != NULL) {
+    mp->block_size  = block_size;
+    mp->block_count = block_count;
+    mp->used        = 0U;
+  }
+  return (mp);
+}
+
+static inline osStatus_t osMemoryPoolDelete (osMemoryPoolId_t mp_id) {
+  free (mp_id);
+  return (osOK);
+}
+
+static inline void *osMemoryPoolAlloc (osMemoryPoolId_t mp_id, uint32_t timeout) {
+  HOST_MEMPOOL *mp = (HOST_MEMPOOL *)mp_id;
+  (void)timeout;
+  if (mp->used == mp->block_count) {
+    return (NULL);
+  }
+  mp->used++;
+  return (malloc (mp->block_size));
+}
+
+static inline osStatus_t osMemoryPoolFree (osMemoryPoolId_t mp_id, void *block) {
+  HOST_MEMPOOL *mp = (HOST_MEMPOOL *)mp_id;
+  if (block == NULL) {
+    return (osErrorParameter);
+  }
+  mp->used--;
+  free (block);
+  return (osOK);
+}
+
+static inline uint32_t osMemoryPoolGetBlockSize (osMemoryPoolId_t mp_id) {
+  return (((HOST_MEMPOOL *)mp_id)->block_size);
+}
+
+static inline uint32_t osMemoryPoolGetCapacity (osMemoryPoolId_t mp_id) {
+  return (((HOST_MEMPOOL *)mp_id)->block_count);
+}
+
+static inline uint32_t osMemoryPoolGetCount (osMemoryPoolId_t mp_id) {
+  return (((HOST_MEMPOOL *)mp_id)->used);
+}
+
+static inline uint32_t osMemoryPoolGetSpace (osMemoryPoolId_t mp_id) {
+  HOST_MEMPOOL *mp = (HOST_MEMPOOL *)mp_id;
+  return (mp->block_count - mp->used);
+}
+
+static inline osStatus_t osMutexAcquire (osMutexId_t mutex_id, uint32_t timeout) {
+  (void)mutex_id; (void)timeout;
+  return (osOK);
+}
+
+static inline osStatus_t osMutexRelease (osMutexId_t mutex_id) {
+  (void)mutex_id;
+  return (osOK);
+}
+
+/* Host harnesses run the parser from a single thread, scheduler lock is a no-op */
+static inline int32_t osKernelLock (void) {
+  return (0);
+}
+
+static inline int32_t osKernelRestoreLock (int32_t lock) {
+  return (lock);
+}
+
+/* System timer runs at 1 GHz, count is monotonic time in nanoseconds */
+static inline uint32_t osKernelGetSysTimerCount (void) {
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ((uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec));
+}
+
+static inline uint32_t osKernelGetSysTimerFreq (void) {
+  return (1000000000U);
+}
+
+#endif /* HOST_CMSIS_OS2_H__ */
@@ -0,0 +1,30 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "host_bench.h"
+
+/* Monotonic time in nanoseconds */
+double TimeNs (void) {
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+/* Check condition and report */
+uint32_t Check (const char *name, int cond) {
+  printf ("%-36s %s\n", name, cond ? "ok" : "FAIL");
+
+  return (cond ? 0U : 1U);
+}
@@ -0,0 +1,33 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Helpers shared by the host benchmarks and tests.
+*/
+#ifndef HOST_BENCH_H__
+#define HOST_BENCH_H__
+
+#include <stdint.h>
+
+/**
+  Monotonic time in nanoseconds.
+*/
+extern double TimeNs (void);
+
+/**
+  Print check result.
+
+  \param[in]  name   check description
+  \param[in]  cond   nonzero when the check passed
+  \return 0: passed, 1: failed
+*/
+extern uint32_t Check (const char *name, int cond);
+
+#endif /* HOST_BENCH_H__ */
@@ -0,0 +1,12 @@
+/* Host build: core intrinsics used by the buffer layer */
+#ifndef HOST_DEVICE_H__
+#define HOST_DEVICE_H__
+
+#include <stdint.h>
+
+static inline uint32_t __get_PRIMASK (void) { return (0U); }
+static inline void     __disable_irq (void) { }
+static inline void     __enable_irq  (void) { }
+static inline void     __DMB         (void) { __sync_synchronize(); }
+
+#endif /* HOST_DEVICE_H__ */
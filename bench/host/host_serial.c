@@ -0,0 +1,207 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "EG915U.h"
+#include "EG915U_Serial.h"
+#include "Modem_EG915U_Os.h"
+
+#include "host_serial.h"
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+#error "Host serial driver requires MOD_EG915U_SERIAL_RX_BLOCK disabled"
+#endif
+
+/* Host serial driver */
+typedef struct {
+  uint8_t  rx[HOST_RX_SIZE];
+  uint32_t rx_get;            /* Receive buffer read index            */
+  uint32_t rx_put;            /* Receive buffer write index           */
+  HOST_SERIAL_TX_FUNC tx;     /* Transmit hook                        */
+} HOST_SERIAL;
+
+static HOST_SERIAL Ser;
+
+HOST_POOL_STATS Host_PoolStat;
+
+/* ---------------------------------------------------------------------------
+   Operating system glue
+   ------------------------------------------------------------------------- */
+
+const osMemoryPoolAttr_t AT_Parser_MemPool_Attr   = { "AT Parser MemPool" };
+const osMemoryPoolAttr_t AT_Parser_MemPoolLg_Attr = { "AT Parser MemPool Large" };
+
+#if (PARSER_RING_SIZE != 0)
+uint8_t AT_Parser_RingArr[PARSER_RING_SIZE];
+#endif
+
+static osMemoryPoolId_t Pool_Parser;
+
+static void *Pool_Alloc (void *pool) {
+  void *block;
+
+  block = osMemoryPoolAlloc ((osMemoryPoolId_t)pool, 0U);
+
+  if (block == NULL) {
+    Host_PoolStat.pool_fail++;
+  }
+  else if (pool == Pool_Parser) {
+    if (Host_PoolStat.pool_high < osMemoryPoolGetCount (pool)) {
+      Host_PoolStat.pool_high = osMemoryPoolGetCount (pool);
+    }
+  }
+  return (block);
+}
+
+static int32_t Pool_Free (void *pool, void *block) {
+  return ((osMemoryPoolFree ((osMemoryPoolId_t)pool, block) == osOK) ? 0 : -1);
+}
+
+static uint32_t Pool_GetSpace (void *pool) {
+  return (osMemoryPoolGetSpace ((osMemoryPoolId_t)pool));
+}
+
+static uint32_t Pool_GetBlockSize (void *pool) {
+  return (osMemoryPoolGetBlockSize ((osMemoryPoolId_t)pool));
+}
+
+const BUF_ALLOCATOR Modem_PoolAllocator = {
+  Pool_Alloc,
+  Pool_Free,
+  Pool_GetSpace,
+  Pool_GetBlockSize
+};
+
+void Modem_PoolRegister (uint32_t pool, osMemoryPoolId_t mp_id) {
+  if (pool == MOD_POOL_PARSER) {
+    Pool_Parser = mp_id;
+  }
+}
+
+void Modem_PoolDrop (uint32_t pool, uint32_t num) {
+  (void)pool;
+  (void)num;
+}
+
+/* ---------------------------------------------------------------------------
+   Serial driver
+   ------------------------------------------------------------------------- */
+
+int32_t Serial_Initialize (void) {
+  return (1);
+}
+
+int32_t Serial_Uninitialize (void) {
+  return (0);
+}
+
+int32_t Serial_GetMode (SERIAL_MODE *mode) {
+  memset (mode, 0, sizeof(SERIAL_MODE));
+  return (0);
+}
+
+int32_t Serial_SetMode (SERIAL_MODE *mode) {
+  (void)mode;
+  return (0);
+}
+
+int32_t Serial_SendBuf (const uint8_t *buf, uint32_t len) {
+  if (Ser.tx != NULL) {
+    Ser.tx (buf, len);
+  }
+  return ((int32_t)len);
+}
+
+int32_t Serial_SendBufNoCopy (const uint8_t *buf, uint32_t len) {
+  return (Serial_SendBuf (buf, len));
+}
+
+int32_t Serial_SendSeg (const BUF_SEG *seg, uint32_t cnt) {
+  uint32_t i, n;
+
+  n = 0U;
+  for (i = 0U; i < cnt; i++) {
+    n += (uint32_t)Serial_SendBuf (seg[i].buf, seg[i].len);
+  }
+  return ((int32_t)n);
+}
+
+uint32_t Serial_GetTxPending (void) {
+  return (0U);
+}
+
+uint32_t Serial_GetTxFree (void) {
+  return (SERIAL_TRACE_LEN_MAX);
+}
+
+void Serial_AbortSend (void) {
+}
+
+int32_t Serial_ReadBuf (uint8_t *buf, uint32_t len) {
+  uint32_t n;
+
+  n = Ser.rx_put - Ser.rx_get;
+
+  if (n > len) {
+    n = len;
+  }
+
+  memcpy (buf, &Ser.rx[Ser.rx_get], n);
+  Ser.rx_get += n;
+
+  if (Ser.rx_get == Ser.rx_put) {
+    /* Buffer empty, restart at the buffer start */
+    Ser.rx_get = 0U;
+    Ser.rx_put = 0U;
+  }
+
+  return ((int32_t)n);
+}
+
+uint32_t Serial_GetRxCount (void) {
+  return (Ser.rx_put - Ser.rx_get);
+}
+
+uint32_t Serial_GetRxError (void) {
+  return (0U);
+}
+
+/* ---------------------------------------------------------------------------
+   Harness interface
+   ------------------------------------------------------------------------- */
+
+void Host_SerialTxHook (HOST_SERIAL_TX_FUNC func) {
+  Ser.tx = func;
+}
+
+void Host_SerialRxPut (const uint8_t *data, uint32_t len) {
+
+  if ((Ser.rx_put + len) > HOST_RX_SIZE) {
+    /* Move unread data to the buffer start */
+    memmove (&Ser.rx[0], &Ser.rx[Ser.rx_get], Ser.rx_put - Ser.rx_get);
+    Ser.rx_put -= Ser.rx_get;
+    Ser.rx_get  = 0U;
+  }
+
+  if ((Ser.rx_put + len) > HOST_RX_SIZE) {
+    /* Parser stopped reading, drop the oldest data */
+    Ser.rx_get = 0U;
+    Ser.rx_put = 0U;
+  }
+
+  memcpy (&Ser.rx[Ser.rx_put], data, len);
+  Ser.rx_put += len;
+}
+
+void Host_SerialRxFlush (void) {
+  Ser.rx_get = 0U;
+  Ser.rx_put = 0U;
+}
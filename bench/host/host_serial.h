@@ -0,0 +1,61 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM host benchmarks
+ * -------------------------------------------------------------------------- */
+
+/*
+  Host serial driver and memory pool glue for running the AT parser on a host.
+
+  Serial_xxx functions are backed by a receive buffer filled by the harness
+  with Host_SerialRxPut, transmitted data is passed to the harness transmit
+  hook. Modem_PoolAllocator allocates from the CMSIS-RTOS2 stub pools and
+  counts allocation failures and parser pool usage.
+*/
+#ifndef HOST_SERIAL_H__
+#define HOST_SERIAL_H__
+
+#include <stdint.h>
+
+/* Receive buffer size (trace record length is below 32k) */
+#define HOST_RX_SIZE      65536U
+
+/* Transmit hook, called with data sent by the parser */
+typedef void (*HOST_SERIAL_TX_FUNC) (const uint8_t *buf, uint32_t len);
+
+/* Memory pool statistics */
+typedef struct {
+  uint32_t pool_fail;         /* Pool allocation failures             */
+  uint32_t pool_high;         /* Parser pool blocks used (peak)       */
+} HOST_POOL_STATS;
+
+extern HOST_POOL_STATS Host_PoolStat;
+
+/**
+  Set transmit hook.
+
+  \param[in]  func   hook function, NULL to discard transmitted data
+*/
+extern void Host_SerialTxHook (HOST_SERIAL_TX_FUNC func);
+
+/**
+  Append data to the receive buffer, read by the parser with Serial_ReadBuf.
+
+  Unread data is moved to the buffer start when space runs out, buffered
+  data is dropped when the parser stopped reading.
+
+  \param[in]  data   received data
+  \param[in]  len    data length
+*/
+extern void Host_SerialRxPut (const uint8_t *data, uint32_t len);
+
+/**
+  Drop all data in the receive buffer.
+*/
+extern void Host_SerialRxFlush (void);
+
+#endif /* HOST_SERIAL_H__ */
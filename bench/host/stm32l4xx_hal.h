@@ -0,0 +1,2 @@
+/* Host build: device HAL header included by Modem_HTTP.h */
+#include <stdint.h>
@@ -0,0 +1,257 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ * $Revision:    V1.0
+ *
+ * Project:      Block allocators for list buffers
+ * -------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "BufAllocator.h"
+
+#if (BUF_LIST_RTOS != 0)
+#include "cmsis_os2.h"                  // ARM::CMSIS:RTOS2:Keil RTX5
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* CMSIS-RTOS2 memory pool                                                    */
+/* -------------------------------------------------------------------------- */
+
+#if (BUF_LIST_RTOS != 0)
+static void *Pool_Alloc (void *pool) {
+  return (osMemoryPoolAlloc ((osMemoryPoolId_t)pool, 0U));
+}
+
+static int32_t Pool_Free (void *pool, void *block) {
+  int32_t rval;
+
+  if (osMemoryPoolFree ((osMemoryPoolId_t)pool, block) == osOK) {
+    rval = 0;
+  } else {
+    rval = -1;
+  }
+
+  return (rval);
+}
+
+static uint32_t Pool_GetSpace (void *pool) {
+  return (osMemoryPoolGetSpace ((osMemoryPoolId_t)pool));
+}
+
+static uint32_t Pool_GetBlockSize (void *pool) {
+  return (osMemoryPoolGetBlockSize ((osMemoryPoolId_t)pool));
+}
+
+const BUF_ALLOCATOR BufAllocator_Pool = {
+  Pool_Alloc,
+  Pool_Free,
+  Pool_GetSpace,
+  Pool_GetBlockSize
+};
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* Static arena                                                               */
+/* -------------------------------------------------------------------------- */
+
+/* Free list head: upper 16 bits tag (ABA protection), lower 16 bits block index */
+#define ARENA_NIL         0xFFFFU
+#define ARENA_IDX(h)      ((h) & 0xFFFFU)
+#define ARENA_TAG(h)      ((h) & 0xFFFF0000U)
+#define ARENA_HEAD(h, i)  ((ARENA_TAG(h) + 0x10000U) | (i))
+
+/* Return pointer to the arena block */
+static uint8_t *ArenaBlock (BUF_ARENA *a, uint32_t idx) {
+  return (&a->mem[idx * a->bl_size]);
+}
+
+int32_t BufArenaInit (void *mem, uint32_t bl_size, uint32_t bl_count, BUF_ARENA *a) {
+  int32_t  rval;
+  uint32_t i;
+
+  if ((a == NULL) || (mem == NULL) || (bl_size < sizeof(uint32_t)) ||
+      (bl_count == 0U) || (bl_count >= ARENA_NIL)) {
+    /* Arena or storage invalid */
+    rval = -1;
+  }
+  else {
+    a->mem      = (uint8_t *)mem;
+    a->bl_size  = BUF_ARENA_BLOCK_SIZE(bl_size);
+    a->bl_count = bl_count;
+    a->used     = 0U;
+
+    /* Link all blocks into the free list, first word holds next index */
+    for (i = 0U; i < bl_count; i++) {
+      *(uint32_t *)ArenaBlock (a, i) = ((i + 1U) < bl_count) ? (i + 1U) : ARENA_NIL;
+    }
+
+    a->head = 0U;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+static void *Arena_Alloc (void *pool) {
+  BUF_ARENA *a = (BUF_ARENA *)pool;
+  uint32_t   head, next;
+  uint8_t   *block;
+
+  block = NULL;
+  head  = __atomic_load_n (&a->head, __ATOMIC_ACQUIRE);
+
+  while (ARENA_IDX(head) != ARENA_NIL) {
+    block = ArenaBlock (a, ARENA_IDX(head));
+
+    /* Block may be taken meanwhile, tag change then fails the exchange */
+    next = *(volatile uint32_t *)block;
+
+    if (__atomic_compare_exchange_n (&a->head, &head, ARENA_HEAD(head, ARENA_IDX(next)),
+                                     0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      /* Block removed from the free list */
+      (void)__atomic_fetch_add (&a->used, 1U, __ATOMIC_RELAXED);
+      break;
+    }
+
+    block = NULL;
+  }
+
+  return (block);
+}
+
+static int32_t Arena_Free (void *pool, void *block) {
+  BUF_ARENA *a = (BUF_ARENA *)pool;
+  uint32_t   head, idx, offs;
+  int32_t    rval;
+
+  rval = -1;
+
+  if ((uint8_t *)block >= a->mem) {
+    offs = (uint32_t)((uint8_t *)block - a->mem);
+    idx  = offs / a->bl_size;
+
+    if ((idx < a->bl_count) && ((offs % a->bl_size) == 0U)) {
+      /* Block belongs to this arena, push it to the free list */
+      head = __atomic_load_n (&a->head, __ATOMIC_ACQUIRE);
+
+      do {
+        *(volatile uint32_t *)block = ARENA_IDX(head);
+      }
+      while (!__atomic_compare_exchange_n (&a->head, &head, ARENA_HEAD(head, idx),
+                                           0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+      (void)__atomic_fetch_sub (&a->used, 1U, __ATOMIC_RELAXED);
+
+      rval = 0;
+    }
+  }
+
+  return (rval);
+}
+
+static uint32_t Arena_GetSpace (void *pool) {
+  BUF_ARENA *a = (BUF_ARENA *)pool;
+
+  return (a->bl_count - a->used);
+}
+
+static uint32_t Arena_GetBlockSize (void *pool) {
+  return (((BUF_ARENA *)pool)->bl_size);
+}
+
+const BUF_ALLOCATOR BufAllocator_Arena = {
+  Arena_Alloc,
+  Arena_Free,
+  Arena_GetSpace,
+  Arena_GetBlockSize
+};
+
+/* -------------------------------------------------------------------------- */
+/* Heap                                                                       */
+/* -------------------------------------------------------------------------- */
+
+int32_t BufHeapInit (uint32_t bl_size, uint32_t bl_count, BUF_HEAP *h) {
+  int32_t rval;
+
+  if ((h == NULL) || (bl_size == 0U)) {
+    rval = -1;
+  }
+  else {
+    h->bl_size  = bl_size;
+    h->bl_count = bl_count;
+    h->used     = 0U;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+static void *Heap_Alloc (void *pool) {
+  BUF_HEAP *h = (BUF_HEAP *)pool;
+  void     *block;
+
+  block = NULL;
+
+  if (h->used < h->bl_count) {
+    block = malloc (h->bl_size);
+
+    if (block != NULL) {
+      h->used++;
+    }
+  }
+
+  return (block);
+}
+
+static int32_t Heap_Free (void *pool, void *block) {
+  BUF_HEAP *h = (BUF_HEAP *)pool;
+  int32_t   rval;
+
+  if ((block == NULL) || (h->used == 0U)) {
+    rval = -1;
+  }
+  else {
+    free (block);
+    h->used--;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+static uint32_t Heap_GetSpace (void *pool) {
+  BUF_HEAP *h = (BUF_HEAP *)pool;
+
+  return (h->bl_count - h->used);
+}
+
+static uint32_t Heap_GetBlockSize (void *pool) {
+  return (((BUF_HEAP *)pool)->bl_size);
+}
+
+const BUF_ALLOCATOR BufAllocator_Heap = {
+  Heap_Alloc,
+  Heap_Free,
+  Heap_GetSpace,
+  Heap_GetBlockSize
+};
@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ * $Revision:    V1.0
+ *
+ * Project:      Block allocators for list buffers
+ * -------------------------------------------------------------------------- */
+
+#ifndef BUFALLOCATOR_H__
+#define BUFALLOCATOR_H__
+
+#include <stdint.h>
+
+/*
+  CMSIS-RTOS2 support
+
+  Set BUF_LIST_RTOS to 0 for deployments and host builds without
+  CMSIS-RTOS2. Memory pool allocator and buffer access mutex are then
+  not available, use arena or heap allocator instead.
+*/
+#ifndef BUF_LIST_RTOS
+#define BUF_LIST_RTOS     1
+#endif
+
+/*
+  Block allocator interface
+
+  Each function receives the pool handle given to BufInitAlloc.
+*/
+typedef struct {
+  void    *(*Alloc)        (void *pool);              /* Allocate a block, NULL if exhausted */
+  int32_t  (*Free)         (void *pool, void *block); /* Free a block, 0:ok, -1:error        */
+  uint32_t (*GetSpace)     (void *pool);              /* Number of free blocks               */
+  uint32_t (*GetBlockSize) (void *pool);              /* Block size in bytes                 */
+} BUF_ALLOCATOR;
+
+/*
+  Static arena
+
+  Blocks are kept in a free list with a tagged head index and updated with
+  compare and swap, allocation and release are lock-free and can be used
+  from interrupt service routines.
+*/
+typedef struct {
+  uint8_t          *mem;       /* Arena storage                   */
+  uint32_t          bl_size;   /* Block size (pointer aligned)    */
+  uint32_t          bl_count;  /* Number of blocks                */
+  volatile uint32_t head;      /* Free list head (tag | index)    */
+  volatile uint32_t used;      /* Number of allocated blocks      */
+} BUF_ARENA;
+
+/* Arena block size and storage size required for bl_count blocks of bl_size bytes */
+#define BUF_ARENA_BLOCK_SIZE(bl_size)            (((bl_size) + sizeof(void *) - 1U) & ~(sizeof(void *) - 1U))
+#define BUF_ARENA_MEM_SIZE(bl_count, bl_size)    ((bl_count) * BUF_ARENA_BLOCK_SIZE(bl_size))
+
+/*
+  Heap
+
+  Blocks are allocated using malloc, number of blocks is limited to bl_count.
+  Intended for host builds, not interrupt safe.
+*/
+typedef struct {
+  uint32_t          bl_size;   /* Block size                      */
+  uint32_t          bl_count;  /* Maximum number of blocks        */
+  volatile uint32_t used;      /* Number of allocated blocks      */
+} BUF_HEAP;
+
+#if (BUF_LIST_RTOS != 0)
+/* CMSIS-RTOS2 memory pool allocator, pool handle is osMemoryPoolId_t */
+extern const BUF_ALLOCATOR BufAllocator_Pool;
+#endif
+
+/* Static arena allocator, pool handle is BUF_ARENA pointer */
+extern const BUF_ALLOCATOR BufAllocator_Arena;
+
+/* Heap allocator, pool handle is BUF_HEAP pointer */
+extern const BUF_ALLOCATOR BufAllocator_Heap;
+
+/**
+  Initialize static arena.
+
+  \param[in]  mem       arena storage, pointer aligned, BUF_ARENA_MEM_SIZE bytes
+  \param[in]  bl_size   block size in bytes
+  \param[in]  bl_count  number of blocks (max 65535)
+  \param[in]  a         arena pointer
+  \return 0 on success, -1 on invalid parameter
+*/
+extern int32_t BufArenaInit (void *mem, uint32_t bl_size, uint32_t bl_count, BUF_ARENA *a);
+
+/**
+  Initialize heap allocator.
+
+  \param[in]  bl_size   block size in bytes
+  \param[in]  bl_count  maximum number of blocks
+  \param[in]  h         heap pointer
+  \return 0 on success, -1 on invalid parameter
+*/
+extern int32_t BufHeapInit (uint32_t bl_size, uint32_t bl_count, BUF_HEAP *h);
+
+#endif /* BUFALLOCATOR_H__ */
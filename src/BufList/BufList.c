@@ -23,9 +23,14 @@
  * Project:      Buffering using CMSIS-RTOS2 memory pools as storage
  * -------------------------------------------------------------------------- */
 
-#include "cmsis_os2.h"                  // ARM::CMSIS:RTOS2:Keil RTX5
+#include <string.h>
+
 #include "BufList.h"
 
+#if (BUF_LIST_RTOS != 0)
+#include "cmsis_os2.h"                  // ARM::CMSIS:RTOS2:Keil RTX5
+#endif
+
 /*
   Head buffer: first in list, contains oldest buffer, where read operation starts
   Tail buffer: last in list,  contains newest buffer, where write operation starts
@@ -33,6 +38,8 @@
 
 typedef struct {
   Link_t link;     /* Linked list        */
+  uint16_t sz;     /* Buffer data size   */
+  uint16_t cls;    /* Block size class   */
   uint16_t wri;    /* Buffer write index */
   uint16_t rdi;    /* Buffer read index  */
   uint8_t  data[]; /* Buffered data      */
@@ -40,24 +47,84 @@ typedef struct {
 
 /* Lock buffer access */
 static void Lock (BUF_LIST *p) {
+#if (BUF_LIST_RTOS != 0)
   if (p->mutex != NULL) {
     osMutexAcquire (p->mutex, osWaitForever);
   }
+#else
+  (void)p;
+#endif
 }
 
 /* Unlock buffer access */
 static void Unlock (BUF_LIST *p) {
+#if (BUF_LIST_RTOS != 0)
   if (p->mutex != NULL) {
     osMutexRelease (p->mutex);
   }
+#else
+  (void)p;
+#endif
+}
+
+/*
+  Transactions
+
+  Each BufXxx function locks the list buffer for the duration of the call.
+  BufBegin and BufEnd lock it for a sequence of BufXxxUnlocked calls.
+*/
+void BufBegin (BUF_LIST *p) {
+  Lock(p);
+}
+
+void BufEnd (BUF_LIST *p) {
+  Unlock(p);
+}
+
+/* Size classes */
+#define BUF_CLS_SMALL     0U
+#define BUF_CLS_LARGE     1U
+
+/* Get memory pool of the specified size class */
+static void *Pool (BUF_LIST *p, uint32_t cls) {
+  return ((cls == BUF_CLS_LARGE) ? p->mp_lg : p->mp_id);
+}
+
+/* Get the size of data area in a memory pool block */
+static uint16_t BlockSize (uint16_t bl_sz) {
+  if (bl_sz != 0U) {
+    /* Memory pool block size reduced for buffer header */
+    bl_sz -= sizeof(MEM_BUF);
+  }
+
+  return (bl_sz);
 }
 
-/* Allocate memory block, put it into buffer list and return pointer to buffer */
-static MEM_BUF *Alloc (BUF_LIST *p) {
+/*
+  Allocate memory block, put it into buffer list and return pointer to buffer.
+
+  Large block is used when the expected write size (hint) does not fit into
+  a small block. When the selected class is exhausted the other one is used.
+*/
+static MEM_BUF *Alloc (BUF_LIST *p, uint32_t hint) {
   MEM_BUF *buf_cb;
   Link_t  *buf_link;
+  uint32_t cls;
 
-  buf_cb = (MEM_BUF *)osMemoryPoolAlloc (p->mp_id, 0U);
+  cls = BUF_CLS_SMALL;
+
+  if ((p->mp_lg != NULL) && (hint > BlockSize (p->bl_sz))) {
+    cls = BUF_CLS_LARGE;
+  }
+
+  buf_cb = (MEM_BUF *)p->alloc->Alloc (Pool (p, cls));
+
+  if ((buf_cb == NULL) && (p->mp_lg != NULL)) {
+    /* Selected class exhausted, try the other one */
+    cls ^= BUF_CLS_LARGE;
+
+    buf_cb = (MEM_BUF *)p->alloc->Alloc (Pool (p, cls));
+  }
 
   if (buf_cb != NULL) {
     /* Buffer allocated, add it to list */
@@ -65,8 +132,17 @@ static MEM_BUF *Alloc (BUF_LIST *p) {
 
     ListPut (&p->list, buf_link);
 
+    if (cls == BUF_CLS_LARGE) {
+      buf_cb->sz = BlockSize (p->bl_lg);
+    } else {
+      buf_cb->sz = BlockSize (p->bl_sz);
+    }
+    buf_cb->cls = (uint16_t)cls;
+
     buf_cb->wri = 0U; //Write index
     buf_cb->rdi = 0U; //Read index
+
+    p->nbl++;
   }
 
   return (buf_cb);
@@ -78,50 +154,295 @@ static MEM_BUF *Free (BUF_LIST *p) {
 
   buf_cb = (MEM_BUF *)ListGet (&p->list);
 
-  if (osMemoryPoolFree (p->mp_id, buf_cb) == osOK) {
-    /* Peek next */
-    buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+  if (buf_cb != NULL) {
+    if (p->alloc->Free (Pool (p, buf_cb->cls), buf_cb) == 0) {
+      p->nbl--;
+
+      /* Peek next */
+      buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+    }
   }
 
   return (buf_cb);
 }
 
-/* Get the size of one block in buffer memory pool */
+/* Get the size of one block in buffer memory pool (small size class) */
 static uint16_t Size (BUF_LIST *p) {
-  uint16_t sz;
+  return (BlockSize (p->bl_sz));
+}
+
+/*
+  Search kernels
+
+  FindByte scans one contiguous run for a byte. The kernel is selected at
+  build time with BUF_FIND_KERNEL:
+    0: C library memchr (default, usually optimized for the target)
+    1: SWAR, 32-bit word at a time
+    2: SSE2, 16 bytes at a time (host builds)
+*/
+#ifndef BUF_FIND_KERNEL
+#define BUF_FIND_KERNEL   0
+#endif
 
-  sz = p->bl_sz;
+#if (BUF_FIND_KERNEL == 2) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-  if (sz != 0U) {
-    /* Memory pool block size reduced for buffer header */
-    sz -= sizeof(MEM_BUF);
+#if (BUF_FIND_KERNEL == 1)
+/* Non-zero if any byte in word x is zero */
+#define SWAR_HAS_ZERO(x)  (((x) - 0x01010101U) & ~(x) & 0x80808080U)
+#endif
+
+/* Find a byte in a contiguous run, return its index or -1 */
+static int32_t FindByte (const uint8_t *buf, uint32_t num, uint8_t data) {
+  int32_t  n;
+#if (BUF_FIND_KERNEL == 0)
+  const uint8_t *ptr;
+
+  ptr = memchr (buf, data, num);
+
+  if (ptr != NULL) {
+    n = (int32_t)(ptr - buf);
+  } else {
+    n = -1;
   }
+#else
+  uint32_t i;
+#if (BUF_FIND_KERNEL == 1)
+  uint32_t w, pat;
 
-  return (sz);
+  /* Bytes up to word alignment are checked by the tail loop */
+  i = (4U - ((uint32_t)(uintptr_t)buf & 3U)) & 3U;
+
+  for (n = 0; (uint32_t)n < i; n++) {
+    if (((uint32_t)n == num) || (buf[n] == data)) {
+      break;
+    }
+  }
+
+  if ((uint32_t)n < i) {
+    /* Found in the unaligned head (or run is shorter) */
+    i = (uint32_t)n;
+  }
+  else {
+    pat = data * 0x01010101U;
+
+    /* Skip whole words which do not contain the byte */
+    while ((i + 4U) <= num) {
+      w = *(const uint32_t *)(const void *)&buf[i] ^ pat;
+
+      if (SWAR_HAS_ZERO(w) != 0U) {
+        break;
+      }
+      i += 4U;
+    }
+  }
+#elif (BUF_FIND_KERNEL == 2) && defined(__SSE2__)
+  __m128i  v, pat;
+
+  i   = 0U;
+  pat = _mm_set1_epi8 ((char)data);
+
+  /* Skip 16-byte chunks which do not contain the byte */
+  while ((i + 16U) <= num) {
+    v = _mm_loadu_si128 ((const __m128i *)(const void *)&buf[i]);
+
+    if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, pat)) != 0) {
+      break;
+    }
+    i += 16U;
+  }
+#else
+  i = 0U;
+#endif
+
+  /* Locate the byte in the remaining part */
+  n = -1;
+
+  while (i < num) {
+    if (buf[i] == data) {
+      n = (int32_t)i;
+      break;
+    }
+    i++;
+  }
+#endif
+
+  return (n);
+}
+
+/*
+  Compare num bytes of data with buffer content starting at rdi of buf_cb,
+  following the chain across block boundaries.
+
+  Return 1 on match, 0 on mismatch, -1 when end of data is reached first.
+*/
+static int32_t Match (const uint8_t *data, uint32_t num, MEM_BUF *buf_cb, uint32_t rdi) {
+  uint32_t cnt;
+  int32_t  rval;
+
+  rval = 1;
+
+  while (num != 0U) {
+    if (rdi >= buf_cb->wri) {
+      /* End of current buffer, continue with next */
+      rdi   -= buf_cb->wri;
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+
+      if (buf_cb == NULL) {
+        /* End of buffer */
+        rval = -1;
+        break;
+      }
+    }
+    else {
+      cnt = buf_cb->wri - rdi;
+
+      if (cnt > num) {
+        cnt = num;
+      }
+
+      if (memcmp (data, &buf_cb->data[rdi], cnt) != 0) {
+        /* No match */
+        rval = 0;
+        break;
+      }
+
+      data += cnt;
+      num  -= cnt;
+      rdi  += cnt;
+    }
+  }
+
+  return (rval);
+}
+
+/*
+  Scan num bytes written at line index scan position for CRLF terminators.
+
+  Return 0 when the run was scanned completely, -1 when the index is full.
+*/
+static int32_t ScanRun (BUF_LINE_INDEX *idx, const uint8_t *buf, uint32_t num) {
+  uint32_t i, cr;
+  int32_t  k, rval;
+
+  rval = 0;
+  i    = 0U;
+
+  while (i < num) {
+    k = FindByte (&buf[i], num - i, '\n');
+
+    if (k == -1) {
+      /* No more line feeds in this run */
+      i = num;
+      break;
+    }
+    i += (uint32_t)k;
+
+    /* Line feed at i, check preceding byte */
+    if (i != 0U) {
+      cr = (buf[i - 1U] == '\r') ? 1U : 0U;
+    } else {
+      cr = idx->cr;
+    }
+
+    if (cr != 0U) {
+      if (idx->num == BUF_LINE_INDEX_SIZE) {
+        /* Index full */
+        rval = -1;
+        break;
+      }
+
+      idx->pos[(idx->head + idx->num) % BUF_LINE_INDEX_SIZE] = idx->scan + i - 1U;
+      idx->num++;
+    }
+    i++;
+  }
+
+  if (rval == 0) {
+    /* Run scanned completely */
+    idx->cr    = (buf[num - 1U] == '\r') ? 1U : 0U;
+    idx->scan += num;
+  }
+  else {
+    /* Resume at CR of the terminator which did not fit */
+    idx->cr    = 0U;
+    idx->scan += i - 1U;
+  }
+
+  return (rval);
+}
+
+/* Account num bytes written into the list buffer from contiguous run buf */
+static void Written (BUF_LIST *p, const uint8_t *buf, uint32_t num) {
+  BUF_LINE_INDEX *idx;
+
+  p->count += num;
+
+  idx = p->lidx;
+
+  if ((idx != NULL) && (num != 0U)) {
+    if (idx->scan == idx->wpos) {
+      /* Index is up to date, scan new data */
+      (void)ScanRun (idx, buf, num);
+    }
+    idx->wpos += num;
+  }
 }
 
+#if (BUF_LIST_RTOS != 0)
 /**
   Initialize buffer list.
 */
 int32_t BufInit (void *mp_id, void *mutex, BUF_LIST *p) {
+  return (BufInitAlloc (&BufAllocator_Pool, mp_id, NULL, mutex, p));
+}
+
+/**
+  Initialize buffer list with small and large block memory pools.
+*/
+int32_t BufInitEx (void *mp_id, void *mp_lg, void *mutex, BUF_LIST *p) {
+  return (BufInitAlloc (&BufAllocator_Pool, mp_id, mp_lg, mutex, p));
+}
+#endif
+
+/**
+  Initialize buffer list using the specified block allocator.
+*/
+int32_t BufInitAlloc (const BUF_ALLOCATOR *alloc, void *mp_id, void *mp_lg, void *mutex, BUF_LIST *p) {
   int32_t  rval;
-  uint32_t bl_sz;
+  uint32_t bl_sz, bl_lg;
 
-  if ((p == NULL) || (mp_id == NULL)) {
-    /* Buffer list or memory pool invalid */
+  if ((p == NULL) || (alloc == NULL) || (mp_id == NULL)) {
+    /* Buffer list, allocator or memory pool invalid */
     rval = -1;
   }
   else {
-    bl_sz = osMemoryPoolGetBlockSize (mp_id);
+    bl_sz = alloc->GetBlockSize (mp_id);
+    bl_lg = 0U;
+
+    if (mp_lg != NULL) {
+      bl_lg = alloc->GetBlockSize (mp_lg);
+    }
 
-    if (bl_sz > UINT16_MAX) {
+    if ((bl_sz > UINT16_MAX) || (bl_lg > UINT16_MAX)) {
       /* Not supported */
       rval = -1;
     }
+    else if ((mp_lg != NULL) && (bl_lg <= bl_sz)) {
+      /* Large blocks must be larger than small blocks */
+      rval = -1;
+    }
     else {
+      p->alloc = alloc;
       p->mutex = mutex;
       p->mp_id = mp_id;
+      p->mp_lg = mp_lg;
       p->bl_sz = (uint16_t)bl_sz;
+      p->bl_lg = (uint16_t)bl_lg;
+      p->lidx  = NULL;
+      p->nbl   = 0U;
+      p->count = 0U;
 
       ListInit (&p->list);
 
@@ -151,19 +472,20 @@ int32_t BufUninit (BUF_LIST *p) {
 
     ListInit (&p->list);
 
+    p->nbl   = 0U;
+    p->count = 0U;
+
     rval = 0;
   }
   return (rval);
 }
 
 
-BUF_MEM *BufAlloc (BUF_LIST *p) {
+BUF_MEM *BufAllocUnlocked (BUF_LIST *p) {
   MEM_BUF *buf_cb;
   BUF_MEM *usr_cb; //User control block
 
-  Lock(p);
-
-  buf_cb = Alloc (p);
+  buf_cb = Alloc (p, 0U);
 
   if (buf_cb != NULL) {
     /* Set pointer to write index */
@@ -173,18 +495,24 @@ BUF_MEM *BufAlloc (BUF_LIST *p) {
     usr_cb = NULL;
   }
 
+  return (usr_cb);
+}
+
+BUF_MEM *BufAlloc (BUF_LIST *p) {
+  BUF_MEM *rval;
+
+  Lock(p);
+  rval = BufAllocUnlocked (p);
   Unlock(p);
 
-  return (usr_cb);
+  return (rval);
 }
 
 
-BUF_MEM *BufFree (BUF_LIST *p) {
+BUF_MEM *BufFreeUnlocked (BUF_LIST *p) {
   MEM_BUF *buf_cb;
   BUF_MEM *usr_cb; //User control block
 
-  Lock(p);
-
   buf_cb = Free (p);
 
   if (buf_cb != NULL) {
@@ -195,9 +523,17 @@ BUF_MEM *BufFree (BUF_LIST *p) {
     usr_cb = NULL;
   }
 
+  return (usr_cb);
+}
+
+BUF_MEM *BufFree (BUF_LIST *p) {
+  BUF_MEM *rval;
+
+  Lock(p);
+  rval = BufFreeUnlocked (p);
   Unlock(p);
 
-  return (usr_cb);
+  return (rval);
 }
 
 /*
@@ -206,17 +542,15 @@ BUF_MEM *BufFree (BUF_LIST *p) {
   -- If current buffer is full, allocate new
   -- If out of memory, return NULL
 */
-BUF_MEM *BufGetTail (BUF_LIST *p) {
+BUF_MEM *BufGetTailUnlocked (BUF_LIST *p) {
   MEM_BUF *buf_cb;
   BUF_MEM *usr_cb; //User control block
 
-  Lock(p);
-
   usr_cb = NULL;
   buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
 
   if (buf_cb != NULL) {
-    if (buf_cb->wri < Size (p)) {
+    if (buf_cb->wri < buf_cb->sz) {
       /* Set pointer to wri member */
       usr_cb = (BUF_MEM *)&buf_cb->wri;
     }
@@ -224,90 +558,103 @@ BUF_MEM *BufGetTail (BUF_LIST *p) {
 
   if (usr_cb == NULL) {
     /* Allocate new buffer */
-    usr_cb = BufAlloc (p);
+    buf_cb = Alloc (p, 0U);
+
+    if (buf_cb != NULL) {
+      usr_cb = (BUF_MEM *)&buf_cb->wri;
+    }
   }
 
+  return (usr_cb);
+}
+
+BUF_MEM *BufGetTail (BUF_LIST *p) {
+  BUF_MEM *rval;
+
+  Lock(p);
+  rval = BufGetTailUnlocked (p);
   Unlock(p);
 
-  return (usr_cb);
+  return (rval);
 }
 
 
-uint16_t BufGetSize (BUF_LIST *p) {
+uint16_t BufGetSizeUnlocked (BUF_LIST *p) {
   uint16_t sz;
 
-  Lock(p);
-
   sz = Size (p);
 
-  Unlock(p);
-
   return ((uint16_t)sz);
 }
 
-uint32_t BufGetFree (BUF_LIST *p) {
-  MEM_BUF *buf_cb;
-  uint32_t maxi, sz;
+uint16_t BufGetSize (BUF_LIST *p) {
+  uint16_t rval;
 
   Lock(p);
+  rval = BufGetSizeUnlocked (p);
+  Unlock(p);
+
+  return (rval);
+}
+
+uint32_t BufGetFreeUnlocked (BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t sz;
 
-  /* Size of one buffer (mem pool block - header */
-  maxi = Size (p);
+  /* Size of one buffer (mem pool block - header), multiplied by the number of free memory pool blocks */
+  sz = Size (p) * p->alloc->GetSpace (p->mp_id);
 
-  /* Multiplied by the number of free memory pool blocks */
-  sz = maxi * osMemoryPoolGetSpace (p->mp_id);
+  if (p->mp_lg != NULL) {
+    /* Add free large blocks */
+    sz += BlockSize (p->bl_lg) * p->alloc->GetSpace (p->mp_lg);
+  }
 
   /* Add number of bytes available in the tail buffer */
   buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
 
   if (buf_cb != NULL) {
-    sz += (maxi - buf_cb->wri);
+    sz += (buf_cb->sz - buf_cb->wri);
   }
 
+  return (sz);
+}
+
+uint32_t BufGetFree (BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufGetFreeUnlocked (p);
   Unlock(p);
 
-  return (sz);
+  return (rval);
 }
 
 /**
   Retrieve number of bytes in the buffer.
 */
 uint32_t BufGetCount (BUF_LIST *p) {
-  MEM_BUF *buf_cb;
-  uint32_t n;
-
-  Lock(p);
-
-  n = 0U;
-  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
-
-  while (buf_cb != NULL) {
-    /* Determine number of bytes in the current buffer */
-    n += (buf_cb->wri - buf_cb->rdi);
-
-    /* Load next buffer */
-    buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
-  }
-
-  Unlock(p);
+  /* Single word read, no locking required */
+  return (p->count);
+}
 
-  /* Return total number of bytes in the buffer */
-  return (n);
+/**
+  Retrieve number of memory blocks allocated by the list buffer.
+*/
+uint32_t BufGetBlockCount (BUF_LIST *p) {
+  return (p->nbl);
 }
 
 
-int32_t BufReadByte (BUF_LIST *p) {
+int32_t BufReadByteUnlocked (BUF_LIST *p) {
   MEM_BUF *buf_cb;
   int32_t  rval;
 
-  Lock(p);
-
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
   if (buf_cb != NULL) {
     if (buf_cb->rdi == buf_cb->wri) {
       /* End of current buffer, free it */
-      if (buf_cb->wri == Size(p)) {
+      if (buf_cb->wri == buf_cb->sz) {
         buf_cb = Free(p);
       } else {
         buf_cb = NULL;
@@ -318,29 +665,37 @@ int32_t BufReadByte (BUF_LIST *p) {
   if (buf_cb != NULL) {
     /* Return current byte */
     rval = buf_cb->data[buf_cb->rdi++];
+
+    p->count--;
   }
   else {
     /* End of chain */
     rval = -1;
   }
 
+  return (rval);
+}
+
+int32_t BufReadByte (BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufReadByteUnlocked (p);
   Unlock(p);
 
   return (rval);
 }
 
-int32_t BufPeekByte (BUF_LIST *p) {
+int32_t BufPeekByteUnlocked (BUF_LIST *p) {
   MEM_BUF *buf_cb;
   int32_t  rval;
 
-  Lock(p);
-
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
   if (buf_cb != NULL) {
     if (buf_cb->rdi == buf_cb->wri) {
       /* End of current buffer, free it */
-      if (buf_cb->wri == Size(p)) {
+      if (buf_cb->wri == buf_cb->sz) {
         buf_cb = Free(p);
       } else {
         buf_cb = NULL;
@@ -362,18 +717,24 @@ int32_t BufPeekByte (BUF_LIST *p) {
     rval = -1;
   }
 
+  return (rval);
+}
+
+int32_t BufPeekByte (BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufPeekByteUnlocked (p);
   Unlock(p);
 
   return (rval);
 }
 
-int32_t BufPeekOffs (uint32_t offs, BUF_LIST *p) {
+int32_t BufPeekOffsUnlocked (uint32_t offs, BUF_LIST *p) {
   MEM_BUF *buf_cb;
   uint32_t rdi = 0;
   int32_t  n;
 
-  Lock(p);
-
   n = -1; //End of buffer
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
@@ -408,23 +769,29 @@ int32_t BufPeekOffs (uint32_t offs, BUF_LIST *p) {
     }
   }
 
-  Unlock(p);
-
   return (n);
 }
 
-int32_t BufFlushByte (BUF_LIST *p) {
-  MEM_BUF *buf_cb;
-  int32_t  rval;
+int32_t BufPeekOffs (uint32_t offs, BUF_LIST *p) {
+  int32_t rval;
 
   Lock(p);
+  rval = BufPeekOffsUnlocked (offs, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+int32_t BufFlushByteUnlocked (BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  int32_t  rval;
 
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
   if (buf_cb != NULL) {
     if (buf_cb->rdi == buf_cb->wri) {
       /* End of current buffer, free it */
-      if (buf_cb->wri == Size(p)) {
+      if (buf_cb->wri == buf_cb->sz) {
         buf_cb = Free(p);
       } else {
         buf_cb = NULL;
@@ -440,6 +807,8 @@ int32_t BufFlushByte (BUF_LIST *p) {
     else {
       /* Read byte and increment read index */
       rval = buf_cb->data[buf_cb->rdi++];
+
+      p->count--;
     }
   }
   else {
@@ -447,36 +816,49 @@ int32_t BufFlushByte (BUF_LIST *p) {
     rval = -1;
   }
 
+  return (rval);
+}
+
+int32_t BufFlushByte (BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufFlushByteUnlocked (p);
   Unlock(p);
 
   return (rval);
 }
 
-int32_t BufWriteByte (uint8_t data, BUF_LIST *p) {
+int32_t BufWriteByteUnlocked (uint8_t data, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t maxi;
   int32_t  rval;
 
-  Lock(p);
-
-  maxi = Size (p);
-
   buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
 
-  if ((buf_cb == NULL) || (buf_cb->wri == maxi)) {
+  if ((buf_cb == NULL) || (buf_cb->wri == buf_cb->sz)) {
     /* Buffer full, allocate new */
-    buf_cb = Alloc (p);
+    buf_cb = Alloc (p, 1U);
   }
 
   if (buf_cb != NULL) {
     buf_cb->data[buf_cb->wri++] = data;
 
+    Written (p, &data, 1U);
+
     rval = data;
   }
   else {
     rval = -1;
   }
 
+  return (rval);
+}
+
+int32_t BufWriteByte (uint8_t data, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufWriteByteUnlocked (data, p);
   Unlock(p);
 
   return (rval);
@@ -485,11 +867,9 @@ int32_t BufWriteByte (uint8_t data, BUF_LIST *p) {
 /*
   Read num of bytes into buf and return number of bytes actually read.
 */
-int32_t BufRead (uint8_t *buf, uint32_t num, BUF_LIST *p) {
+int32_t BufReadUnlocked (uint8_t *buf, uint32_t num, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t n;
-
-  Lock(p);
+  uint32_t n, cnt;
 
   n = 0;
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
@@ -498,66 +878,77 @@ int32_t BufRead (uint8_t *buf, uint32_t num, BUF_LIST *p) {
 
     if (buf_cb->rdi == buf_cb->wri) {
       /* End of current buffer, free current, get next one */
-      if (buf_cb->wri == Size(p)) {
+      if (buf_cb->wri == buf_cb->sz) {
         buf_cb = Free(p);
       } else {
         buf_cb = NULL;
       }
     }
     else {
-      while (n < num) {
-        buf[n++] = buf_cb->data[buf_cb->rdi++];
+      /* Copy contiguous run from the current buffer */
+      cnt = buf_cb->wri - buf_cb->rdi;
 
-        if (buf_cb->rdi == buf_cb->wri) {
-          /* End of buffer, go back and reload */
-          break;
-        }
+      if (cnt > (num - n)) {
+        cnt = num - n;
       }
 
+      memcpy (&buf[n], &buf_cb->data[buf_cb->rdi], cnt);
+
+      buf_cb->rdi += (uint16_t)cnt;
+      p->count    -= cnt;
+      n           += cnt;
+
       if (n == num) {
         break;
       }
     }
   }
 
+  return ((int32_t)n);
+}
+
+int32_t BufRead (uint8_t *buf, uint32_t num, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufReadUnlocked (buf, num, p);
   Unlock(p);
 
-  return ((int32_t)n);
+  return (rval);
 }
 
 
 /*
   Write num of bytes from buf and return number of bytes actually written.
 */
-int32_t BufWrite (uint8_t *buf, uint32_t num, BUF_LIST *p) {
+int32_t BufWriteUnlocked (uint8_t *buf, uint32_t num, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t maxi;
-  uint32_t n;
-
-  Lock(p);
-
-  maxi = Size (p);
+  uint32_t n, cnt;
 
   n = 0U;
   buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
 
   do {
-    if ((buf_cb == NULL) || (buf_cb->wri == maxi)) {
+    if ((buf_cb == NULL) || (buf_cb->wri == buf_cb->sz)) {
       /* Buffer full, allocate new */
-      buf_cb = Alloc (p);
+      buf_cb = Alloc (p, num - n);
     }
 
     if (buf_cb != NULL) {
+      /* Copy contiguous run into the current buffer */
+      cnt = buf_cb->sz - buf_cb->wri;
 
-      while (n < num) {
-        buf_cb->data[buf_cb->wri++] = buf[n++];
-
-        if (buf_cb->wri == maxi) {
-          /* End of buffer, go back */
-          break;
-        }
+      if (cnt > (num - n)) {
+        cnt = num - n;
       }
 
+      memcpy (&buf_cb->data[buf_cb->wri], &buf[n], cnt);
+
+      Written (p, &buf[n], cnt);
+
+      buf_cb->wri += (uint16_t)cnt;
+      n           += cnt;
+
       if (n == num) {
         /* All bytes written */
         break;
@@ -565,26 +956,41 @@ int32_t BufWrite (uint8_t *buf, uint32_t num, BUF_LIST *p) {
     }
   } while (buf_cb != NULL);
 
+  return ((int32_t)n);
+}
+
+int32_t BufWrite (uint8_t *buf, uint32_t num, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufWriteUnlocked (buf, num, p);
   Unlock(p);
 
-  return ((int32_t)n);
+  return (rval);
 }
 
 
 /*
   Copy num of bytes from src to dst and return number of bytes actually copied.
+
+  Blocks from the same memory pool and allocator are relinked from src to
+  dst when the source block is full and the destination tail is full (or
+  missing), so that only the tail of the last block written is ever
+  partially filled.
+  Blocks following the head must start at read index 0, partially read
+  source block is therefore relinked only into an empty destination list.
 */
-uint32_t BufCopy (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
+uint32_t BufCopyUnlocked (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
   MEM_BUF *dst_cb, *src_cb;
   uint32_t sz_d, sz_s;
-  uint32_t i;
-  uint32_t maxi;
+  uint32_t i, cnt;
+  uint32_t splice;
 
-  Lock(dst);
-  Lock(src);
+  i = 0U;
 
-  i    = 0U;
-  maxi = Size (dst);
+  /* Blocks can be moved only between lists sharing the memory pools and the allocator */
+  splice = ((dst != src) && (dst->alloc == src->alloc) &&
+            (dst->mp_id == src->mp_id) && (dst->mp_lg == src->mp_lg)) ? 1U : 0U;
 
   dst_cb = (MEM_BUF *)ListPeekTail(&dst->list);
   src_cb = (MEM_BUF *)ListPeekHead(&src->list);
@@ -595,29 +1001,69 @@ uint32_t BufCopy (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
       break;
     }
 
+    if ((splice != 0U) && (src_cb->wri == src_cb->sz)) {
+      sz_s = src_cb->wri - src_cb->rdi;
+
+      if ((dst_cb == NULL) || (dst_cb->wri == dst_cb->sz)) {
+        /* Partially read block can only become head of the destination list */
+        if ((sz_s != 0U) && (sz_s <= (num - i)) &&
+            ((src_cb->rdi == 0U) || (ListPeekHead(&dst->list) == NULL))) {
+          /* Move whole source block to the destination list */
+          ListGet (&src->list);
+          ListPut (&dst->list, (Link_t *)src_cb);
+
+          src->nbl--;
+          dst->nbl++;
+
+          src->count -= sz_s;
+
+          Written (dst, &src_cb->data[src_cb->rdi], sz_s);
+
+          i += sz_s;
+
+          /* Destination tail is full, continue with next source block */
+          dst_cb = NULL;
+          src_cb = (MEM_BUF *)ListPeekHead(&src->list);
+          continue;
+        }
+      }
+    }
+
     if (dst_cb == NULL) {
       /* Allocate new destination buffer */
-      dst_cb = Alloc (dst);
+      dst_cb = Alloc (dst, num - i);
 
       if (dst_cb == NULL) {
         break;
       }
     }
     /* Determine free space in current buffers */
-    sz_d = maxi - dst_cb->wri;
+    sz_d = dst_cb->sz - dst_cb->wri;
     sz_s = src_cb->wri - src_cb->rdi;
 
-    while ((sz_d > 0) && (sz_s > 0) && (i < num)) {
-      dst_cb->data[dst_cb->wri++] = src_cb->data[src_cb->rdi++];
-
-      /* Decrement number of available space/data */
-      sz_d--;
-      sz_s--;
+    /* Copy the largest contiguous run both buffers allow */
+    cnt = (sz_d < sz_s) ? sz_d : sz_s;
 
-      /* Increment number of copied bytes */
-      i++;
+    if (cnt > (num - i)) {
+      cnt = num - i;
     }
 
+    memcpy (&dst_cb->data[dst_cb->wri], &src_cb->data[src_cb->rdi], cnt);
+
+    Written (dst, &src_cb->data[src_cb->rdi], cnt);
+
+    dst_cb->wri += (uint16_t)cnt;
+    src_cb->rdi += (uint16_t)cnt;
+
+    src->count  -= cnt;
+
+    /* Decrement number of available space/data */
+    sz_d -= cnt;
+    sz_s -= cnt;
+
+    /* Increment number of copied bytes */
+    i += cnt;
+
     if (sz_d == 0) {
       /* Destination buffer is full */
       dst_cb = NULL;
@@ -625,7 +1071,7 @@ uint32_t BufCopy (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
 
     if (sz_s == 0) {
       /* Source buffer is empty */
-      if (src_cb->wri == Size(src)) {
+      if (src_cb->wri == src_cb->sz) {
         src_cb = Free(src);
       } else {
         src_cb = NULL;
@@ -633,22 +1079,29 @@ uint32_t BufCopy (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
     }
   }
 
+  /* Return number of copied bytes */
+  return (i);
+}
+
+uint32_t BufCopy (BUF_LIST *dst, BUF_LIST *src, uint32_t num) {
+  uint32_t rval;
+
+  Lock(dst);
+  Lock(src);
+  rval = BufCopyUnlocked (dst, src, num);
   Unlock(src);
   Unlock(dst);
 
-  /* Return number of copied bytes */
-  return (i);
+  return (rval);
 }
 
 
 /*
   Flush num of bytes from the list buffer. List buffer is flushed completely when num equals to zero.
 */
-uint32_t BufFlush (uint32_t num, BUF_LIST *p) {
+uint32_t BufFlushUnlocked (uint32_t num, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t n;
-
-  Lock(p);
+  uint32_t n, cnt;
 
   n = 0U;
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
@@ -657,16 +1110,24 @@ uint32_t BufFlush (uint32_t num, BUF_LIST *p) {
 
     if (buf_cb->rdi == buf_cb->wri) {
       /* End of current buffer, free current, get next one */
-      if (buf_cb->wri == Size(p)) {
+      if (buf_cb->wri == buf_cb->sz) {
         buf_cb = Free(p);
       } else {
         buf_cb = NULL;
       }
     }
     else {
-      buf_cb->rdi++;
+      /* Flush data available in current buffer */
+      cnt = buf_cb->wri - buf_cb->rdi;
+
+      if ((num != 0U) && (cnt > (num - n))) {
+        cnt = num - n;
+      }
+
+      buf_cb->rdi += (uint16_t)cnt;
+      p->count    -= cnt;
       /* Increment number of bytes flushed */
-      n++;
+      n += cnt;
     }
 
     if (num != 0U) {
@@ -677,25 +1138,79 @@ uint32_t BufFlush (uint32_t num, BUF_LIST *p) {
     }
   }
 
+  return (n);
+}
+
+uint32_t BufFlush (uint32_t num, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufFlushUnlocked (num, p);
   Unlock(p);
 
-  return (n);
+  return (rval);
 }
 
 
 /*
   Find the first occurence of a data byte in the list buffer and return its offset from current position.
 */
-int32_t BufFindByte (uint8_t data, BUF_LIST *p) {
+int32_t BufFindByteUnlocked (uint8_t data, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t offs, rdi;
-  int32_t n;
+  uint32_t offs, rdi, cnt;
+  int32_t  n, k;
+
+  n    = -1;
+  offs = 0U;
+
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+
+    do {
+      /* Scan contiguous run of the current buffer */
+      cnt = buf_cb->wri - rdi;
+      k   = FindByte (&buf_cb->data[rdi], cnt, data);
+
+      if (k != -1) {
+        /* Equal data byte found */
+        n = (int32_t)(offs + (uint32_t)k);
+        break;
+      }
+      offs += cnt;
+
+      /* End of current buffer, peek next */
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi    = 0U;
+    }
+    while (buf_cb != NULL);
+  }
+
+  return (n);
+}
+
+int32_t BufFindByte (uint8_t data, BUF_LIST *p) {
+  int32_t rval;
 
   Lock(p);
+  rval = BufFindByteUnlocked (data, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+/*
+  Find the first occurence of a data byte within num bytes starting at offset offs.
+*/
+int32_t BufFindByteRangeUnlocked (uint8_t data, uint32_t offs, uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t base, skip, rdi, cnt;
+  int32_t  n, k;
 
   n    = -1;
+  base = 0U;
   rdi  = 0U;
-  offs = 0U;
 
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
@@ -703,37 +1218,46 @@ int32_t BufFindByte (uint8_t data, BUF_LIST *p) {
     rdi = buf_cb->rdi;
   }
 
-  while (buf_cb != NULL) {
+  while ((buf_cb != NULL) && (num != 0U)) {
+    cnt = buf_cb->wri - rdi;
 
-    if (rdi == buf_cb->wri) {
-      /* End of current buffer, peek next */
-      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+    if (offs < (base + cnt)) {
+      /* Range starts or continues in the current buffer */
+      skip = offs - base;
 
-      /* Reset read index */
-      rdi = 0U;
-    }
-    else {
-      /* Check current buffer */
-      while (rdi < buf_cb->wri) {
-        /* Compare data with current buffer content */
-        if (data == buf_cb->data[rdi]) {
-          /* Equal data byte found */
-          n = (int32_t)offs;
-          break;
-        }
-        offs++;
-        rdi++;
+      cnt -= skip;
+      if (cnt > num) {
+        cnt = num;
       }
 
-      if (n != -1) {
+      k = FindByte (&buf_cb->data[rdi + skip], cnt, data);
+
+      if (k != -1) {
+        /* Equal data byte found */
+        n = (int32_t)(offs + (uint32_t)k);
         break;
       }
+      offs += cnt;
+      num  -= cnt;
     }
+    base += buf_cb->wri - rdi;
+
+    /* End of current buffer, peek next */
+    buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+    rdi    = 0U;
   }
 
+  return (n);
+}
+
+int32_t BufFindByteRange (uint8_t data, uint32_t offs, uint32_t num, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufFindByteRangeUnlocked (data, offs, num, p);
   Unlock(p);
 
-  return (n);
+  return (rval);
 }
 
 
@@ -741,70 +1265,69 @@ int32_t BufFindByte (uint8_t data, BUF_LIST *p) {
   Find the first occurence of a data sequence in the list buffer and return its offset from current position.
   
   num   number of bytes from data to compare
+
+  Candidate positions are located with the single byte kernel and then
+  verified across block boundaries, so overlapping prefixes are not skipped.
 */
-int32_t BufFind (const uint8_t *data, uint32_t num, BUF_LIST *p) {
+int32_t BufFindUnlocked (const uint8_t *data, uint32_t num, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t offs, rdi;
-  uint32_t i;
-  int32_t n;
-
-  Lock(p);
+  uint32_t offs, rdi, cnt;
+  int32_t  n, k, rval;
 
   n    = -1; //No match
-  i    = 0U;
-  rdi  = 0U;
   offs = 0U;
 
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
-  if (buf_cb != NULL) {
+  if ((buf_cb != NULL) && (num != 0U)) {
     rdi = buf_cb->rdi;
-  }
 
-  while (buf_cb != NULL) {
-
-    if (rdi == buf_cb->wri) {
-      /* End of current buffer, peek next */
-      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+    while (buf_cb != NULL) {
+      /* Find first byte of the sequence in the current buffer */
+      cnt = buf_cb->wri - rdi;
+      k   = FindByte (&buf_cb->data[rdi], cnt, data[0]);
 
-      /* Reset read index */
-      rdi = 0U;
-    }
-    else {
-      /* Check current buffer */
-      while (rdi < buf_cb->wri) {
-        /* Compare data with current buffer content */
-        if (data[i] != buf_cb->data[rdi]) {
-          /* Adjust offset for number of matches */
-          if (i == 0) { offs += 1; }
-          else        { offs += i; }
-
-          /* Reset number of matches */
-          i = 0U;
-        }
+      if (k == -1) {
+        /* Not in this buffer, peek next */
+        offs  += cnt;
+        buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+        rdi    = 0U;
+      }
+      else {
+        /* Verify the rest of the sequence */
+        rdi  += (uint32_t)k;
+        offs += (uint32_t)k;
 
-        if (data[i] == buf_cb->data[rdi]) {
-          /* Equal data byte found */
-          i++;
-        }
+        rval = Match (&data[1], num - 1U, buf_cb, rdi + 1U);
 
-        rdi++;
-        if (i == num) {
+        if (rval > 0) {
           /* Compared sequence matches */
           n = (int32_t)offs;
           break;
         }
-      }
+        if (rval < 0) {
+          /* Not enough data to complete the match */
+          break;
+        }
 
-      if (n != -1) {
-        break;
+        /* Continue after the candidate */
+        rdi++;
+        offs++;
       }
     }
   }
 
+  return (n);
+}
+
+int32_t BufFind (const uint8_t *data, uint32_t num, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufFindUnlocked (data, num, p);
   Unlock(p);
 
-  return (n);
+  return (rval);
 }
 
 
@@ -813,64 +1336,588 @@ int32_t BufFind (const uint8_t *data, uint32_t num, BUF_LIST *p) {
   
   \note Does not move buffer pointers
 */
-int32_t BufCompareString (const char *string, uint32_t offs, BUF_LIST *p) {
+int32_t BufCompareStringUnlocked (const char *string, uint32_t offs, BUF_LIST *p) {
   MEM_BUF *buf_cb;
-  uint32_t rdi = 0U;
+  uint32_t rdi, len;
   int32_t  n;
 
-  Lock(p);
-
   n = 0; //No match
   buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
 
   if (buf_cb != NULL) {
     rdi = buf_cb->rdi;
-  }
-
-  while (buf_cb != NULL) {
 
-    if (rdi == buf_cb->wri) {
-      /* End of current buffer, peek next */
+    /* Skip offset in whole runs */
+    while ((buf_cb != NULL) && (offs >= (buf_cb->wri - rdi))) {
+      offs  -= (buf_cb->wri - rdi);
       buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi    = 0U;
+    }
 
-      if (buf_cb == NULL) {
-        /* End of buffer */
-        n = -1;
-      }
-
-      /* Reset read index */
-      rdi = 0U;
+    if (buf_cb == NULL) {
+      /* End of buffer */
+      n = -1;
     }
     else {
-      if (offs != 0U) {
-        offs--;
-        rdi++;
-      }
-      else {
-        while (rdi < buf_cb->wri) {
-          if (string[n] == '\0') {
-            /* End of string */
-            break;
-          }
-          /* Compare string with content of current buffer */
-          if (string[n] != buf_cb->data[rdi]) {
-            /* No match */
-            n = 0;
-            break;
-          }
-          n++;
-          rdi++;
-        }
+      len = strlen (string);
 
-        if ((n <= 0) || (string[n] == '\0')) {
-          /* No match or end of string */
-          break;
+      if (len != 0U) {
+        /* Compare string with content of the buffers */
+        n = Match ((const uint8_t *)string, len, buf_cb, rdi + offs);
+
+        if (n > 0) {
+          /* String matches */
+          n = (int32_t)len;
         }
       }
     }
   }
 
+  return (n);
+}
+
+int32_t BufCompareString (const char *string, uint32_t offs, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufCompareStringUnlocked (string, offs, p);
   Unlock(p);
 
-  return (n);
+  return (rval);
+}
+
+
+/*
+  Match data against a sorted key table, data is read once.
+*/
+int32_t BufMatchKeyUnlocked (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t rdi, lo, hi, i;
+  int32_t  code, end;
+  uint8_t  c;
+
+  code = -1;
+  rdi  = 0U;
+  lo   = 0U;
+  hi   = num;
+
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+
+    /* Skip offset in whole runs */
+    while ((buf_cb != NULL) && (offs >= (buf_cb->wri - rdi))) {
+      offs  -= (buf_cb->wri - rdi);
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi    = 0U;
+    }
+    rdi += offs;
+  }
+
+  for (i = 0U; lo < hi; i++) {
+    end = -1;
+
+    if (key[lo].str[i] == '\0') {
+      /* Shortest key in range ends here */
+      end = key[lo].code;
+      lo++;
+
+      if (mode == BUF_KEY_PREFIX) {
+        code = end;
+      }
+    }
+
+    /* Fetch next byte */
+    while ((buf_cb != NULL) && (rdi == buf_cb->wri)) {
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+      rdi    = 0U;
+    }
+
+    if (buf_cb == NULL) {
+      /* End of buffer */
+      break;
+    }
+
+    c = buf_cb->data[rdi++];
+
+    if ((end >= 0) && (mode == BUF_KEY_TOKEN)) {
+      if ((c == ':') || (c == ',') || (c == ' ') || (c == '\r')) {
+        /* Token ends with the key */
+        code = end;
+        break;
+      }
+    }
+
+    /* Narrow range to keys with byte c at position i, keys are sorted */
+    while ((lo < hi) && ((uint8_t)key[lo].str[i] < c)) {
+      lo++;
+    }
+    while ((lo < hi) && ((uint8_t)key[hi - 1U].str[i] > c)) {
+      hi--;
+    }
+  }
+
+  return (code);
+}
+
+int32_t BufMatchKey (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufMatchKeyUnlocked (key, num, offs, mode, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Retrieve the next contiguous readable region of the head buffer.
+  Exhausted head buffer is freed before the region is determined.
+*/
+uint32_t BufGetReadSpanUnlocked (uint8_t **span, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n;
+
+  n = 0U;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    if ((buf_cb->rdi == buf_cb->wri) && (buf_cb->wri == buf_cb->sz)) {
+      /* End of current buffer, free it */
+      buf_cb = Free(p);
+    }
+  }
+
+  if (buf_cb != NULL) {
+    /* Return pointer to the first unread byte */
+    *span = &buf_cb->data[buf_cb->rdi];
+
+    n = buf_cb->wri - buf_cb->rdi;
+  }
+
+  return (n);
+}
+
+uint32_t BufGetReadSpan (uint8_t **span, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufGetReadSpanUnlocked (span, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Retrieve the contiguous readable region which starts at offset offs from
+  current position. Buffers are not freed, data is not consumed.
+*/
+uint32_t BufPeekSpanUnlocked (uint32_t offs, uint8_t **span, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t rdi, n;
+
+  n = 0U;
+
+  if (offs < p->count) {
+    buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+    rdi    = buf_cb->rdi;
+
+    while (buf_cb != NULL) {
+      n = buf_cb->wri - rdi;
+
+      if (offs < n) {
+        /* Offset is within current buffer */
+        *span = &buf_cb->data[rdi + offs];
+
+        n -= offs;
+        break;
+      }
+
+      /* Skip current buffer */
+      offs  -= n;
+      n      = 0U;
+      rdi    = 0U;
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+    }
+  }
+
+  return (n);
+}
+
+uint32_t BufPeekSpan (uint32_t offs, uint8_t **span, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufPeekSpanUnlocked (offs, span, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Consume num of bytes from the region returned by BufGetReadSpan.
+*/
+uint32_t BufConsumeUnlocked (uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n;
+
+  n = 0U;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  if (buf_cb != NULL) {
+    n = buf_cb->wri - buf_cb->rdi;
+
+    if (n > num) {
+      n = num;
+    }
+
+    buf_cb->rdi += (uint16_t)n;
+    p->count    -= n;
+
+    if ((buf_cb->rdi == buf_cb->wri) && (buf_cb->wri == buf_cb->sz)) {
+      /* End of current buffer, free it */
+      Free(p);
+    }
+  }
+
+  return (n);
+}
+
+uint32_t BufConsume (uint32_t num, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufConsumeUnlocked (num, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Retrieve the next contiguous writable region of the tail buffer.
+  New buffer is allocated when the tail buffer is full or list is empty.
+*/
+uint32_t BufGetWriteSpanUnlocked (uint8_t **span, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n;
+
+  n = 0U;
+
+  buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
+
+  if ((buf_cb == NULL) || (buf_cb->wri == buf_cb->sz)) {
+    /* Buffer full, allocate new (prefer large block for streamed data) */
+    buf_cb = Alloc (p, UINT16_MAX);
+  }
+
+  if (buf_cb != NULL) {
+    /* Return pointer to the first free byte */
+    *span = &buf_cb->data[buf_cb->wri];
+
+    n = buf_cb->sz - buf_cb->wri;
+  }
+
+  return (n);
+}
+
+uint32_t BufGetWriteSpan (uint8_t **span, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufGetWriteSpanUnlocked (span, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Commit num of bytes written into the region returned by BufGetWriteSpan.
+*/
+uint32_t BufCommitUnlocked (uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n;
+
+  n = 0U;
+  buf_cb = (MEM_BUF *)ListPeekTail(&p->list);
+
+  if (buf_cb != NULL) {
+    n = buf_cb->sz - buf_cb->wri;
+
+    if (n > num) {
+      n = num;
+    }
+
+    Written (p, &buf_cb->data[buf_cb->wri], n);
+
+    buf_cb->wri += (uint16_t)n;
+  }
+
+  return (n);
+}
+
+uint32_t BufCommit (uint32_t num, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufCommitUnlocked (num, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Reserve a new block at the tail for an external writer (i.e. DMA).
+*/
+uint32_t BufReserveUnlocked (uint8_t **span, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n;
+
+  n = 0U;
+
+  /* Prefer large block for streamed data */
+  buf_cb = Alloc (p, UINT16_MAX);
+
+  if (buf_cb != NULL) {
+    *span = &buf_cb->data[0];
+
+    n = buf_cb->sz;
+  }
+
+  return (n);
+}
+
+uint32_t BufReserve (uint8_t **span, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufReserveUnlocked (span, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Commit num of bytes written into reserved blocks, oldest not full block first.
+*/
+uint32_t BufCommitReservedUnlocked (uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t n, cnt;
+
+  n = 0U;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  while ((buf_cb != NULL) && (n < num)) {
+    cnt = buf_cb->sz - buf_cb->wri;
+
+    if (cnt != 0U) {
+      if (cnt > (num - n)) {
+        cnt = num - n;
+      }
+
+      Written (p, &buf_cb->data[buf_cb->wri], cnt);
+
+      buf_cb->wri += (uint16_t)cnt;
+
+      n += cnt;
+    }
+
+    if (buf_cb->wri == buf_cb->sz) {
+      buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+    }
+  }
+
+  return (n);
+}
+
+uint32_t BufCommitReserved (uint32_t num, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufCommitReservedUnlocked (num, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Export up to num bytes starting at offs as an array of contiguous segments.
+*/
+uint32_t BufGetSegmentsUnlocked (BUF_SEG *seg, uint32_t max, uint32_t offs, uint32_t num, BUF_LIST *p) {
+  MEM_BUF *buf_cb;
+  uint32_t rdi, cnt, k;
+
+  k = 0U;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  while ((buf_cb != NULL) && (k < max) && (num != 0U)) {
+    rdi = buf_cb->rdi;
+    cnt = buf_cb->wri - rdi;
+
+    if (offs >= cnt) {
+      /* Skip whole block */
+      offs -= cnt;
+    }
+    else {
+      rdi += offs;
+      cnt -= offs;
+      offs = 0U;
+
+      if (cnt > num) {
+        cnt = num;
+      }
+
+      seg[k].buf = &buf_cb->data[rdi];
+      seg[k].len = cnt;
+      k++;
+
+      num -= cnt;
+    }
+
+    buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+  }
+
+  return (k);
+}
+
+uint32_t BufGetSegments (BUF_SEG *seg, uint32_t max, uint32_t offs, uint32_t num, BUF_LIST *p) {
+  uint32_t rval;
+
+  Lock(p);
+  rval = BufGetSegmentsUnlocked (seg, max, offs, num, p);
+  Unlock(p);
+
+  return (rval);
+}
+
+
+/*
+  Attach line index to the list buffer.
+*/
+int32_t BufLineIndex (BUF_LINE_INDEX *idx, BUF_LIST *p) {
+  int32_t rval;
+
+  if (p == NULL) {
+    rval = -1;
+  }
+  else {
+    Lock(p);
+
+    if (idx != NULL) {
+      memset (idx, 0, sizeof(BUF_LINE_INDEX));
+
+      /* Buffered data is scanned on first lookup */
+      idx->wpos = p->count;
+    }
+
+    p->lidx = idx;
+
+    Unlock(p);
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+
+/*
+  Scan buffered data not yet covered by the line index, starting at the
+  index scan position. Stops at the end of data or when the index is full.
+*/
+static void LineRescan (BUF_LIST *p, uint32_t rd) {
+  BUF_LINE_INDEX *idx;
+  MEM_BUF *buf_cb;
+  uint32_t offs, rdi, cnt;
+
+  idx = p->lidx;
+
+  if ((int32_t)(idx->scan - rd) < 0) {
+    /* Scan position already consumed */
+    idx->scan = rd;
+    idx->cr   = 0U;
+  }
+
+  offs   = idx->scan - rd;
+  buf_cb = (MEM_BUF *)ListPeekHead(&p->list);
+
+  while (buf_cb != NULL) {
+    rdi = buf_cb->rdi;
+    cnt = buf_cb->wri - rdi;
+
+    if (offs >= cnt) {
+      /* Block already scanned */
+      offs -= cnt;
+    }
+    else {
+      rdi += offs;
+      cnt -= offs;
+      offs = 0U;
+
+      if (ScanRun (idx, &buf_cb->data[rdi], cnt) != 0) {
+        /* Index full */
+        break;
+      }
+    }
+
+    buf_cb = (MEM_BUF *)ListPeekNext ((Link_t *)buf_cb);
+  }
+}
+
+
+/*
+  Find the first CRLF sequence in the list buffer and return its offset from current position.
+*/
+int32_t BufFindLineUnlocked (BUF_LIST *p) {
+  BUF_LINE_INDEX *idx;
+  uint32_t rd;
+  int32_t  n;
+
+  if (p->lidx == NULL) {
+    /* No index, search buffered data */
+    n = BufFindUnlocked ((const uint8_t *)"\r\n", 2U, p);
+  }
+  else {
+    idx = p->lidx;
+
+    /* Absolute position of the first unread byte */
+    rd = idx->wpos - p->count;
+
+    /* Drop terminators already read, consumed or flushed */
+    while ((idx->num != 0U) && ((int32_t)(idx->pos[idx->head] - rd) < 0)) {
+      idx->head = (uint8_t)((idx->head + 1U) % BUF_LINE_INDEX_SIZE);
+      idx->num--;
+    }
+
+    if ((idx->num == 0U) && (idx->scan != idx->wpos)) {
+      /* Index was full or attached to non-empty buffer, catch up */
+      LineRescan (p, rd);
+    }
+
+    if (idx->num != 0U) {
+      n = (int32_t)(idx->pos[idx->head] - rd);
+    } else {
+      n = -1;
+    }
+  }
+
+  return (n);
+}
+
+int32_t BufFindLine (BUF_LIST *p) {
+  int32_t rval;
+
+  Lock(p);
+  rval = BufFindLineUnlocked (p);
+  Unlock(p);
+
+  return (rval);
 }
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include "LinkList.h"
+#include "BufAllocator.h"
 
 typedef struct {
   uint16_t wr_idx; /* Buffer write index */
@@ -34,19 +35,97 @@ typedef struct {
   uint8_t  data[]; /* Buffer data array  */
 } BUF_MEM;
 
+/* Number of line terminator positions kept by the line index */
+#ifndef BUF_LINE_INDEX_SIZE
+#define BUF_LINE_INDEX_SIZE   8
+#endif
+
+/*
+  Line index
+
+  Keeps positions of CRLF terminators found while data is written into
+  the list buffer. Positions are absolute stream offsets (wrapping).
+*/
+typedef struct {
+  uint32_t wpos;                      /* Number of bytes written           */
+  uint32_t scan;                      /* Position scanned for terminators  */
+  uint32_t pos[BUF_LINE_INDEX_SIZE];  /* Positions of CR of CRLF sequences */
+  uint8_t  head;                      /* Oldest position in pos array      */
+  uint8_t  num;                       /* Number of positions in pos array  */
+  uint8_t  cr;                        /* Last scanned byte was CR          */
+  uint8_t  rsvd;                      /* Reserved                          */
+} BUF_LINE_INDEX;
+
 typedef struct {
-  List_t   list;   /* Linked list            */
-  void    *mutex;  /* Buffer access mutex    */
-  void    *mp_id;  /* Memory pool id         */
-  uint16_t bl_sz;  /* Memory pool block size */
-  uint16_t rsvd;   /* Reserved               */
+  List_t               list;   /* Linked list                  */
+  const BUF_ALLOCATOR *alloc;  /* Block allocator              */
+  void                *mutex;  /* Buffer access mutex          */
+  void                *mp_id;  /* Memory pool id               */
+  void                *mp_lg;  /* Large block memory pool id   */
+  BUF_LINE_INDEX      *lidx;   /* Line index (optional)        */
+  uint16_t             bl_sz;  /* Memory pool block size       */
+  uint16_t             bl_lg;  /* Large block memory pool size */
+  uint16_t             nbl;    /* Number of blocks             */
+  uint16_t             rsvd;   /* Reserved                     */
+  uint32_t             count;  /* Number of bytes              */
 } BUF_LIST;
 
+typedef struct {
+  uint8_t *buf;    /* Segment data                 */
+  uint32_t len;    /* Segment length               */
+} BUF_SEG;
+
+/*
+  Key table entry (BufMatchKey)
+
+  Key tables are sorted by key string in strcmp order, key strings are unique.
+*/
+typedef struct {
+  const char *str;  /* Key string                   */
+  uint8_t     code; /* Code returned on match       */
+} BUF_KEY;
+
+/* Key match modes (BufMatchKey) */
+#define BUF_KEY_TOKEN    0U  /* Key is followed by delimiter ':', ',', ' ' or '\r' */
+#define BUF_KEY_PREFIX   1U  /* Longest key the data starts with                   */
+
+#if (BUF_LIST_RTOS != 0)
 /**
   Initialize buffer list.
 */
 extern int32_t BufInit (void *mp_id, void *mutex, BUF_LIST *p);
 
+/**
+  Initialize buffer list with two block size classes.
+
+  Blocks are allocated from mp_id unless the expected write size does not
+  fit into one block, in which case a block from mp_lg is used. Either pool
+  is used when the other one is exhausted.
+
+  \param[in]  mp_id   memory pool with small blocks
+  \param[in]  mp_lg   memory pool with large blocks or NULL
+  \param[in]  mutex   buffer access mutex or NULL
+  \param[in]  p       list buffer pointer
+  \return 0 on success, -1 on invalid parameter
+*/
+extern int32_t BufInitEx (void *mp_id, void *mp_lg, void *mutex, BUF_LIST *p);
+#endif
+
+/**
+  Initialize buffer list using the specified block allocator.
+
+  BufInit and BufInitEx use CMSIS-RTOS2 memory pool allocator. Pool handles
+  mp_id and mp_lg are passed to the allocator functions.
+
+  \param[in]  alloc   block allocator
+  \param[in]  mp_id   pool with small blocks
+  \param[in]  mp_lg   pool with large blocks or NULL
+  \param[in]  mutex   buffer access mutex or NULL (must be NULL when BUF_LIST_RTOS is 0)
+  \param[in]  p       list buffer pointer
+  \return 0 on success, -1 on invalid parameter
+*/
+extern int32_t BufInitAlloc (const BUF_ALLOCATOR *alloc, void *mp_id, void *mp_lg, void *mutex, BUF_LIST *p);
+
 /**
   Uninitialize buffer list.
 */
@@ -64,6 +143,9 @@ extern BUF_MEM *BufFree  (BUF_LIST *p);
 
 /**
   Retrieve current write buffer (last buffer added to the list).
+
+  \note Data written directly through BUF_MEM indexes is not accounted in
+        BufGetCount, use BufGetWriteSpan and BufCommit instead.
 */
 extern BUF_MEM *BufGetTail (BUF_LIST *p);
 
@@ -71,6 +153,7 @@ extern BUF_MEM *BufGetTail (BUF_LIST *p);
   Retrieve common buffer size valid for all buffers in the list.
 
   Common buffer size is the memory pool block size reduced for handling header.
+  When large blocks are used, this is the size of a small block.
 */
 extern uint16_t BufGetSize (BUF_LIST *p);
 
@@ -84,9 +167,17 @@ extern uint32_t BufGetFree (BUF_LIST *p);
 
 /**
   Retrieve number of bytes in the buffer.
+
+  Byte count is maintained by write, read, copy and flush operations,
+  this function does not walk the list and does not lock the buffer.
 */
 extern uint32_t BufGetCount (BUF_LIST *p);
 
+/**
+  Retrieve number of memory blocks allocated by the list buffer.
+*/
+extern uint32_t BufGetBlockCount (BUF_LIST *p);
+
 /**
   Read a byte from the list buffer.
 
@@ -138,6 +229,11 @@ extern int32_t BufWrite (uint8_t *buf, uint32_t num, BUF_LIST *p);
 
 /**
   Copy num of bytes from the source list buffer into the destination list buffer.
+
+  When both list buffers use the same memory pools and allocator, full
+  source blocks that are entirely within the copied range are moved to the
+  destination list instead of being copied. Only partial edge blocks are
+  copied byte wise.
   
   \return number of bytes copied
 */
@@ -158,6 +254,19 @@ extern uint32_t BufFlush (uint32_t num, BUF_LIST *p);
 */
 extern int32_t BufFindByte (uint8_t data, BUF_LIST *p);
 
+/**
+  Find the first occurence of a data byte within num bytes starting at offset offs.
+
+  This function does not move list buffer read pointer.
+
+  \param[in]  data    data byte
+  \param[in]  offs    offset from current position where the search starts
+  \param[in]  num     number of bytes to search
+  \param[in]  p       list buffer pointer
+  \return offset of data byte from current position or -1 if not found
+*/
+extern int32_t BufFindByteRange (uint8_t data, uint32_t offs, uint32_t num, BUF_LIST *p);
+
 /**
   Find the first occurence of a data sequence in the list buffer and return its offset from current position.
 
@@ -185,4 +294,194 @@ extern int32_t BufFind (const uint8_t *data, uint32_t num, BUF_LIST *p);
 */
 extern int32_t BufCompareString (const char *string, uint32_t offs, BUF_LIST *p);
 
+/**
+  Match the data in the list buffer against a sorted key table.
+
+  Data is read once, the range of candidate keys is narrowed with each byte.
+  This function does not move list buffer read pointer.
+
+  \param[in]  key     key table, sorted by key string
+  \param[in]  num     number of keys
+  \param[in]  offs    offset from current position
+  \param[in]  mode    BUF_KEY_TOKEN or BUF_KEY_PREFIX
+  \param[in]  p       list buffer pointer
+  \return   >=0: code of the matching key
+             -1: no match
+*/
+extern int32_t BufMatchKey (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_LIST *p);
+
+/**
+  Retrieve the next contiguous readable region at the head of the list buffer.
+
+  Data in the region stays valid until it is consumed. Use BufConsume to
+  advance the read pointer once the region (or part of it) is processed.
+
+  \param[out] span    pointer to the first readable byte
+  \param[in]  p       list buffer pointer
+  \return number of contiguous readable bytes, 0 if buffer empty
+*/
+extern uint32_t BufGetReadSpan (uint8_t **span, BUF_LIST *p);
+
+/**
+  Retrieve the contiguous readable region at the specified offset from current position.
+
+  Region ends at the end of the buffer which holds the byte at offset offs.
+  Data is not consumed, use it to continue a scan where the previous one stopped.
+
+  \param[in]  offs    offset from current position
+  \param[out] span    pointer to the byte at offset offs
+  \param[in]  p       list buffer pointer
+  \return number of contiguous readable bytes, 0 if offset is beyond buffered data
+*/
+extern uint32_t BufPeekSpan (uint32_t offs, uint8_t **span, BUF_LIST *p);
+
+/**
+  Consume num of bytes from the region returned by BufGetReadSpan.
+
+  This function increments list buffer read pointer.
+
+  \param[in]  num     number of bytes to consume
+  \param[in]  p       list buffer pointer
+  \return number of bytes consumed
+*/
+extern uint32_t BufConsume (uint32_t num, BUF_LIST *p);
+
+/**
+  Retrieve the next contiguous writable region at the tail of the list buffer.
+
+  New buffer is allocated when the tail buffer is full. Use BufCommit
+  to make the bytes written into the region available for reading.
+
+  \param[out] span    pointer to the first writable byte
+  \param[in]  p       list buffer pointer
+  \return number of contiguous writable bytes, 0 if out of memory
+*/
+extern uint32_t BufGetWriteSpan (uint8_t **span, BUF_LIST *p);
+
+/**
+  Commit num of bytes written into the region returned by BufGetWriteSpan.
+
+  This function increments list buffer write pointer.
+
+  \param[in]  num     number of bytes to commit
+  \param[in]  p       list buffer pointer
+  \return number of bytes committed
+*/
+extern uint32_t BufCommit (uint32_t num, BUF_LIST *p);
+
+/**
+  Reserve a new block at the tail of the list buffer for an external writer.
+
+  The whole block is returned, regardless of free space in the current tail
+  buffer. Reserved blocks are filled in the order they were reserved and
+  must be the only writers of the list buffer. Use BufCommitReserved to make
+  the bytes written into the oldest partially filled block available for
+  reading. Reserved block is not freed by read operations before it is full.
+
+  \param[out] span    pointer to the first byte of the reserved block
+  \param[in]  p       list buffer pointer
+  \return number of bytes in the reserved block, 0 if out of memory
+*/
+extern uint32_t BufReserve (uint8_t **span, BUF_LIST *p);
+
+/**
+  Commit num of bytes written into reserved blocks returned by BufReserve.
+
+  Bytes are committed into the first block that is not full, continuing
+  with the following reserved blocks.
+
+  \param[in]  num     number of bytes to commit
+  \param[in]  p       list buffer pointer
+  \return number of bytes committed
+*/
+extern uint32_t BufCommitReserved (uint32_t num, BUF_LIST *p);
+
+/**
+  Export a range of buffered data as an array of contiguous segments.
+
+  Segments point into the list buffer blocks and stay valid until the data
+  is read, consumed or flushed. This function does not move list buffer
+  read pointer.
+
+  \param[out] seg     array of segments
+  \param[in]  max     maximum number of segments in seg array
+  \param[in]  offs    offset from current position
+  \param[in]  num     number of bytes to export
+  \param[in]  p       list buffer pointer
+  \return number of segments stored into seg array
+*/
+extern uint32_t BufGetSegments (BUF_SEG *seg, uint32_t max, uint32_t offs, uint32_t num, BUF_LIST *p);
+
+/**
+  Attach line index to the list buffer.
+
+  Terminators of data already in the list buffer are indexed on the first
+  BufFindLine call, data written afterwards is indexed as it is written.
+
+  \param[in]  idx     line index, NULL to detach
+  \param[in]  p       list buffer pointer
+  \return 0 on success, -1 on invalid list buffer
+*/
+extern int32_t BufLineIndex (BUF_LINE_INDEX *idx, BUF_LIST *p);
+
+/**
+  Find the first CRLF sequence in the list buffer and return its offset from current position.
+
+  Equivalent to BufFind of "\r\n". With line index attached the offset is
+  taken from the index and each buffered byte is scanned only once.
+
+  \param[in]  p       list buffer pointer
+  \return offset of CR or -1 if the list buffer contains no CRLF
+*/
+extern int32_t BufFindLine (BUF_LIST *p);
+
+/**
+  Begin list buffer transaction.
+
+  Locks the list buffer until BufEnd is called. Within the transaction the
+  BufXxxUnlocked variants are used, each performing the same operation as
+  BufXxx without taking the lock. BufCopyUnlocked requires transactions
+  on both list buffers.
+
+  \param[in]  p       list buffer pointer
+*/
+extern void BufBegin (BUF_LIST *p);
+
+/**
+  End list buffer transaction.
+
+  \param[in]  p       list buffer pointer
+*/
+extern void BufEnd (BUF_LIST *p);
+
+/* Unlocked variants, to be called between BufBegin and BufEnd */
+extern BUF_MEM *BufAllocUnlocked          (BUF_LIST *p);
+extern BUF_MEM *BufFreeUnlocked           (BUF_LIST *p);
+extern BUF_MEM *BufGetTailUnlocked        (BUF_LIST *p);
+extern uint16_t BufGetSizeUnlocked        (BUF_LIST *p);
+extern uint32_t BufGetFreeUnlocked        (BUF_LIST *p);
+extern int32_t  BufReadByteUnlocked       (BUF_LIST *p);
+extern int32_t  BufPeekByteUnlocked       (BUF_LIST *p);
+extern int32_t  BufPeekOffsUnlocked       (uint32_t offs, BUF_LIST *p);
+extern int32_t  BufFlushByteUnlocked      (BUF_LIST *p);
+extern int32_t  BufWriteByteUnlocked      (uint8_t data, BUF_LIST *p);
+extern int32_t  BufReadUnlocked           (uint8_t *buf, uint32_t num, BUF_LIST *p);
+extern int32_t  BufWriteUnlocked          (uint8_t *buf, uint32_t num, BUF_LIST *p);
+extern uint32_t BufCopyUnlocked           (BUF_LIST *dst, BUF_LIST *src, uint32_t num);
+extern uint32_t BufFlushUnlocked          (uint32_t num, BUF_LIST *p);
+extern int32_t  BufFindByteUnlocked       (uint8_t data, BUF_LIST *p);
+extern int32_t  BufFindByteRangeUnlocked  (uint8_t data, uint32_t offs, uint32_t num, BUF_LIST *p);
+extern int32_t  BufFindUnlocked           (const uint8_t *data, uint32_t num, BUF_LIST *p);
+extern int32_t  BufCompareStringUnlocked  (const char *string, uint32_t offs, BUF_LIST *p);
+extern int32_t  BufMatchKeyUnlocked       (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_LIST *p);
+extern uint32_t BufGetReadSpanUnlocked    (uint8_t **span, BUF_LIST *p);
+extern uint32_t BufPeekSpanUnlocked       (uint32_t offs, uint8_t **span, BUF_LIST *p);
+extern uint32_t BufConsumeUnlocked        (uint32_t num, BUF_LIST *p);
+extern uint32_t BufGetWriteSpanUnlocked   (uint8_t **span, BUF_LIST *p);
+extern uint32_t BufCommitUnlocked         (uint32_t num, BUF_LIST *p);
+extern uint32_t BufReserveUnlocked        (uint8_t **span, BUF_LIST *p);
+extern uint32_t BufCommitReservedUnlocked (uint32_t num, BUF_LIST *p);
+extern uint32_t BufGetSegmentsUnlocked    (BUF_SEG *seg, uint32_t max, uint32_t offs, uint32_t num, BUF_LIST *p);
+extern int32_t  BufFindLineUnlocked       (BUF_LIST *p);
+
 #endif /* BUFLIST_H__ */
@@ -0,0 +1,589 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ * $Revision:    V1.0
+ *
+ * Project:      Lock-free single producer/single consumer ring buffer
+ * -------------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "BufRing.h"
+#include "RTE_Components.h"
+#include CMSIS_device_header
+
+/*
+  Producer: RingGetWriteSpan, RingCommit, RingWrite
+  Consumer: all other functions
+
+  Producer publishes data by updating the write index after the data is
+  stored, consumer releases space by updating the read index after the
+  data is processed. Data memory barrier orders the two on multi-master
+  systems (DMA, dual core).
+*/
+
+/* Return masked storage index */
+#define RING_IDX(r, i)    ((i) & ((r)->sz - 1U))
+
+/* Number of bytes in the ring buffer */
+static uint32_t Count (BUF_RING *r) {
+  uint32_t n;
+
+  n = r->wri;
+  __DMB();
+
+  return (n - r->rdi);
+}
+
+/* Return byte at specified offset from the read index */
+static uint8_t Peek (uint32_t offs, BUF_RING *r) {
+  return (r->data[RING_IDX(r, r->rdi + offs)]);
+}
+
+/* Compare num of bytes at offset, return nonzero when equal (data must be buffered) */
+static uint32_t Match (const uint8_t *data, uint32_t num, uint32_t offs, BUF_RING *r) {
+  uint32_t k, n;
+
+  k = RING_IDX(r, r->rdi + offs);
+  n = r->sz - k;
+
+  if (n >= num) {
+    return (memcmp (&r->data[k], data, num) == 0);
+  }
+
+  /* Sequence wraps around the end of storage */
+  return ((memcmp (&r->data[k], data, n) == 0) && (memcmp (r->data, &data[n], num - n) == 0));
+}
+
+/* Advance read index */
+static void Advance (uint32_t num, BUF_RING *r) {
+  __DMB();
+  r->rdi += num;
+}
+
+/**
+  Initialize ring buffer.
+*/
+int32_t RingInit (uint8_t *mem, uint32_t sz, BUF_RING *r) {
+  int32_t rval;
+
+  if ((r == NULL) || (mem == NULL) || (sz == 0U) || ((sz & (sz - 1U)) != 0U)) {
+    /* Ring buffer or storage invalid */
+    rval = -1;
+  }
+  else {
+    r->data = mem;
+    r->sz   = sz;
+    r->wri  = 0U;
+    r->rdi  = 0U;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+/**
+  Uninitialize ring buffer.
+*/
+int32_t RingUninit (BUF_RING *r) {
+  int32_t rval;
+
+  if (r == NULL) {
+    rval = -1;
+  }
+  else {
+    r->rdi = r->wri;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+uint32_t RingGetCount (BUF_RING *r) {
+  return (Count (r));
+}
+
+uint32_t RingGetFree (BUF_RING *r) {
+  return (r->sz - (r->wri - r->rdi));
+}
+
+/*
+  Retrieve the next contiguous writable region, limited by the end of storage.
+*/
+uint32_t RingGetWriteSpan (uint8_t **span, BUF_RING *r) {
+  uint32_t wri, n, k;
+
+  wri = r->wri;
+  n   = r->sz - (wri - r->rdi);
+
+  if (n != 0U) {
+    k = RING_IDX(r, wri);
+
+    if (n > (r->sz - k)) {
+      /* Region wraps, return part up to the end of storage */
+      n = r->sz - k;
+    }
+
+    *span = &r->data[k];
+  }
+
+  return (n);
+}
+
+uint32_t RingCommit (uint32_t num, BUF_RING *r) {
+  uint32_t n;
+
+  n = r->sz - (r->wri - r->rdi);
+
+  if (num > n) {
+    num = n;
+  }
+
+  /* Publish data before the index */
+  __DMB();
+  r->wri += num;
+
+  return (num);
+}
+
+int32_t RingWrite (const uint8_t *buf, uint32_t num, BUF_RING *r) {
+  uint8_t *span;
+  uint32_t n, cnt;
+
+  n = 0U;
+
+  while (n < num) {
+    cnt = RingGetWriteSpan (&span, r);
+
+    if (cnt == 0U) {
+      /* Buffer full */
+      break;
+    }
+
+    if (cnt > (num - n)) {
+      cnt = num - n;
+    }
+
+    memcpy (span, &buf[n], cnt);
+
+    n += RingCommit (cnt, r);
+  }
+
+  return ((int32_t)n);
+}
+
+/*
+  Retrieve the next contiguous readable region, limited by the end of storage.
+*/
+uint32_t RingGetReadSpan (uint8_t **span, BUF_RING *r) {
+  uint32_t n, k;
+
+  n = Count (r);
+
+  if (n != 0U) {
+    k = RING_IDX(r, r->rdi);
+
+    if (n > (r->sz - k)) {
+      /* Region wraps, return part up to the end of storage */
+      n = r->sz - k;
+    }
+
+    *span = &r->data[k];
+  }
+
+  return (n);
+}
+
+/*
+  Retrieve the contiguous readable region at offset offs, limited by the end of storage.
+*/
+uint32_t RingPeekSpan (uint32_t offs, uint8_t **span, BUF_RING *r) {
+  uint32_t n, k;
+
+  n = Count (r);
+
+  if (offs < n) {
+    n -= offs;
+    k  = RING_IDX(r, r->rdi + offs);
+
+    if (n > (r->sz - k)) {
+      /* Region wraps, return part up to the end of storage */
+      n = r->sz - k;
+    }
+
+    *span = &r->data[k];
+  }
+  else {
+    n = 0U;
+  }
+
+  return (n);
+}
+
+uint32_t RingConsume (uint32_t num, BUF_RING *r) {
+  uint32_t n;
+
+  n = Count (r);
+
+  if (num > n) {
+    num = n;
+  }
+
+  Advance (num, r);
+
+  return (num);
+}
+
+int32_t RingReadByte (BUF_RING *r) {
+  int32_t rval;
+
+  if (Count (r) == 0U) {
+    /* End of buffer */
+    rval = -1;
+  }
+  else {
+    rval = Peek (0U, r);
+
+    Advance (1U, r);
+  }
+
+  return (rval);
+}
+
+int32_t RingPeekByte (BUF_RING *r) {
+  int32_t rval;
+
+  if (Count (r) == 0U) {
+    /* No data */
+    rval = -1;
+  }
+  else {
+    rval = Peek (0U, r);
+  }
+
+  return (rval);
+}
+
+int32_t RingPeekOffs (uint32_t offs, BUF_RING *r) {
+  int32_t rval;
+
+  if (offs >= Count (r)) {
+    /* End of buffer */
+    rval = -1;
+  }
+  else {
+    rval = Peek (offs, r);
+  }
+
+  return (rval);
+}
+
+int32_t RingFlushByte (BUF_RING *r) {
+  return (RingReadByte (r));
+}
+
+/*
+  Read num of bytes into buf and return number of bytes actually read.
+*/
+int32_t RingRead (uint8_t *buf, uint32_t num, BUF_RING *r) {
+  uint8_t *span;
+  uint32_t n, cnt;
+
+  n = 0U;
+
+  while (n < num) {
+    cnt = RingGetReadSpan (&span, r);
+
+    if (cnt == 0U) {
+      /* Buffer empty */
+      break;
+    }
+
+    if (cnt > (num - n)) {
+      cnt = num - n;
+    }
+
+    memcpy (&buf[n], span, cnt);
+
+    n += RingConsume (cnt, r);
+  }
+
+  return ((int32_t)n);
+}
+
+/*
+  Copy num of bytes from src to dst and return number of bytes actually copied.
+*/
+uint32_t RingCopy (BUF_LIST *dst, BUF_RING *src, uint32_t num) {
+  uint8_t *span;
+  uint32_t n, cnt;
+
+  n = 0U;
+
+  while (n < num) {
+    cnt = RingGetReadSpan (&span, src);
+
+    if (cnt == 0U) {
+      /* End of source buffer */
+      break;
+    }
+
+    if (cnt > (num - n)) {
+      cnt = num - n;
+    }
+
+    /* Write contiguous run into the destination list */
+    cnt = (uint32_t)BufWrite (span, cnt, dst);
+
+    if (cnt == 0U) {
+      /* Destination out of memory */
+      break;
+    }
+
+    n += RingConsume (cnt, src);
+  }
+
+  return (n);
+}
+
+/*
+  Flush num of bytes from the ring buffer. Ring buffer is flushed completely when num equals to zero.
+*/
+uint32_t RingFlush (uint32_t num, BUF_RING *r) {
+  uint32_t n;
+
+  n = Count (r);
+
+  if ((num != 0U) && (num < n)) {
+    n = num;
+  }
+
+  Advance (n, r);
+
+  return (n);
+}
+
+/*
+  Find the first occurence of a data byte and return its offset from current position.
+*/
+int32_t RingFindByte (uint8_t data, BUF_RING *r) {
+  uint32_t cnt, k, n, offs;
+  uint8_t *p;
+  int32_t  rval;
+
+  rval = -1;
+  cnt  = Count (r);
+  offs = 0U;
+
+  while (offs < cnt) {
+    /* Search contiguous region up to the end of storage */
+    k = RING_IDX(r, r->rdi + offs);
+    n = r->sz - k;
+
+    if (n > (cnt - offs)) {
+      n = cnt - offs;
+    }
+
+    p = memchr (&r->data[k], data, n);
+
+    if (p != NULL) {
+      /* Equal data byte found */
+      rval = (int32_t)(offs + (uint32_t)(p - &r->data[k]));
+      break;
+    }
+
+    offs += n;
+  }
+
+  return (rval);
+}
+
+/*
+  Find the first occurence of a data byte within num bytes starting at offset offs.
+*/
+int32_t RingFindByteRange (uint8_t data, uint32_t offs, uint32_t num, BUF_RING *r) {
+  uint32_t cnt, k, n;
+  uint8_t *p;
+  int32_t  rval;
+
+  rval = -1;
+  cnt  = Count (r);
+
+  if ((offs < cnt) && (num < (cnt - offs))) {
+    /* Search ends before the last buffered byte */
+    cnt = offs + num;
+  }
+
+  while (offs < cnt) {
+    /* Search contiguous region up to the end of storage */
+    k = RING_IDX(r, r->rdi + offs);
+    n = r->sz - k;
+
+    if (n > (cnt - offs)) {
+      n = cnt - offs;
+    }
+
+    p = memchr (&r->data[k], data, n);
+
+    if (p != NULL) {
+      /* Equal data byte found */
+      rval = (int32_t)(offs + (uint32_t)(p - &r->data[k]));
+      break;
+    }
+
+    offs += n;
+  }
+
+  return (rval);
+}
+
+/*
+  Find the first occurence of a data sequence and return its offset from current position.
+*/
+int32_t RingFind (const uint8_t *data, uint32_t num, BUF_RING *r) {
+  uint32_t cnt, last, k, n, offs;
+  uint8_t *p;
+  int32_t  rval;
+
+  rval = -1;
+  cnt  = Count (r);
+  offs = 0U;
+
+  if ((num != 0U) && (num <= cnt)) {
+    /* Last offset at which the sequence fits */
+    last = cnt - num;
+
+    while (offs <= last) {
+      /* Search first byte in contiguous region up to the end of storage */
+      k = RING_IDX(r, r->rdi + offs);
+      n = r->sz - k;
+
+      if (n > (last - offs + 1U)) {
+        n = last - offs + 1U;
+      }
+
+      p = memchr (&r->data[k], data[0], n);
+
+      if (p == NULL) {
+        offs += n;
+      }
+      else {
+        offs += (uint32_t)(p - &r->data[k]);
+
+        if (Match (data, num, offs, r) != 0U) {
+          /* Compared sequence matches */
+          rval = (int32_t)offs;
+          break;
+        }
+        offs++;
+      }
+    }
+  }
+
+  return (rval);
+}
+
+/*
+  Compare string with buffered data
+
+  \note Does not move buffer pointers
+*/
+int32_t RingCompareString (const char *string, uint32_t offs, BUF_RING *r) {
+  uint32_t cnt;
+  int32_t  n;
+
+  n   = 0;
+  cnt = Count (r);
+
+  while (string[n] != '\0') {
+    if ((offs + (uint32_t)n) >= cnt) {
+      /* End of buffer */
+      n = -1;
+      break;
+    }
+
+    if ((uint8_t)string[n] != Peek (offs + (uint32_t)n, r)) {
+      /* No match */
+      n = 0;
+      break;
+    }
+
+    n++;
+  }
+
+  return (n);
+}
+
+
+/*
+  Match buffered data against a sorted key table, data is read once
+
+  \note Does not move buffer pointers
+*/
+int32_t RingMatchKey (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_RING *r) {
+  uint32_t cnt, lo, hi, i;
+  int32_t  code, end;
+  uint8_t  c;
+
+  code = -1;
+  lo   = 0U;
+  hi   = num;
+  cnt  = Count (r);
+
+  for (i = 0U; lo < hi; i++) {
+    end = -1;
+
+    if (key[lo].str[i] == '\0') {
+      /* Shortest key in range ends here */
+      end = key[lo].code;
+      lo++;
+
+      if (mode == BUF_KEY_PREFIX) {
+        code = end;
+      }
+    }
+
+    if ((offs + i) >= cnt) {
+      /* End of buffer */
+      break;
+    }
+
+    c = Peek (offs + i, r);
+
+    if ((end >= 0) && (mode == BUF_KEY_TOKEN)) {
+      if ((c == ':') || (c == ',') || (c == ' ') || (c == '\r')) {
+        /* Token ends with the key */
+        code = end;
+        break;
+      }
+    }
+
+    /* Narrow range to keys with byte c at position i, keys are sorted */
+    while ((lo < hi) && ((uint8_t)key[lo].str[i] < c)) {
+      lo++;
+    }
+    while ((lo < hi) && ((uint8_t)key[hi - 1U].str[i] > c)) {
+      hi--;
+    }
+  }
+
+  return (code);
+}
@@ -0,0 +1,226 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ * $Revision:    V1.0
+ *
+ * Project:      Lock-free single producer/single consumer ring buffer
+ * -------------------------------------------------------------------------- */
+
+#ifndef BUFRING_H__
+#define BUFRING_H__
+
+#include <stdint.h>
+#include "BufList.h"
+
+/*
+  Ring buffer with one producer and one consumer.
+
+  Producer owns the write index and may run in interrupt context,
+  consumer owns the read index. No mutex and no memory allocation
+  is used, the indexes are free running and masked on access.
+*/
+typedef struct {
+  uint8_t          *data;  /* Ring buffer storage               */
+  uint32_t          sz;    /* Storage size (power of two)       */
+  volatile uint32_t wri;   /* Write index (modified by producer) */
+  volatile uint32_t rdi;   /* Read index  (modified by consumer) */
+} BUF_RING;
+
+/**
+  Initialize ring buffer.
+
+  \param[in]  mem     ring buffer storage
+  \param[in]  sz      storage size in bytes, must be a power of two
+  \param[in]  r       ring buffer pointer
+  \return 0 on success, -1 on invalid parameter
+*/
+extern int32_t RingInit (uint8_t *mem, uint32_t sz, BUF_RING *r);
+
+/**
+  Uninitialize ring buffer.
+*/
+extern int32_t RingUninit (BUF_RING *r);
+
+/**
+  Retrieve number of bytes in the ring buffer.
+*/
+extern uint32_t RingGetCount (BUF_RING *r);
+
+/**
+  Retrieve amount of free space in the ring buffer.
+*/
+extern uint32_t RingGetFree (BUF_RING *r);
+
+/**
+  Retrieve the next contiguous writable region of the ring buffer (producer).
+
+  \param[out] span    pointer to the first writable byte
+  \param[in]  r       ring buffer pointer
+  \return number of contiguous writable bytes, 0 if buffer full
+*/
+extern uint32_t RingGetWriteSpan (uint8_t **span, BUF_RING *r);
+
+/**
+  Commit num of bytes written into the region returned by RingGetWriteSpan (producer).
+
+  \return number of bytes committed
+*/
+extern uint32_t RingCommit (uint32_t num, BUF_RING *r);
+
+/**
+  Write num of bytes from buf into the ring buffer (producer).
+
+  \return number of bytes written
+*/
+extern int32_t RingWrite (const uint8_t *buf, uint32_t num, BUF_RING *r);
+
+/**
+  Retrieve the next contiguous readable region of the ring buffer (consumer).
+
+  \param[out] span    pointer to the first readable byte
+  \param[in]  r       ring buffer pointer
+  \return number of contiguous readable bytes, 0 if buffer empty
+*/
+extern uint32_t RingGetReadSpan (uint8_t **span, BUF_RING *r);
+
+/**
+  Retrieve the contiguous readable region at the specified offset from current position (consumer).
+
+  \param[in]  offs    offset from current position
+  \param[out] span    pointer to the byte at offset offs
+  \param[in]  r       ring buffer pointer
+  \return number of contiguous readable bytes, 0 if offset is beyond buffered data
+*/
+extern uint32_t RingPeekSpan (uint32_t offs, uint8_t **span, BUF_RING *r);
+
+/**
+  Consume num of bytes from the region returned by RingGetReadSpan (consumer).
+
+  \return number of bytes consumed
+*/
+extern uint32_t RingConsume (uint32_t num, BUF_RING *r);
+
+/**
+  Read a byte from the ring buffer.
+
+  \return byte read or -1 if buffer empty
+*/
+extern int32_t RingReadByte (BUF_RING *r);
+
+/**
+  Peek a byte from the ring buffer.
+
+  \return byte read or -1 if buffer empty
+*/
+extern int32_t RingPeekByte (BUF_RING *r);
+
+/**
+  Peek a byte with the specified offset from current position.
+
+  \return byte value or -1 if buffer empty
+*/
+extern int32_t RingPeekOffs (uint32_t offs, BUF_RING *r);
+
+/**
+  Flush a byte from the ring buffer.
+
+  \return byte flushed or -1 if buffer empty
+*/
+extern int32_t RingFlushByte (BUF_RING *r);
+
+/**
+  Read num of bytes into buf from the ring buffer.
+
+  \return number of bytes read
+*/
+extern int32_t RingRead (uint8_t *buf, uint32_t num, BUF_RING *r);
+
+/**
+  Copy num of bytes from the ring buffer into the destination list buffer.
+
+  \return number of bytes copied
+*/
+extern uint32_t RingCopy (BUF_LIST *dst, BUF_RING *src, uint32_t num);
+
+/**
+  Flush num of bytes from the ring buffer. Ring buffer is flushed completely when num equals to zero.
+
+  \return number of bytes flushed
+*/
+extern uint32_t RingFlush (uint32_t num, BUF_RING *r);
+
+/**
+  Find the first occurence of a data byte in the ring buffer and return its offset from current position.
+
+  This function does not move ring buffer read pointer.
+  \return offset of data byte or -1 if not found
+*/
+extern int32_t RingFindByte (uint8_t data, BUF_RING *r);
+
+/**
+  Find the first occurence of a data byte within num bytes starting at offset offs.
+
+  This function does not move ring buffer read pointer.
+  \return offset of data byte from current position or -1 if not found
+*/
+extern int32_t RingFindByteRange (uint8_t data, uint32_t offs, uint32_t num, BUF_RING *r);
+
+/**
+  Find the first occurence of a data sequence in the ring buffer and return its offset from current position.
+
+  This function does not move ring buffer read pointer.
+
+  \param[in]  data    data sequence
+  \param[in]  num     number of bytes from data to compare
+  \param[in]  r       ring buffer pointer
+  \return   >=0: offset from the start of data
+             -1: no match
+*/
+extern int32_t RingFind (const uint8_t *data, uint32_t num, BUF_RING *r);
+
+/**
+  Compare string with the data in the ring buffer.
+
+  This function does not move ring buffer read pointer.
+
+  \param[in]  string  string to compare
+  \param[in]  offs    offset from current position
+  \param[in]  r       ring buffer pointer
+  \return   >0: match, string length not including null terminator
+             0: no match
+            -1: no match, end of buffer
+*/
+extern int32_t RingCompareString (const char *string, uint32_t offs, BUF_RING *r);
+
+/**
+  Match the data in the ring buffer against a sorted key table (see BufMatchKey).
+
+  This function does not move ring buffer read pointer.
+
+  \param[in]  key     key table, sorted by key string
+  \param[in]  num     number of keys
+  \param[in]  offs    offset from current position
+  \param[in]  mode    BUF_KEY_TOKEN or BUF_KEY_PREFIX
+  \param[in]  r       ring buffer pointer
+  \return   >=0: code of the matching key
+             -1: no match
+*/
+extern int32_t RingMatchKey (const BUF_KEY *key, uint32_t num, uint32_t offs, uint32_t mode, BUF_RING *r);
+
+#endif /* BUFRING_H__ */
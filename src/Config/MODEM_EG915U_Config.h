@@ -45,6 +45,39 @@
 // <i> Default: 115200
 #define MOD_EG915U_SERIAL_BAUDRATE        38400
 
+// <e> Serial baud rate negotiation
+// <i> Steps the serial interface up to the maximum baud rate once communication is established.
+// <i> Each rate is verified with a link check, the driver backs off to the last good rate on errors.
+// <i> RTS/CTS flow control is enabled (AT+IFC) when supported by the serial driver.
+// <i> Last good rate is passed to Modem_BaudrateStore and tried first at next power up.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_SERIAL_BAUD_NEGOTIATE  0
+
+//   <o> Maximum baud rate <115200=>115200
+//                         <230400=>230400
+//                         <460800=>460800
+//                         <921600=>921600
+//                         <1000000=>1000000
+//                         <3000000=>3000000
+//   <i> Defines the highest baud rate tried during negotiation.
+//   <i> Default: 921600
+#define MOD_EG915U_SERIAL_BAUDRATE_MAX    921600
+// </e>
+
+// <o> Serial receive idle time [characters] <1-32>
+// <i> Defines the number of character times without received data which signals receive idle.
+// <i> Used only when the serial driver does not provide receive timeout event.
+// <i> Default: 3
+#define MOD_EG915U_SERIAL_IDLE_CHARS      3
+
+// <o> Serial receive idle maximum poll interval [ms] <20-1000>
+// <i> Defines the longest receive poll interval while the serial line is idle.
+// <i> Poll interval is shortened to the idle time on received or transmitted data.
+// <i> Longer interval reduces wake-ups on an idle line but delays detection of unsolicited data.
+// <i> Used only when the serial driver does not provide receive timeout event.
+// <i> Default: 100
+#define MOD_EG915U_SERIAL_IDLE_POLL_MAX   100
+
 // <o> Modem thread priority <0=>osPriorityLow
 //                          <1=>osPriorityBelowNormal
 //                          <2=>osPriorityNormal
@@ -61,6 +94,24 @@
 // <i> Default: 512
 #define MOD_EG915U_THREAD_STACK_SIZE      1024
 
+// <o> Command pipeline depth <1-8>
+// <i> Defines the number of batched commands sent before their responses arrive.
+// <i> 1 disables command batches, configuration commands are sent one at a time.
+// <i> Enable only when the modem accepts a command before the previous one completes.
+// <i> Default: 1
+#define MOD_EG915U_CMD_PIPELINE_DEPTH     1
+
+// <o> Command batch size <8-32>
+// <i> Defines the maximum number of commands in one batch (pipeline depth above 1).
+// <i> HTTPS setup queues 7 commands.
+// <i> Default: 8
+#define MOD_EG915U_CMD_BATCH_SIZE         8
+
+// <o> Command batch buffer size [bytes] <128-4096>
+// <i> Defines the storage for command strings of one batch (pipeline depth above 1).
+// <i> Default: 512
+#define MOD_EG915U_CMD_BATCH_BUF_SIZE     512
+
 // <o> Socket buffer block size <128-16384:128>
 // <i> Defines the size of one memory block used for socket data buffering.
 // <i> Socket buffering consists of multiple blocks which are distributed across multiple sockets.
@@ -73,6 +124,18 @@
 // <i> Default: 8
 #define MOD_EG915U_SOCKET_BLOCK_COUNT     8
 
+// <o> Socket buffer large block size <128-16384:128>
+// <i> Defines the size of one large memory block used for bulk socket data buffering.
+// <i> Large blocks are used when received data does not fit into one socket buffer block.
+// <i> Default: 1664
+#define MOD_EG915U_SOCKET_LARGE_BLOCK_SIZE   1664
+
+// <o> Socket buffer large block count <0-64>
+// <i> Defines the total number of large memory blocks used for socket data buffering.
+// <i> Large blocks are not used when set to 0.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_SOCKET_LARGE_BLOCK_COUNT  0
+
 // <o> Serial parser buffer block size
 // <i> Defines the size of one memory block in serial parser buffer.
 // <i> The total size of serial parser buffer is defined by memory block size and number of blocks.
@@ -85,6 +148,56 @@
 // <i> Default: 8
 #define MOD_EG915U_PARSER_BLOCK_COUNT     8
 
+// <o> Serial parser buffer large block size <128-16384:128>
+// <i> Defines the size of one large memory block in serial parser buffer.
+// <i> Large blocks receive serial data, small blocks then hold only short response lines.
+// <i> Default: 1664
+#define MOD_EG915U_PARSER_LARGE_BLOCK_SIZE   1664
+
+// <o> Serial parser buffer large block count <0-64>
+// <i> Defines the number of large memory blocks in serial parser buffer.
+// <i> Large blocks are not used when set to 0.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_PARSER_LARGE_BLOCK_COUNT  0
+
+// <o> Serial parser ring buffer size <0=>Disabled
+//                                    <1024=>1024
+//                                    <2048=>2048
+//                                    <4096=>4096
+//                                    <8192=>8192
+// <i> Defines the size of lock-free ring buffer used as serial parser buffer.
+// <i> When enabled, received data is stored into the ring buffer instead of memory pool blocks.
+// <i> Memory pool blocks are then used only for response data buffering.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_PARSER_RING_SIZE       0
+
+// <q> Serial receive into parser buffer blocks
+// <i> Enables serial driver receive directly into serial parser buffer memory blocks.
+// <i> Received data is not copied from the serial receive buffer, which is then not used.
+// <i> Serial parser memory pools must be placed in memory accessible by the USART DMA.
+// <i> Requires serial parser ring buffer to be disabled.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_SERIAL_RX_BLOCK        0
+
+// <q> Serial parser state profiling
+// <i> Counts executions and system timer cycles spent in each serial parser state.
+// <i> Counters are retrieved with AT_Parser_GetProfile.
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_PARSER_PROFILE         0
+
+// <e> Serial trace capture
+// <i> Records received and transmitted serial data with timestamps into a ring buffer.
+// <i> Oldest records are overwritten when the buffer is full.
+// <i> Trace is retrieved with Serial_TraceDump and can be replayed on a host (bench/Serial_Replay.c).
+// <i> Default: 0 (Disabled)
+#define MOD_EG915U_SERIAL_TRACE           0
+
+//   <o> Trace buffer size <1024=>1024 <2048=>2048 <4096=>4096 <8192=>8192 <16384=>16384 <32768=>32768
+//   <i> Defines the size of serial trace ring buffer.
+//   <i> Default: 4096
+#define MOD_EG915U_SERIAL_TRACE_SIZE      4096
+// </e>
+
 // </h>
 
 //------------- <<< end of configuration section >>> -------------------------
@@ -94,6 +94,26 @@ extern "C"
 #define MOD_EVENT_ETH_RX_FRAME        (1UL << 4)   /// reserved
 #define MOD_EVENT_READY                (1UL << 5)
 
+/****** Modem Memory Pool identifiers *****/
+#define MOD_POOL_SOCKET                0U          ///< Socket data pool
+#define MOD_POOL_SOCKET_LARGE          1U          ///< Socket data large block pool
+#define MOD_POOL_PARSER                2U          ///< Serial parser pool
+#define MOD_POOL_PARSER_LARGE          3U          ///< Serial parser large block pool
+#define MOD_POOL_NUM                   4U          ///< Number of memory pools
+
+
+/**
+\brief Modem Memory Pool Statistics
+*/
+typedef struct MOD_POOL_STATS_s {
+  uint32_t block_size;                                  ///< Block size in bytes (0 = pool not in use)
+  uint32_t block_count;                                 ///< Number of blocks
+  uint32_t used;                                        ///< Number of blocks currently in use
+  uint32_t peak;                                        ///< Peak number of blocks in use
+  uint32_t alloc_fail;                                  ///< Number of failed block allocations
+  uint32_t drop_bytes;                                  ///< Number of received data bytes dropped
+  uint32_t high_time;                                   ///< Time spent above 90% utilization [ms]
+} MOD_POOL_STATS;
 
 /**
 \brief Modem Configuration
@@ -258,6 +278,7 @@ typedef struct _MOD_DRIVER {
   int32_t            (*HTTP)               (int32_t socket, MOD_HTTP_t * httpd);
   int32_t            (*release)            (void);
   int32_t            (*SSL_SetOption)      (SSL_Config_t option, uint8_t ssl_context_id, void * data);
+  int32_t            (*GetPoolStats)       (uint32_t pool, MOD_POOL_STATS *stats);
 
 } const MOD_DRIVER;
 
@@ -43,12 +43,32 @@ struct HTTPCTL_TypeDef
 } HTTP_CTL_Parser;
 
 
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+/* Parser state execution profile */
+static AT_PARSER_PROFILE AT_Prof;
+#endif
+
+/* URC subscription */
+typedef struct {
+  const char *name;     /* URC name without '+' */
+  AT_URC_FUNC func;     /* Handler */
+  void       *arg;      /* Handler argument */
+} AT_URC_ENTRY;
+
+/* URC dispatch table */
+static AT_URC_ENTRY AT_Urc[AT_URC_NUM];
+
 /* Pointer to parser control block */
 #define pCb     (&AT_Cb)
 
 /* Pointer to parser buffer memory */
 #define pMem    (&AT_Cb.mem)
 
+/* Maximum number of segments sent with one AT_Send_Buf call */
+#ifndef AT_SEND_SEG_MAX
+#define AT_SEND_SEG_MAX   8
+#endif
+
 /* String list definition */
 typedef const struct  {
   const char *str;
@@ -58,19 +78,29 @@ typedef const struct  {
 /* Static functions */
 static int32_t     ReceiveData (void);
 static uint8_t     AnalyzeLineData (void);
-static uint8_t     GetCommandCode       (BUF_LIST *mem);
-static uint8_t     GetASCIIResponseCode (BUF_LIST *mem);
-static uint8_t     GetGMRResponseCode   (BUF_LIST *mem);
-static uint8_t     GetCtrlResponseCode  (BUF_LIST *mem);
+static void        LineReset (void);
+static uint8_t     GetCommandCode       (AT_PARSER_MEM *mem);
+static uint8_t     GetASCIIResponseCode (AT_PARSER_MEM *mem);
+static uint8_t     GetGMRResponseCode   (AT_PARSER_MEM *mem);
+static uint8_t     GetCtrlResponseCode  (AT_PARSER_MEM *mem);
 static int32_t     GetRespArg (uint8_t *buf, uint32_t sz);
 static int32_t     CmdOpen   (uint8_t cmd_code, uint32_t cmd_mode, char *buf);
 static int32_t     CmdSend   (uint8_t cmd, char *buf, int32_t num);
 static const char *CmdString (uint8_t cmd);
 static int32_t     CmdSetWFE (uint8_t cmd);
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+static int32_t     CmdQueueAdd  (uint8_t cmd, const char *buf, uint32_t num);
+static void        CmdQueueSend (void);
+static uint32_t    CmdQueueResp (uint8_t resp);
+#else
+/* Command batch disabled, every generic response belongs to a single command */
+#define CmdQueueResp(resp)   (0U)
+#endif
+static uint32_t    UrcDispatch  (void);
 static void        AT_Parse_IP  (char *buf, uint8_t ip[]);
 static void        AT_Parse_MAC (char *buf, uint8_t mac[]);
 
-/* Command list (see also CommandCode_t) */
+/* Command strings indexed by command code (see CommandCode_t) */
 static STRING_LIST_t List_PlusResp[] = {
   { "IPD"              },
   { "CWLAP"            },
@@ -117,6 +147,8 @@ static STRING_LIST_t List_PlusResp[] = {
   { "QHTTPGET"         },
   { "QSSLCFG"         },
   { "IPR"         },
+  { "IFC"              },
+  { "CEREG"            },
   { "E"                },
   { ""                 }
 };
@@ -166,46 +198,87 @@ typedef enum {
   CMD_QHTTPGET,
   CMD_QSSLCFG,
   CMD_UART_RATE,
+  CMD_FLOW_CTRL,
+  CMD_CEREG,
   CMD_ECHO        = 0xFD, /* Command Echo                 */
   CMD_TEST        = 0xFE, /* AT startup (empty command)   */
   CMD_UNKNOWN     = 0xFF  /* Unknown or unhandled command */
 } CommandCode_t;
 
 
-/* Generic responses (see AT_RESP_x definitions) */
-static STRING_LIST_t List_ASCIIResp[] = {
-  { "OK"                },    //0
-  { "ERROR"             },    //1
-  { "FAIL"              },    //2
-  { "SEND OK"           },    //3
-  { "SEND FAIL"         },    //4
-  { "busy p..."         },    //5
-  { "busy s..."         },    //6
-  { "CONNECT" },              //7
-/* Generic responses redirected to AT_Notify function */
-  { "MODEM CONNECTED"    },   //8
-  { "MODEM GOT IP"       },   //9
-  { "MODEM DISCONNECT"   },   //10
-/* Ignored */
-#if 0
-  { "no change"         },
-  { "DNS Fail"          },
-  { "UNLINK"            },
+/*
+  Response classifier key tables (AT_MemMatchKey)
+
+  Tables are sorted by key string in strcmp order (uppercase before lowercase).
+  Received line head is read once and matched against all keys in the table.
+*/
+
+/* +CMD responses, token till ':' or ',' must match the key (see CommandCode_t) */
+static const BUF_KEY Key_PlusResp[] = {
+  { "ATI",              CMD_ATI              },
+  { "CEREG",            CMD_CEREG            },
+  { "CIPAP",            CMD_CIPAP_CUR        },
+  { "CIPAPMAC",         CMD_CIPAPMAC_CUR     },
+  { "CIPDNS",           CMD_CIPDNS_CUR       },
+  { "CIPDOMAIN",        CMD_CIPDOMAIN        },
+  { "CIPMUX",           CMD_CIPMUX           },
+  { "CIPSERVER",        CMD_CIPSERVER        },
+  { "CIPSERVERMAXCONN", CMD_CIPSERVERMAXCONN },
+  { "CIPSTAMAC",        CMD_CIPSTAMAC_CUR    },
+  { "CIPSTATUS",        CMD_CIPSTATUS        },
+  { "CPIN",             CMD_CPIN             },
+  { "CSQ",              CMD_CSQ              },
+  { "CWAUTOCONN",       CMD_CWAUTOCONN       },
+  { "CWHOSTNAME",       CMD_CWHOSTNAME       },
+  { "CWJAP",            CMD_CWJAP_CUR        },
+  { "CWLAP",            CMD_CWLAP            },
+  { "CWLIF",            CMD_CWLIF            },
+  { "CWQAP",            CMD_CWQAP            },
+  { "CWSAP",            CMD_CWSAP_CUR        },
+  { "IFC",              CMD_FLOW_CTRL        },
+  { "IPD",              CMD_IPD              },
+  { "IPR",              CMD_UART_RATE        },
+  { "LINK_CONN",        CMD_LINK_CONN        },
+  { "QHTTPCFG",         CMD_QHTTPCFG         },
+  { "QHTTPGET",         CMD_QHTTPGET         },
+  { "QHTTPPOST",        CMD_QHTTPPOST        },
+  { "QHTTPREAD",        CMD_QHTTPREAD        },
+  { "QHTTPURL",         CMD_QHTTPURL         },
+  { "QIACT",            CMD_QIACT            },
+  { "QICLOSE",          CMD_CIPCLOSE         },
+  { "QICSGP",           CMD_QICSGP           },
+  { "QIDEACT",          CMD_QIDEACT          },
+  { "QIOPEN",           CMD_CIPSTART         },
+  { "QISEND",           CMD_CIPSEND          },
+  { "QPING",            CMD_PING             },
+  { "QSCLK",            CMD_SLEEP            },
+  { "QSSLCFG",          CMD_QSSLCFG          },
+  { "RST",              CMD_RST              },
+  { "STA_CONNECTED",    CMD_STA_CONNECTED    },
+  { "STA_DISCONNECTED", CMD_STA_DISCONNECTED },
+#if (AT_VARIANT == AT_VARIANT_EG915U)
+  { "SYSMSG",           CMD_SYSMSG_CUR       },
 #endif
-/* Special responses */
-  { "AT"                },//11
-  { "RDY"               },//12
-  { "READY"            }, //13
-  { "CME ERROR"          }, //CME ERROR 14
+  { "UART_CUR",         CMD_UART_CUR         }
 };
 
-
-/* List of strings received in response to AT+GMR */
-static STRING_LIST_t List_Gmr[] = {
-  { "AT version"   },
-  { "SDK version"  },
-  { "compile time" },
-  { "Bin version"  }
+/* Generic responses, longest key the line starts with (see AT_RESP_x definitions) */
+static const BUF_KEY Key_ASCIIResp[] = {
+  { "AT",               AT_RESP_ECHO           },
+  { "CME ERROR",        AT_RESP_ERR_CODE       },
+  { "CONNECT",          AT_RESP_CONNECT        },
+  { "ERROR",            AT_RESP_ERROR          },
+  { "FAIL",             AT_RESP_FAIL           },
+  { "MODEM CONNECTED",  AT_RESP_MOD_CONNECTED  },
+  { "MODEM DISCONNECT", AT_RESP_MOD_DISCONNECT },
+  { "MODEM GOT IP",     AT_RESP_MOD_GOT_IP     },
+  { "OK",               AT_RESP_OK             },
+  { "RDY",              AT_RESP_READY          },
+  { "READY",            AT_RESP_READY2         },
+  { "SEND FAIL",        AT_RESP_SEND_FAIL      },
+  { "SEND OK",          AT_RESP_SEND_OK        },
+  { "busy p...",        AT_RESP_BUSY_P         },
+  { "busy s...",        AT_RESP_BUSY_S         }
 };
 
 /* GMR codes */
@@ -215,11 +288,12 @@ static STRING_LIST_t List_Gmr[] = {
 #define AT_GMR_BIN_VER          3
 #define AT_GMR_UNKNOWN          0xFF
 
-
-/* Control strings */
-static STRING_LIST_t List_Ctrl[] = {
-  { "CONNECT" },
-  { "CLOSED"  }
+/* List of strings received in response to AT+GMR */
+static const BUF_KEY Key_Gmr[] = {
+  { "AT version",       AT_GMR_AT_VER    },
+  { "Bin version",      AT_GMR_BIN_VER   },
+  { "SDK version",      AT_GMR_SDK_VER   },
+  { "compile time",     AT_GMR_COMP_TIME }
 };
 
 /* Control codes */
@@ -229,6 +303,12 @@ static STRING_LIST_t List_Ctrl[] = {
 #define AT_CTRL_HTTP_ACTIVE    3
 #define AT_CTRL_UNKNOWN        0xFF
 
+/* Control strings */
+static const BUF_KEY Key_Ctrl[] = {
+  { "CLOSED",           AT_CTRL_CLOSED   },
+  { "CONNECT",          AT_CTRL_CONNECT  }
+};
+
 
 
 /* ------------------------------------------------------------------------- */
@@ -250,8 +330,8 @@ void Serial_Cb (uint32_t cb_event) {
     AT_Notify (AT_NOTIFY_TX_DONE, NULL);
   }
 
-  if (cb_event & SERIAL_CB_RX_DATA_AVAILABLE) {
-    /* Serial received data */
+  if (cb_event & (SERIAL_CB_RX_DATA_AVAILABLE | SERIAL_CB_RX_ERROR)) {
+    /* Serial received data or receive error */
     AT_Notify (AT_NOTIFY_EXECUTE, NULL);
   }
 }
@@ -268,14 +348,22 @@ void Serial_Cb (uint32_t cb_event) {
 int32_t AT_Parser_Initialize (void) {
   osMemoryPoolAttr_t mp_attr;
   osMemoryPoolId_t   mp_id;
+  osMemoryPoolId_t   mp_lg;
   int32_t ex, stat;
 
   stat = -1;
 
   mp_attr = AT_Parser_MemPool_Attr;
   mp_id = osMemoryPoolNew (PARSER_BUFFER_BLOCK_COUNT, PARSER_BUFFER_BLOCK_SIZE, &mp_attr);
+
+#if (PARSER_LARGE_BLOCK_COUNT != 0)
+  mp_attr = AT_Parser_MemPoolLg_Attr;
+  mp_lg = osMemoryPoolNew (PARSER_LARGE_BLOCK_COUNT, PARSER_LARGE_BLOCK_SIZE, &mp_attr);
+#else
+  mp_lg = NULL;
+#endif
 	
-  if (mp_id != NULL) {
+  if ((mp_id != NULL) && ((mp_lg != NULL) || (PARSER_LARGE_BLOCK_COUNT == 0))) {
 		
     /* Init serial interface */
     ex = Serial_Initialize ();
@@ -294,8 +382,18 @@ int32_t AT_Parser_Initialize (void) {
 
   if (stat >= 0) {
     /* Setup memory pool */
-    BufInit (mp_id, NULL, &pCb->mem);
-    BufInit (mp_id, NULL, &pCb->resp);
+    Modem_PoolRegister (MOD_POOL_PARSER,       mp_id);
+    Modem_PoolRegister (MOD_POOL_PARSER_LARGE, mp_lg);
+
+#if (PARSER_RING_SIZE != 0)
+    RingInit (AT_Parser_RingArr, PARSER_RING_SIZE, pMem);
+#else
+    BufInitAlloc (&Modem_PoolAllocator, mp_id, mp_lg, NULL, pMem);
+
+    /* Index line terminators as data is received */
+    BufLineIndex (&pCb->lidx, pMem);
+#endif
+    BufInitAlloc (&Modem_PoolAllocator, mp_id, mp_lg, NULL, &pCb->resp);
 
     /* Set initial state */
     pCb->state     = AT_STATE_ANALYZE;
@@ -304,6 +402,12 @@ int32_t AT_Parser_Initialize (void) {
     pCb->msg_code  = 0U;
     pCb->resp_code = CMD_UNKNOWN;
     pCb->resp_len  = 0U;
+
+    LineReset();
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+    pCb->cmdq.state = AT_CMDQ_IDLE;
+#endif
   }
 
   if (stat < 0) {
@@ -313,6 +417,10 @@ int32_t AT_Parser_Initialize (void) {
     if (mp_id != NULL) {
       osMemoryPoolDelete (mp_id);
     }
+
+    if (mp_lg != NULL) {
+      osMemoryPoolDelete (mp_lg);
+    }
   }
 
   return (stat);
@@ -325,12 +433,27 @@ int32_t AT_Parser_Uninitialize (void) {
 
   Serial_Uninitialize();
 
+#if (PARSER_RING_SIZE != 0)
+  RingUninit(pMem);
+#else
   BufUninit(pMem);
 
-  osMemoryPoolDelete (pMem->mp_id);
-
   pCb->mem.mp_id  = NULL;
+  pCb->mem.mp_lg  = NULL;
+#endif
+  BufUninit(&pCb->resp);
+
+  Modem_PoolRegister (MOD_POOL_PARSER,       NULL);
+  Modem_PoolRegister (MOD_POOL_PARSER_LARGE, NULL);
+
+  osMemoryPoolDelete (pCb->resp.mp_id);
+
+  if (pCb->resp.mp_lg != NULL) {
+    osMemoryPoolDelete (pCb->resp.mp_lg);
+  }
+
   pCb->resp.mp_id = NULL;
+  pCb->resp.mp_lg = NULL;
 
   return (0);
 }
@@ -355,7 +478,7 @@ int32_t AT_Parser_SetSerialCfg (AT_PARSER_COM_SERIAL *info) {
 void AT_Parser_Reset (void) {
 
   /* Flush parser buffer */
-  BufFlush (0, pMem);
+  AT_MemFlush (0, pMem);
 
   /* Reset state */
   pCb->state     = AT_STATE_ANALYZE;
@@ -364,6 +487,12 @@ void AT_Parser_Reset (void) {
   pCb->msg_code  = 0U;
   pCb->resp_code = CMD_UNKNOWN;
   pCb->resp_len  = 0U;
+
+  LineReset();
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+  pCb->cmdq.state = AT_CMDQ_IDLE;
+#endif
 }
 
 
@@ -371,23 +500,77 @@ void AT_Parser_Reset (void) {
   Execute AT command parser.
 */
 void AT_Parser_Execute (void) {
-  uint8_t crlf[] = {'\r', '\n'};
   int32_t n;
   uint32_t sleep;
-  uint32_t p;
+  uintptr_t p;
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+  uint32_t t0;
+  uint8_t  st;
+#endif
 
   sleep = 0U;
 
   while (sleep == 0) {
 
+    if (Serial_GetRxError() != 0U) {
+      /* Received data lost, discard buffered data and fail command in progress */
+      AT_MemFlush (0, pMem);
+
+      pCb->gen_resp = AT_RESP_RX_ERROR;
+      pCb->cmd_sent = CMD_UNKNOWN;
+
+      /* Driver ends socket receive or HTTP content transfer in progress */
+      p = (uintptr_t)pCb->state;
+
+      AT_Notify (AT_NOTIFY_RX_ERROR, &p);
+
+      pCb->ipd_rx = 0U;
+
+      if (pCb->state == AT_STATE_RESP_HTTP_CONTENT) {
+        HTTP_CTL_Parser.data_len = 0;
+        HTTP_CTL_Parser.enable   = AT_CTRL_UNKNOWN;
+      }
+
+      /* Data after the gap starts in the middle of a line */
+      pCb->state = AT_STATE_RESYNC;
+
+      LineReset();
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+      if (pCb->cmdq.state == AT_CMDQ_SUBMIT) {
+        /* Responses of commands in flight may be lost, fail the batch */
+        while (pCb->cmdq.done < pCb->cmdq.end) {
+          pCb->cmdq.entry[pCb->cmdq.done++].resp = AT_RESP_RX_ERROR;
+        }
+        pCb->cmdq.state = AT_CMDQ_DONE;
+      }
+      else if (pCb->cmdq.state == AT_CMDQ_DRAIN) {
+        /* Discarded responses may be lost, stop draining */
+        pCb->cmdq.state = AT_CMDQ_IDLE;
+      }
+#endif
+    }
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+    if (pCb->cmdq.state == AT_CMDQ_SUBMIT) {
+      /* Send batched commands */
+      CmdQueueSend();
+    }
+#endif
+
     /* Receive serial data */
     n = ReceiveData();
 
     if (n == 1U) {
       /* Out of memory */
-      AT_Notify (AT_NOTIFY_OUT_OF_MEMORY, pCb->mem.mp_id);
+      AT_Notify (AT_NOTIFY_OUT_OF_MEMORY, pMem);
     }
 
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+    st = pCb->state;
+    t0 = osKernelGetSysTimerCount();
+#endif
+
     switch (pCb->state) {
       case AT_STATE_ANALYZE:
         pCb->state = AnalyzeLineData();
@@ -403,11 +586,11 @@ void AT_Parser_Execute (void) {
 
       case AT_STATE_FLUSH:
         /* Flush current response till first CRLF */
-        n = BufFind (crlf, 2, pMem);
+        n = AT_MemFindLine (pMem);
 
         if (n != -1) {
           /* Flush buffer including crlf */
-          BufFlush ((uint32_t)n + 2, pMem);
+          AT_MemFlush ((uint32_t)n + 2, pMem);
         }
 
         /* Start analyzing again */
@@ -417,7 +600,7 @@ void AT_Parser_Execute (void) {
       case AT_STATE_RECV_DATA:
         /* Copy IPD data */
         /* Set pointer to source memory buffer */
-        p = (uint32_t)pMem;
+        p = (uintptr_t)pMem;
 
         /* Call notify using pointer to memory buffer */
         AT_Notify (AT_NOTIFY_CONNECTION_RX_DATA, &p);
@@ -435,7 +618,7 @@ void AT_Parser_Execute (void) {
             /* Application did not read anything */
             sleep = 1U;
           }
-          pCb->ipd_rx = p;
+          pCb->ipd_rx = (uint32_t)p;
         }
         break;
 
@@ -443,7 +626,7 @@ void AT_Parser_Execute (void) {
         /* Received +CMD response */
         if (pCb->resp_code == CMD_IPD) {
           /* Copy response (including ':' character) */
-          BufCopy (&(pCb->resp), &(pCb->mem), pCb->resp_len+1);
+          AT_MemCopy (&(pCb->resp), pMem, pCb->resp_len+1);
 
           /* Receive network data (+IPD) */
           pCb->ipd_rx = 0U;
@@ -458,19 +641,30 @@ void AT_Parser_Execute (void) {
           /* Start receiving data */
           pCb->state = AT_STATE_RECV_DATA;
         }
+        else if ((pCb->resp_code == CMD_UNKNOWN) && (UrcDispatch() != 0U)) {
+          /* Unsolicited result code delivered to subscribers, drop the line */
+          AT_MemFlush ((uint32_t)pCb->resp_len + 2U, pMem);
+
+          pCb->state = AT_STATE_ANALYZE;
+        }
         else {
+          if ((pCb->resp_code != CMD_UNKNOWN) && (pCb->resp_code != CMD_PING) && (pCb->resp_code != pCb->cmd_sent)) {
+            /* Known response not solicited by the pending command can be a subscribed URC (+CEREG), line is kept for the application */
+            (void)UrcDispatch();
+          }
+
           /* Response data arrived */
           if (pCb->resp_code == CMD_PING) {
             /* Artificially add '+PING:' string */
             BufWrite ((uint8_t *)"+PING:", 6, &(pCb->resp));
             /* Flush '+' from the original response */
-            BufFlushByte (&(pCb->mem));
+            AT_MemFlushByte (pMem);
             /* Adjust response length for the flushed byte */
             pCb->resp_len -= 1U;
           }
 
           /* Copy response (including "\r\n" characters) */
-          BufCopy (&(pCb->resp), &(pCb->mem), pCb->resp_len+2);
+          AT_MemCopy (&(pCb->resp), pMem, pCb->resp_len+2);
 
           pCb->state = AT_STATE_ANALYZE;
 
@@ -507,8 +701,8 @@ void AT_Parser_Execute (void) {
 
       case AT_STATE_RESP_HTTP_CONTENT:
         /* +GMR: copy response into response buffer */
-        p = (uint32_t) pCb;
-        //BufCopy (&(pCb->resp), &(pCb->mem), pCb->resp_len);
+        p = (uintptr_t)pCb;
+        //AT_MemCopy (&(pCb->resp), pMem, pCb->resp_len);
 
         AT_Notify (AT_NOTIFY_HTTP_CONTENT, &p);
 
@@ -535,18 +729,24 @@ void AT_Parser_Execute (void) {
               pCb->state = AT_STATE_RESP_HTTP_CONTENT;
 
               // flush buffer
-              n = BufFind (crlf, 2, pMem);
+              n = AT_MemFindLine (pMem);
               if (n != -1) {
                 /* Flush buffer including crlf */
-                BufFlush ((uint32_t)n + 2, pMem);
+                AT_MemFlush ((uint32_t)n + 2, pMem);
               }
 
               return;
              }
           case AT_RESP_SEND_OK:
           case AT_RESP_SEND_FAIL:
-            /* Set generic command response */
+            if (CmdQueueResp (pCb->msg_code) == 1U) {
+              /* Batched command completed with others pending or late response discarded */
+              break;
+            }
+
+            /* Set generic command response, command is no longer pending */
             pCb->gen_resp = pCb->msg_code;
+            pCb->cmd_sent = CMD_UNKNOWN;
 
             /* Application waits for response */
             AT_Notify (AT_NOTIFY_RESPONSE_GENERIC, NULL);
@@ -582,9 +782,25 @@ void AT_Parser_Execute (void) {
             /* Error code received */
             /* Artificially add '+' character and copy response */
             BufWriteByte ('+', &(pCb->resp));
-            BufCopy (&(pCb->resp), &(pCb->mem), pCb->resp_len+2);
+            AT_MemCopy (&(pCb->resp), pMem, pCb->resp_len+2);
 
             AT_Notify (AT_NOTIFY_ERR_CODE, NULL);
+
+            n = (int32_t)CmdQueueResp (AT_RESP_ERR_CODE);
+
+            if (n != 1) {
+              /* Error code is the final response, command is no longer pending */
+              pCb->cmd_sent = CMD_UNKNOWN;
+            }
+
+            if (n == 2) {
+              /* Last batched command failed, batch completed */
+              pCb->gen_resp = AT_RESP_ERR_CODE;
+
+              AT_Notify (AT_NOTIFY_RESPONSE_GENERIC, NULL);
+
+              sleep = 1U;
+            }
             break;
           
           default:
@@ -604,7 +820,7 @@ void AT_Parser_Execute (void) {
         sleep = 1U;
 
         /* Next state */
-        BufFlush (1, pMem);
+        AT_MemFlush (1, pMem);
         pCb->state = AT_STATE_ANALYZE;
         break;
 
@@ -628,26 +844,356 @@ void AT_Parser_Execute (void) {
         /* Next state */
         pCb->state = AT_STATE_FLUSH;
         break;
+
+      case AT_STATE_RESYNC:
+        /* Discard data till the first CRLF after receive error */
+        n = AT_MemFindLine (pMem);
+
+        if (n != -1) {
+          /* Flush buffer including crlf */
+          AT_MemFlush ((uint32_t)n + 2, pMem);
+
+          pCb->state = AT_STATE_ANALYZE;
+        }
+        else {
+          /* Keep only the last byte, it may be CR of the line end */
+          p = AT_MemGetCount (pMem);
+
+          if (p > 1U) {
+            AT_MemFlush (p - 1U, pMem);
+          }
+
+          /* Wait for line end */
+          sleep = 1U;
+        }
+        break;
+    }
+
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+    AT_Prof.state[st].cycles += osKernelGetSysTimerCount() - t0;
+    AT_Prof.state[st].calls++;
+#endif
+  }
+}
+
+
+/**
+  Retrieve parser state execution profile.
+*/
+int32_t AT_Parser_GetProfile (AT_PARSER_PROFILE *prof) {
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+  memcpy (prof, &AT_Prof, sizeof(AT_PARSER_PROFILE));
+
+  prof->timer_freq = osKernelGetSysTimerFreq();
+
+  return (0);
+#else
+  (void)prof;
+
+  return (-1);
+#endif
+}
+
+
+/**
+  Split URC arguments at commas, quoted arguments are returned without quotes.
+
+  \param[out] urc   URC structure receiving arguments
+  \param[in]  p     first character after the colon
+  \param[in]  end   end of line (CR)
+*/
+static void UrcParseArgs (AT_URC *urc, const char *p, const char *end) {
+  const char *start;
+
+  urc->argc = 0U;
+
+  while ((p < end) && (*p == ' ')) {
+    /* Skip leading spaces */
+    p++;
+  }
+
+  while ((p < end) && (urc->argc < AT_URC_ARG_MAX)) {
+    if (*p == '"') {
+      /* Quoted string, may contain commas */
+      start = ++p;
+
+      while ((p < end) && (*p != '"')) {
+        p++;
+      }
+      urc->argl[urc->argc] = (uint16_t)(p - start);
+
+      while ((p < end) && (*p != ',')) {
+        p++;
+      }
+    }
+    else {
+      start = p;
+
+      while ((p < end) && (*p != ',')) {
+        p++;
+      }
+      urc->argl[urc->argc] = (uint16_t)(p - start);
+    }
+    urc->argv[urc->argc++] = start;
+
+    if ((p < end) && ((p + 1) == end) && (urc->argc < AT_URC_ARG_MAX)) {
+      /* Line ends with comma, last argument is empty */
+      urc->argv[urc->argc]   = end;
+      urc->argl[urc->argc++] = 0U;
+    }
+
+    /* Skip comma */
+    p++;
+  }
+}
+
+/**
+  Deliver received +CMD line to URC subscribers.
+
+  Arguments point into the parser buffer when the line is stored in one
+  contiguous region, otherwise the line is copied into the control block.
+  Lines that are not contiguous and longer than AT_URC_LINE_MAX are not
+  delivered, a truncated line would pass wrong arguments to the handlers.
+
+  \return number of handlers called
+*/
+static uint32_t UrcDispatch (void) {
+  AT_URC   urc;
+  AT_URC_FUNC func;
+  char    *line;
+  void    *arg;
+  uint8_t *span;
+  const char *p, *colon, *name;
+  uint32_t i, n, len, num, cnt;
+  int32_t  lock;
+
+  cnt = 0U;
+
+  for (i = 0U; i < AT_URC_NUM; i++) {
+    if (AT_Urc[i].func != NULL) {
+      break;
+    }
+  }
+
+  if (i < AT_URC_NUM) {
+    /* Line without CRLF */
+    len = pCb->resp_len;
+
+    AT_MemBegin (pMem);
+
+    num = AT_MemPeekSpanUnlocked (0U, &span, pMem);
+
+    if (num >= len) {
+      /* Line is contiguous, no copy required */
+      p = (const char *)span;
+    }
+    else if (len > sizeof(pCb->urc_line)) {
+      /* Line does not fit into the copy buffer, skip dispatch */
+      p = NULL;
+    }
+    else {
+      /* Line continues in the next buffer, copy it */
+      line = pCb->urc_line;
+
+      for (n = 0U; n < len; n += num) {
+        num = AT_MemPeekSpanUnlocked (n, &span, pMem);
+
+        if (num == 0U) {
+          break;
+        }
+        if (num > (len - n)) {
+          num = len - n;
+        }
+        memcpy (&line[n], span, num);
+      }
+      p = line;
+    }
+
+    AT_MemEnd (pMem);
+
+    colon = (p != NULL) ? memchr (p, ':', len) : NULL;
+
+    if (colon != NULL) {
+      /* Name starts after '+' */
+      n = (uint32_t)(colon - &p[1]);
+
+      UrcParseArgs (&urc, colon + 1, &p[len]);
+
+      for (; i < AT_URC_NUM; i++) {
+        /* Read entry once, it may be unsubscribed concurrently */
+        lock = osKernelLock();
+        name = AT_Urc[i].name;
+        func = AT_Urc[i].func;
+        arg  = AT_Urc[i].arg;
+        (void)osKernelRestoreLock (lock);
+
+        if ((func != NULL) && (strlen (name) == n) && (memcmp (name, &p[1], n) == 0)) {
+          urc.name = name;
+
+          func (&urc, arg);
+          cnt++;
+        }
+      }
+    }
+  }
+
+  return (cnt);
+}
+
+/**
+  Subscribe handler for unsolicited result code.
+*/
+int32_t AT_Urc_Subscribe (const char *name, AT_URC_FUNC func, void *arg) {
+  uint32_t i;
+  int32_t  rval, lock;
+
+  rval = -1;
+
+  if ((name != NULL) && (func != NULL)) {
+    /* Find and claim free entry atomically */
+    lock = osKernelLock();
+
+    for (i = 0U; i < AT_URC_NUM; i++) {
+      if (AT_Urc[i].func == NULL) {
+        AT_Urc[i].name = name;
+        AT_Urc[i].arg  = arg;
+        AT_Urc[i].func = func;
+
+        rval = 0;
+        break;
+      }
     }
+
+    (void)osKernelRestoreLock (lock);
   }
+
+  return (rval);
 }
 
+/**
+  Unsubscribe handler for unsolicited result code.
+*/
+int32_t AT_Urc_Unsubscribe (const char *name, AT_URC_FUNC func) {
+  uint32_t i;
+  int32_t  rval, lock;
+
+  rval = -1;
+
+  lock = osKernelLock();
+
+  for (i = 0U; i < AT_URC_NUM; i++) {
+    if ((AT_Urc[i].func == func) && (func != NULL) && (strcmp (AT_Urc[i].name, name) == 0)) {
+      AT_Urc[i].func = NULL;
 
+      rval = 0;
+      break;
+    }
+  }
+
+  (void)osKernelRestoreLock (lock);
+
+  return (rval);
+}
+
+/**
+  Convert URC argument to integer.
+*/
+int32_t AT_Urc_ArgInt (const AT_URC *urc, uint32_t idx, int32_t *val) {
+  const char *p;
+  uint32_t i, len;
+  int32_t  v, sign, rval;
+
+  rval = -1;
+
+  if (idx < urc->argc) {
+    p   = urc->argv[idx];
+    len = urc->argl[idx];
+    i   = 0U;
+
+    sign = 1;
+    if ((len != 0U) && (p[0] == '-')) {
+      sign = -1;
+      i++;
+    }
+
+    v = 0;
+    for (rval = (i < len) ? 0 : -1; i < len; i++) {
+      if ((p[i] < '0') || (p[i] > '9')) {
+        /* Not a decimal number */
+        rval = -1;
+        break;
+      }
+      v = (v * 10) + (p[i] - '0');
+    }
+
+    if (rval == 0) {
+      *val = v * sign;
+    }
+  }
+
+  return (rval);
+}
+
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+/*
+  Commit data received by the serial interface directly into parser buffer
+  blocks and keep the serial receive queue supplied with free blocks.
+*/
+static int32_t ReceiveData (void) {
+  uint8_t *span;
+  uint32_t cnt;
+  int32_t err;
+
+  err = 0;
+
+  /* Make received data available to the parser, no copy required */
+  cnt = Serial_GetRxSpan (&span);
+
+  while (cnt != 0U) {
+    AT_MemCommitReserved (cnt, pMem);
+
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+    AT_Prof.rx_bytes += cnt;
+#endif
+
+    Serial_ReleaseRx (cnt);
+
+    cnt = Serial_GetRxSpan (&span);
+  }
+
+  /* Queue free blocks for serial receive */
+  while (Serial_GetRxBlockFree() != 0U) {
+    cnt = AT_MemReserve (&span, pMem);
+
+    if (cnt == 0U) {
+      if (Serial_GetRxBlockFree() == SERIAL_RX_BLOCK_NUM) {
+        /* Out of memory, receiver stopped */
+        err = 1U;
+      }
+      break;
+    }
+
+    if (Serial_ReceiveBlock (span, cnt) != 0) {
+      /* Receive could not be started, block remains queued */
+      err = 2U;
+      break;
+    }
+  }
+
+  return (err);
+}
+#else
 /*
   Retrieve data from the serial interface and copy the data into the buffer.
 */
 static int32_t ReceiveData (void) {
-  static uint32_t sz_buf;
   static uint32_t n_prev;
-  BUF_MEM *buf;
+  uint8_t *span;
   uint32_t n, cnt, num;
   int32_t err;
   
 
-  if (sz_buf == 0) {
-    sz_buf = BufGetSize(pMem);
-  }
-
   err = 0;
   num = 0U;
   n = Serial_GetRxCount();
@@ -658,14 +1204,8 @@ static int32_t ReceiveData (void) {
   }
 
   while (num < n) {
-    /* Determine free space in the buffer */
-    buf = BufGetTail (pMem);
-
-    if (buf != NULL) {
-      cnt = sz_buf - buf->wr_idx;
-    } else {
-      cnt = 0U;
-    }
+    /* Determine contiguous free space in the buffer */
+    cnt = AT_MemGetWriteSpan (&span, pMem);
 
     if (cnt != 0U) {
       /* We can read cnt bytes in one pass */
@@ -675,12 +1215,16 @@ static int32_t ReceiveData (void) {
         cnt = n;
       }
 
-      /* Read actual data */
-      cnt = (uint32_t)Serial_ReadBuf (&buf->data[buf->wr_idx], cnt);
+      /* Read actual data directly into the list buffer */
+      cnt = (uint32_t)Serial_ReadBuf (span, cnt);
 
       if (cnt != 0) {
-        buf->wr_idx += cnt;
-        num         += cnt;
+        AT_MemCommit (cnt, pMem);
+        num += cnt;
+
+#if (MOD_EG915U_PARSER_PROFILE != 0)
+        AT_Prof.rx_bytes += cnt;
+#endif
       } else {
         /* Serial buffer empty? */
         err = 2U;
@@ -699,6 +1243,8 @@ static int32_t ReceiveData (void) {
   return (err);
 }
 
+#endif
+
 #define AT_LINE_NODATA       (1U << 0) /* Line is empty                        */
 #define AT_LINE_INCOMPLETE   (1U << 1) /* Line contains incomplete response    */
 #define AT_LINE_PLUS         (1U << 2) /* Line starts with '+' response        */
@@ -708,100 +1254,161 @@ static int32_t ReceiveData (void) {
 #define AT_LINE_TXREQ        (1U << 6) /* Line starts with '>' character       */
 #define AT_LINE_CTRL         (1U << 7) /* Line starts with numeric character   */
 #define AT_LINE_NUMBER       (1U << 8) /* Line contains numeric character      */
+#define AT_LINE_CODE         (1U << 9) /* Response code determined            */
+
+/* Check if character can start a line recognized by AnalyzeLine */
+static uint32_t IsLineStart (uint8_t b) {
+  uint32_t rval;
+
+  if ((b == '+') || (b == '>')                      ||
+      ((b >= 'A') && (b <= 'Z')) || ((b >= 'a') && (b <= 'z')) ||
+      ((b >= '0') && (b <= '9'))) {
+    rval = 1U;
+  } else {
+    rval = 0U;
+  }
+
+  return (rval);
+}
+
+/**
+  Reset line analysis state, next line is analyzed from its first byte.
+*/
+static void LineReset (void) {
+  pCb->line.flags = 0U;
+  pCb->line.scan  = 0U;
+  pCb->line.colon = -1;
+  pCb->line.crlf  = -1;
+}
 
 /**
   Analyze received data and set AT_LINE_n flags based on the line content.
 
+  Terminator position is taken from the parser buffer line index, which
+  scans received data as it is written. Colon search resumes where the
+  previous call stopped and ends at the terminator. Line class, colon and
+  terminator position are kept in pCb->line until the line is processed,
+  therefore each received byte is scanned only once (ring buffer parser
+  memory has no line index, its terminator search covers the whole line).
+
   \return AT_LINE flags
 */
-static uint32_t AnalyzeLine (BUF_LIST *mem) {
-  uint8_t  crlf[] = {'\r', '\n'};
+static uint32_t AnalyzeLine (AT_PARSER_MEM *mem) {
+  AT_PARSER_LINE *ln;
+  uint8_t *span;    /* Readable region */
   uint8_t  b;       /* Received byte */
   uint32_t flags;   /* Analysis flags */
+  uint32_t i, num;
+  int32_t  crlf;    /* Terminator offset */
   int32_t  val;
 
-  flags = 0U;
+  ln = &pCb->line;
 
-  do {
-    /* Peek current byte from list buffer */
-    val = BufPeekByte (mem);
+  /* Analyze line under a single lock */
+  AT_MemBegin (mem);
 
-    if (val < 0) {
+  while (ln->flags == 0U) {
+    /* Line class not determined yet, check first byte */
+    num = AT_MemGetReadSpanUnlocked (&span, mem);
+
+    if (num == 0U) {
       /* Buffer empty */
-      flags |= AT_LINE_NODATA;
       break;
     }
 
-    b = (uint8_t)val;
+    b = span[0];
 
     if (b == '+') {
       /* Found: +command response */
-      flags |= AT_LINE_PLUS;
-
-      /* Check if colon is received */
-      val = BufFindByte (':', mem);
-
-      if (val != -1) {
-        flags |= AT_LINE_COLON;
-      } else {
-        /* Not terminated */
-        flags |= AT_LINE_INCOMPLETE;
-
-        /* Check if next character is a number (PING response) */
-        val = BufPeekOffs(1, mem);
-
-        if (val != -1) {
-          b = (uint8_t)val;
-
-          if ((b >= '0') && (b <= '9')) {
-            flags &= ~AT_LINE_INCOMPLETE;
-            flags |=  AT_LINE_NUMBER;
-          }
-        }
-      }
+      ln->flags = AT_LINE_PLUS;
     }
-
     else if (b == '>') {
       /* Found: data input request */
-      flags |= AT_LINE_TXREQ;
+      ln->flags = AT_LINE_TXREQ;
     }
     else if (((b >= 'A') && (b <= 'Z')) || ((b >= 'a') && (b <= 'z'))) {
       /* Found: command ASCII response */
-      flags |= AT_LINE_ASCII;
+      ln->flags = AT_LINE_ASCII;
+    }
+    else if ((b >= '0') && (b <= '9')) {
+      /* [<link ID>,] CLOSED response ? */
+      ln->flags = AT_LINE_CTRL;
+    }
+    else {
+      /* Unknown characters, flush the whole run and continue */
+      for (i = 1U; i < num; i++) {
+        if (IsLineStart (span[i]) != 0U) {
+          break;
+        }
+      }
+      AT_MemConsumeUnlocked (i, mem);
+    }
+  }
+
+  if (((ln->flags & (AT_LINE_PLUS | AT_LINE_ASCII | AT_LINE_CTRL)) != 0U) &&
+      ((ln->flags & AT_LINE_CRLF) == 0U)) {
+    /* Offset of CR of the first CRLF, line starts at current position */
+    crlf = AT_MemFindLineUnlocked (mem);
+
+    if (((ln->flags & AT_LINE_PLUS) != 0U) && (ln->colon == -1)) {
+      /* Search colon in bytes received since the last call, up to the terminator */
+      if (crlf == -1) {
+        num = AT_MemGetCount (mem) - ln->scan;
+      }
+      else if ((uint32_t)crlf > ln->scan) {
+        num = (uint32_t)crlf - ln->scan;
+      }
+      else {
+        /* CR was already searched, LF received now */
+        num = 0U;
+      }
+
+      val = AT_MemFindByteRangeUnlocked (':', ln->scan, num, mem);
+
+      if (val != -1) {
+        /* First colon (no CRLF follows +IPD header) */
+        ln->colon  = val;
+        ln->flags |= AT_LINE_COLON;
+      }
+      ln->scan += num;
+    }
 
-      /* Check if terminated */
-      val = BufFind (crlf, 2, mem);
+    if (crlf != -1) {
+      /* Line terminator */
+      ln->crlf   = crlf;
+      ln->flags |= AT_LINE_CRLF;
+    }
 
-      if (val != -1) {
-        pCb->resp_len = (uint8_t)val;
+    if ((ln->flags & (AT_LINE_PLUS | AT_LINE_COLON | AT_LINE_CRLF)) == (AT_LINE_PLUS | AT_LINE_CRLF)) {
+      /* Terminated without colon, check if next character is a number (PING response) */
+      val = AT_MemPeekOffsUnlocked (1, mem);
 
-        flags |= AT_LINE_CRLF;
-      } else {
-        /* Not terminated */
-        flags |= AT_LINE_INCOMPLETE;
+      if ((val >= '0') && (val <= '9')) {
+        ln->flags |= AT_LINE_NUMBER;
       }
     }
-    else if ((b >= '0') && (b <= '9')) {
-      /* [<link ID>,] CLOSED response ? */
-      flags |= AT_LINE_CTRL;
+  }
 
-      /* Check if terminated */
-      val = BufFind (crlf, 2, mem);
+  AT_MemEnd (mem);
 
-      if (val != -1) {
-        pCb->resp_len = (uint8_t)val;
+  flags = ln->flags;
 
-        flags |= AT_LINE_CRLF;
-      } else {
-        /* Not terminated */
-        flags |= AT_LINE_INCOMPLETE;
-      }
+  if (flags == 0U) {
+    /* Buffer is empty */
+    flags = AT_LINE_NODATA;
+  }
+  else if ((flags & AT_LINE_PLUS) != 0U) {
+    if ((flags & (AT_LINE_COLON | AT_LINE_CRLF)) == 0U) {
+      /* Neither colon nor terminator received */
+      flags |= AT_LINE_INCOMPLETE;
     }
-    else {
-      /* Unknown character, flush it and continue */
-      BufFlushByte(mem);
+  }
+  else if ((flags & (AT_LINE_ASCII | AT_LINE_CTRL)) != 0U) {
+    if ((flags & AT_LINE_CRLF) == 0U) {
+      /* Not terminated */
+      flags |= AT_LINE_INCOMPLETE;
     }
-  } while (flags == 0U);
+  }
 
   /* Return analysis result */
   return (flags);
@@ -814,10 +1421,8 @@ static uint32_t AnalyzeLine (BUF_LIST *mem) {
   \return next parser state, see AT_STATE_ definitions.
 */
 static uint8_t AnalyzeLineData (void) {
-  uint8_t  crlf[] = {'\r', '\n'};
   uint8_t  _code; 
   uint8_t  rval;
-  int32_t  n;
   uint32_t flags;
 
   flags = AnalyzeLine(pMem);
@@ -829,27 +1434,33 @@ static uint8_t AnalyzeLineData (void) {
   else if (flags & AT_LINE_PLUS) {
     /* Comand response with data */
     if (flags & AT_LINE_COLON) {
-      /* Line contains colon, string compare can be performed */
-      pCb->resp_code = GetCommandCode (pMem);
+      if ((flags & AT_LINE_CODE) == 0U) {
+        /* Line contains colon, string compare can be performed */
+        pCb->resp_code = GetCommandCode (pMem);
+
+        pCb->line.flags |= AT_LINE_CODE;
+      }
 
       if (pCb->resp_code == CMD_IPD) {
         /* Receive network data (+IPD) */
-        /* Find colon, there is no CRLF after +IPD */
-        pCb->resp_len = (uint8_t)BufFindByte (':', pMem);
+        /* Colon position, there is no CRLF after +IPD */
+        pCb->resp_len = (uint8_t)pCb->line.colon;
 
         rval = AT_STATE_RESP_DATA;
       }
       else {
-        /* Check if line is terminated */
-        n = BufFind (crlf, 2, pMem);
+        if ((flags & AT_LINE_CRLF) == 0U) {
+          /* Continue scan after colon */
+          flags = AnalyzeLine(pMem);
+        }
 
-        if (n == -1) {
+        if ((flags & AT_LINE_CRLF) == 0U) {
           /* Not terminated, wait for more data */
           rval = AT_STATE_WAIT;
         }
         else {
           /* Line terminator found */
-          pCb->resp_len = (uint8_t)n;
+          pCb->resp_len = (uint8_t)pCb->line.crlf;
 
           rval = AT_STATE_RESP_DATA;
         }
@@ -859,19 +1470,10 @@ static uint8_t AnalyzeLineData (void) {
       /* Response contains plus and a number, ping response (+x) */
       pCb->resp_code = CMD_PING;
 
-      /* Check if line is terminated */
-      n = BufFind (crlf, 2, pMem);
+      /* Line is terminated */
+      pCb->resp_len = (uint8_t)pCb->line.crlf;
 
-      if (n == -1) {
-        /* Not terminated, wait for more data */
-        rval = AT_STATE_WAIT;
-      }
-      else {
-        /* Line terminator found */
-        pCb->resp_len = (uint8_t)n;
-
-        rval = AT_STATE_RESP_DATA;
-      }
+      rval = AT_STATE_RESP_DATA;
     }
     else {
       /* No colon, out of sync */
@@ -882,6 +1484,8 @@ static uint8_t AnalyzeLineData (void) {
 
     /* Line contains ascii characters */
     if (flags & AT_LINE_CRLF) {
+      pCb->resp_len = (uint8_t)pCb->line.crlf;
+
       /* Line is terminated, string compare can be performed */
       _code = GetGMRResponseCode(pMem);
       
@@ -918,6 +1522,8 @@ static uint8_t AnalyzeLineData (void) {
   else if (flags & AT_LINE_CTRL) {
     /* Line contains ascii number */
     if (flags & AT_LINE_CRLF) {
+      pCb->resp_len = (uint8_t)pCb->line.crlf;
+
       /* Line is terminated, check content */
       _code = GetCtrlResponseCode (pMem);
 
@@ -939,115 +1545,72 @@ static uint8_t AnalyzeLineData (void) {
     rval = AT_STATE_FLUSH;
   }
 
+  if (rval != AT_STATE_WAIT) {
+    /* Line is handed over to the next state, analyze next line from its start */
+    LineReset();
+  }
+
   return (rval);
 }
 
 
 /**
-  Compare received data with predefined strings and return corresponding command code.
+  Classify +CMD response and return corresponding command code.
 
   \return CommandCode_t
 */
-static uint8_t GetCommandCode (BUF_LIST *mem) {
-  uint8_t i, maxi, code;
-  int32_t  val;
-
-  code = CMD_UNKNOWN;
-  maxi = sizeof(List_PlusResp)/sizeof(List_PlusResp[0]);
+static uint8_t GetCommandCode (AT_PARSER_MEM *mem) {
+  int32_t val;
 
-  for (i = 0; i < maxi; i++) {
-    val = BufCompareString (List_PlusResp[i].str, 1U, mem);
+  val = AT_MemMatchKey (Key_PlusResp, sizeof(Key_PlusResp)/sizeof(Key_PlusResp[0]), 1U, BUF_KEY_TOKEN, mem);
 
-    if (val > 0) {
-      /* String matches */
-      code = i;
-      break;
-    }
-  }
-  return (code);
+  return ((val >= 0) ? (uint8_t)val : CMD_UNKNOWN);
 }
 
 
 /**
-  Compare received data with predefined strings and return corresponding response code.
+  Classify generic response and return corresponding response code.
 
   \return Generic response code, see AT_RESP_ definitions
 */
-static uint8_t GetASCIIResponseCode (BUF_LIST *mem) {
-  uint8_t i, maxi, code;
+static uint8_t GetASCIIResponseCode (AT_PARSER_MEM *mem) {
   int32_t val;
 
-  code = AT_RESP_UNKNOWN;
-  maxi = sizeof(List_ASCIIResp)/sizeof(List_ASCIIResp[0]);
-
-  for (i = 0; i < maxi; i++) {
-    /* Search for responses (OK, ERROR, FAIL, SEND OK, ...) */
-    val = BufCompareString (List_ASCIIResp[i].str, 0U, mem);
+  /* Search for responses (OK, ERROR, FAIL, SEND OK, ...) */
+  val = AT_MemMatchKey (Key_ASCIIResp, sizeof(Key_ASCIIResp)/sizeof(Key_ASCIIResp[0]), 0U, BUF_KEY_PREFIX, mem);
 
-    if (val > 0) {
-      /* String matches */
-      code = i;
-      break;
-    }
-  }
-
-  return (code);
+  return ((val >= 0) ? (uint8_t)val : AT_RESP_UNKNOWN);
 }
 
 /**
-  Compare received data with predefined strings and return corresponding response code.
+  Classify AT+GMR response line and return corresponding GMR code.
 
-  \return GMR code, see ESP_GMR_ definitions
+  \return GMR code, see AT_GMR_ definitions
 */
-static uint8_t GetGMRResponseCode (BUF_LIST *mem) {
-  uint8_t i, maxi, code;
+static uint8_t GetGMRResponseCode (AT_PARSER_MEM *mem) {
   int32_t val;
 
-  code = AT_GMR_UNKNOWN;
-  maxi = sizeof(List_Gmr)/sizeof(List_Gmr[0]);
-
-  for (i = 0; i < maxi; i++) {
-    /* Search for responses */
-    val = BufCompareString (List_Gmr[i].str, 0U, mem);
-
-    if (val > 0) {
-      /* String matches */
-      code = i;
-      break;
-    }
-  }
+  val = AT_MemMatchKey (Key_Gmr, sizeof(Key_Gmr)/sizeof(Key_Gmr[0]), 0U, BUF_KEY_PREFIX, mem);
 
-  return (code);
+  return ((val >= 0) ? (uint8_t)val : AT_GMR_UNKNOWN);
 }
 
 
 /**
-  Compare received data with predefined strings and return corresponding control code.
+  Classify control string and return corresponding control code.
 
   Currently supported control strings:
   <conn id>,CONNECT
   <conn id>,CLOSED
 
-  \return ESP_CTRL_CONNECT, ESP_CTRL_CLOSED
+  \return AT_CTRL_CONNECT, AT_CTRL_CLOSED, AT_CTRL_UNKNOWN
 */
-//static uint32_t GetCtrlResponseCode (BUF_LIST *mem) {
-static uint8_t GetCtrlResponseCode (BUF_LIST *mem) {
-  uint8_t i, maxi, code;
+static uint8_t GetCtrlResponseCode (AT_PARSER_MEM *mem) {
   int32_t val;
 
-  code = AT_CTRL_UNKNOWN;
-  maxi = sizeof(List_Ctrl)/sizeof(List_Ctrl[0]);
-
-  for (i = 0; i < maxi; i++) {
-    val = BufCompareString (List_Ctrl[i].str, 2U, mem);
+  val = AT_MemMatchKey (Key_Ctrl, sizeof(Key_Ctrl)/sizeof(Key_Ctrl[0]), 2U, BUF_KEY_PREFIX, mem);
 
-    if (val > 0) {
-      /* String matches */
-      code = i;
-      break;
-    }
-  }
-  return (code);
+  return ((val >= 0) ? (uint8_t)val : AT_CTRL_UNKNOWN);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1352,7 +1915,7 @@ int32_t AT_Resp_CtrlConn (uint32_t *conn_id) {
   int32_t val;
   uint8_t b;
 
-  val = BufReadByte (pMem);
+  val = AT_MemReadByte (pMem);
 
   if (val != -1) {
     b = (uint8_t)val;
@@ -1626,6 +2189,63 @@ int32_t AT_Cmd_ConfigUARTRate (uint32_t at_cmode, uint32_t baudrate) {
   return (CmdSend(CMD_UART_RATE, out, n));
 }
 
+/**
+  Set/Query the UART flow control
+
+  Format S: AT+IFC=<dce_by_dte>,<dte_by_dce>
+  Format Q: AT+IFC?
+
+  Example S: AT+IFC=2,2\r\n (RTS/CTS hardware flow control)
+
+  \param[in]  at_cmode    Command mode (inquiry, set, exec)
+  \param[in]  dce_by_dte  0: none, 2: RTS flow control
+  \param[in]  dte_by_dce  0: none, 2: CTS flow control
+  \return 0:OK, -1: error
+*/
+int32_t AT_Cmd_FlowControl (uint32_t at_cmode, uint32_t dce_by_dte, uint32_t dte_by_dce) {
+  char out[32];
+  int32_t n;
+
+  /* Open AT command (AT+<cmd><mode> */
+  n = CmdOpen (CMD_FLOW_CTRL, at_cmode, out);
+
+  if (at_cmode == AT_CMODE_SET) {
+
+    /* Add command arguments */
+    n += sprintf (&out[n], "%d,%d", dce_by_dte, dte_by_dce);
+  }
+
+  /* Append CRLF and send command */
+  return (CmdSend(CMD_FLOW_CTRL, out, n));
+}
+
+/**
+  Set/Query network registration status reporting (+CEREG URC).
+
+  Format S: AT+CEREG=<n>
+  Format Q: AT+CEREG?
+
+  \param[in]  at_cmode  command mode (AT_CMODE_SET or AT_CMODE_QUERY)
+  \param[in]  n         0: disable, 1: enable +CEREG: <stat> URC,
+                        2: enable +CEREG: <stat>[,<tac>,<ci>[,<AcT>]] URC
+  \return 0:OK, -1: error
+*/
+int32_t AT_Cmd_NetRegStatus (uint32_t at_cmode, uint32_t n) {
+  char out[16];
+  int32_t num;
+
+  /* Open AT command (AT+<cmd><mode> */
+  num = CmdOpen (CMD_CEREG, at_cmode, out);
+
+  if (at_cmode == AT_CMODE_SET) {
+    /* Add command arguments */
+    num += sprintf (&out[num], "%d", n);
+  }
+
+  /* Append CRLF and send command */
+  return (CmdSend(CMD_CEREG, out, num));
+}
+
 /**
   Get response to ConfigUART command
 
@@ -3529,6 +4149,15 @@ static int32_t CmdSend (uint8_t cmd, char *buf, int32_t num) {
 
   rval = -1;
 
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+  if (pCb->cmdq.state == AT_CMDQ_COLLECT) {
+    /* Batch in progress, queue command (sent by the parser) */
+    num += sprintf (&buf[num], "%s", Ctrl_CRLF);
+
+    rval = CmdQueueAdd (cmd, buf, (uint32_t)num);
+  }
+  else
+#endif
   if (CmdSetWFE(cmd) == 0) {
     /* Command registered, append CRLF */
     num += sprintf (&buf[num], "%s", Ctrl_CRLF);
@@ -3559,6 +4188,238 @@ static int32_t CmdSetWFE (uint8_t cmd) {
 }
 
 
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+/* Commands answered only with optional +CMD:data and a final generic response */
+static const uint8_t Cmd_Pipelined[] = {
+  CMD_QICSGP, CMD_QHTTPCFG, CMD_QSSLCFG, CMD_CEREG
+};
+
+/**
+  Add command string into the command batch.
+
+  \param[in]  cmd   command code
+  \param[in]  buf   command string, terminated with CRLF
+  \param[in]  num   length of command string
+
+  \return 0:OK, -1: command cannot be pipelined or batch is full
+*/
+static int32_t CmdQueueAdd (uint8_t cmd, const char *buf, uint32_t num) {
+  AT_CMD_QUEUE *q;
+  AT_CMD_ENTRY *e;
+  uint32_t i;
+  int32_t  rval;
+
+  q    = &pCb->cmdq;
+  rval = -1;
+
+  for (i = 0U; i < sizeof(Cmd_Pipelined); i++) {
+    if (Cmd_Pipelined[i] == cmd) {
+      break;
+    }
+  }
+
+  if ((i < sizeof(Cmd_Pipelined)) && (q->num < MOD_EG915U_CMD_BATCH_SIZE) && ((q->used + num) <= MOD_EG915U_CMD_BATCH_BUF_SIZE)) {
+    e = &q->entry[q->num];
+
+    e->cmd  = cmd;
+    e->resp = AT_RESP_UNKNOWN;
+    e->offs = q->used;
+    e->len  = (uint16_t)num;
+
+    memcpy (&q->buf[q->used], buf, num);
+
+    q->used += (uint16_t)num;
+    q->num++;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+/**
+  Send batched commands while the pipeline is not full (parser thread).
+*/
+static void CmdQueueSend (void) {
+  AT_CMD_QUEUE *q;
+  AT_CMD_ENTRY *e;
+
+  q = &pCb->cmdq;
+
+  while ((q->sent < q->end) && ((q->sent - q->done) < MOD_EG915U_CMD_PIPELINE_DEPTH)) {
+    e = &q->entry[q->sent];
+
+    if (Serial_GetTxFree() < e->len) {
+      /* Transmit buffer full, retry on next parser execution */
+      break;
+    }
+
+    if (Serial_SendBuf ((const uint8_t *)&q->buf[e->offs], e->len) != (int32_t)e->len) {
+      /* Transmit error, fail commands not sent yet */
+      while (q->end > q->sent) {
+        q->entry[--q->end].resp = AT_RESP_ERROR;
+      }
+
+      if (q->done == q->end) {
+        /* No responses pending */
+        q->state = AT_CMDQ_DONE;
+
+        pCb->gen_resp = AT_RESP_ERROR;
+
+        AT_Notify (AT_NOTIFY_RESPONSE_GENERIC, NULL);
+      }
+      break;
+    }
+
+    pCb->cmd_sent = e->cmd;
+
+    q->sent++;
+  }
+}
+
+/**
+  Match generic response to the oldest command in flight.
+
+  \param[in]  resp  generic response code AT_RESP_x
+  \return 0: no batch in progress, response belongs to a single command
+           1: response matched, batch has pending commands or response of
+              an ended batch discarded
+           2: response matched, batch completed
+*/
+static uint32_t CmdQueueResp (uint8_t resp) {
+  AT_CMD_QUEUE *q;
+  uint32_t rval;
+
+  q    = &pCb->cmdq;
+  rval = 0U;
+
+  if (q->state == AT_CMDQ_DRAIN) {
+    if (q->done < q->sent) {
+      /* Late response of a command sent before AT_Cmd_BatchEnd */
+      q->done++;
+
+      rval = 1U;
+    }
+
+    if (q->done == q->sent) {
+      /* Following responses belong to single commands again */
+      q->state = AT_CMDQ_IDLE;
+    }
+  }
+  else if ((q->state == AT_CMDQ_SUBMIT) && (q->done < q->sent)) {
+    q->entry[q->done].resp = resp;
+    q->done++;
+
+    if (q->done == q->end) {
+      /* All commands completed */
+      q->state = AT_CMDQ_DONE;
+
+      rval = 2U;
+    }
+    else {
+      /* Send next command */
+      CmdQueueSend();
+
+      rval = 1U;
+    }
+  }
+
+  return (rval);
+}
+
+/**
+  Start a command batch.
+*/
+int32_t AT_Cmd_BatchBegin (void) {
+  AT_CMD_QUEUE *q;
+  int32_t rval;
+
+  q = &pCb->cmdq;
+
+  if ((q->state == AT_CMDQ_COLLECT) || (q->state == AT_CMDQ_SUBMIT) || (q->state == AT_CMDQ_DRAIN)) {
+    /* Batch in progress or its responses still expected */
+    rval = -1;
+  }
+  else {
+    q->num   = 0U;
+    q->end   = 0U;
+    q->sent  = 0U;
+    q->done  = 0U;
+    q->used  = 0U;
+    q->state = AT_CMDQ_COLLECT;
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+/**
+  Submit queued commands, parser sends them when executed.
+*/
+int32_t AT_Cmd_BatchSubmit (void) {
+  AT_CMD_QUEUE *q;
+  int32_t rval;
+
+  q = &pCb->cmdq;
+
+  if ((q->state != AT_CMDQ_COLLECT) || (q->num == 0U)) {
+    rval = -1;
+  }
+  else {
+    pCb->gen_resp = AT_RESP_UNKNOWN;
+
+    /* Commands are complete, hand over to the parser */
+    q->end   = q->num;
+    q->state = AT_CMDQ_SUBMIT;
+
+    rval = (int32_t)q->num;
+  }
+
+  return (rval);
+}
+
+/**
+  Get response of the command in the batch.
+*/
+int32_t AT_Resp_Batch (uint32_t idx) {
+  int32_t rval;
+
+  if (idx < pCb->cmdq.num) {
+    rval = pCb->cmdq.entry[idx].resp;
+  }
+  else {
+    rval = -1;
+  }
+
+  return (rval);
+}
+
+/**
+  End command batch.
+*/
+int32_t AT_Cmd_BatchEnd (void) {
+  AT_CMD_QUEUE *q;
+  uint32_t done;
+
+  q = &pCb->cmdq;
+
+  done = q->done;
+
+  if ((q->state == AT_CMDQ_SUBMIT) && (q->done < q->sent)) {
+    /* Parser stops sending, responses of commands in flight are discarded */
+    q->state = AT_CMDQ_DRAIN;
+  }
+  else if (q->state != AT_CMDQ_DRAIN) {
+    /* Parser stops sending and matching responses */
+    q->state = AT_CMDQ_IDLE;
+  }
+
+  return ((int32_t)done);
+}
+#endif
+
+
 /**
   Determine maximum number of bytes to be sent using AT_Send_Data.
 
@@ -3598,6 +4459,94 @@ uint32_t AT_Send_Data (const uint8_t *buf, uint32_t len) {
   return (n);
 }
 
+
+/**
+  Send data via currently active connection without copying it.
+
+  Buffer is handed directly to the serial driver and must remain unchanged
+  until AT_Send_GetPending returns 0. Less than len bytes are queued when
+  the serial transmit queue is full.
+
+  \param[in]  buf   data buffer
+  \param[in]  len   number of bytes in buf to send
+
+  \return number of bytes queued
+*/
+uint32_t AT_Send_DataNoCopy (const uint8_t *buf, uint32_t len) {
+  int32_t rval;
+  uint32_t n;
+
+  rval = Serial_SendBufNoCopy (buf, len);
+
+  if (rval < 0) {
+    n = 0U;
+  } else {
+    n = (uint32_t)rval;
+  }
+
+  return (n);
+}
+
+
+/**
+  Get number of bytes sent with AT_Send_DataNoCopy and not transmitted yet.
+
+  \return number of bytes
+*/
+uint32_t AT_Send_GetPending (void) {
+  return (Serial_GetTxPending());
+}
+
+
+/**
+  Abort data transmit, buffers passed to AT_Send_DataNoCopy are released.
+*/
+void AT_Send_Abort (void) {
+  Serial_AbortSend();
+}
+
+
+/**
+  Send data from the list buffer via currently active connection.
+
+  Data is passed to the serial driver as a list of segments pointing into
+  the list buffer blocks. Bytes sent are flushed from the list buffer.
+
+  \param[in]  p     list buffer
+  \param[in]  len   number of bytes from p to send
+
+  \return number of bytes sent
+*/
+uint32_t AT_Send_Buf (BUF_LIST *p, uint32_t len) {
+  BUF_SEG seg[AT_SEND_SEG_MAX];
+  uint32_t cnt;
+  int32_t rval;
+  uint32_t n;
+
+  n = 0U;
+
+  /* Export the data that fits into the transmit path */
+  cnt = AT_Send_GetFree();
+
+  if (len > cnt) {
+    len = cnt;
+  }
+
+  cnt = BufGetSegments (seg, AT_SEND_SEG_MAX, 0U, len, p);
+
+  if (cnt != 0U) {
+    /* Send out the segments */
+    rval = Serial_SendSeg (seg, cnt);
+
+    if (rval > 0) {
+      n = BufFlush ((uint32_t)rval, p);
+    }
+  }
+
+  /* Return number of bytes actually sent */
+  return (n);
+}
+
 /* ------------------------------------------------------------------------- */
 
 /**
@@ -4099,7 +5048,7 @@ int32_t AT_Cmd_HTTP_Config (MOD_HTTPOption_t option, void *data) {
 //   HTTP_OPTION_RESET,
 // } MOD_HTTPOption_t;
 
-  char out[32];
+  char out[64];
   int32_t n;
 
   n = CmdOpen (CMD_QHTTPCFG, AT_CMODE_SET, out);
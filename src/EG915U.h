@@ -28,6 +28,99 @@
 #include "BufList.h"
 #include "Modem_EG915U_Config.h"
 
+/* Serial parser buffer type selection */
+#ifndef MOD_EG915U_PARSER_RING_SIZE
+#define MOD_EG915U_PARSER_RING_SIZE     0
+#endif
+
+/* Parser state execution profiling */
+#ifndef MOD_EG915U_PARSER_PROFILE
+#define MOD_EG915U_PARSER_PROFILE       0
+#endif
+
+/* Number of pipelined commands in flight (1: command batch disabled) */
+#ifndef MOD_EG915U_CMD_PIPELINE_DEPTH
+#define MOD_EG915U_CMD_PIPELINE_DEPTH   1
+#endif
+
+/* Serial receive directly into parser buffer blocks */
+#ifndef MOD_EG915U_SERIAL_RX_BLOCK
+#define MOD_EG915U_SERIAL_RX_BLOCK      0
+#endif
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0) && (MOD_EG915U_PARSER_RING_SIZE != 0)
+#error "Serial block receive requires memory pool parser buffer (MOD_EG915U_PARSER_RING_SIZE = 0)"
+#endif
+
+#if (MOD_EG915U_PARSER_RING_SIZE != 0)
+#include "BufRing.h"
+
+/* Parser buffer is lock-free ring buffer */
+typedef BUF_RING AT_PARSER_MEM;
+
+#define AT_MemGetCount        RingGetCount
+#define AT_MemGetWriteSpan    RingGetWriteSpan
+#define AT_MemCommit          RingCommit
+#define AT_MemGetReadSpan     RingGetReadSpan
+#define AT_MemConsume         RingConsume
+#define AT_MemReadByte        RingReadByte
+#define AT_MemPeekOffs        RingPeekOffs
+#define AT_MemFlushByte       RingFlushByte
+#define AT_MemRead            RingRead
+#define AT_MemCopy            RingCopy
+#define AT_MemFlush           RingFlush
+#define AT_MemFindByte        RingFindByte
+#define AT_MemFind            RingFind
+#define AT_MemCompareString   RingCompareString
+#define AT_MemMatchKey        RingMatchKey
+#define AT_MemFindLine(r)     RingFind ((const uint8_t *)"\r\n", 2U, r)
+
+/* Ring buffer is lock-free, transactions are not needed */
+#define AT_MemBegin(r)                    ((void)(r))
+#define AT_MemEnd(r)                      ((void)(r))
+#define AT_MemGetReadSpanUnlocked         RingGetReadSpan
+#define AT_MemPeekSpanUnlocked            RingPeekSpan
+#define AT_MemConsumeUnlocked             RingConsume
+#define AT_MemPeekOffsUnlocked            RingPeekOffs
+#define AT_MemFindByteUnlocked            RingFindByte
+#define AT_MemFindByteRangeUnlocked       RingFindByteRange
+#define AT_MemFindLineUnlocked            AT_MemFindLine
+#define AT_MemCompareStringUnlocked       RingCompareString
+#else
+/* Parser buffer is list of memory pool blocks */
+typedef BUF_LIST AT_PARSER_MEM;
+
+#define AT_MemGetCount        BufGetCount
+#define AT_MemGetWriteSpan    BufGetWriteSpan
+#define AT_MemCommit          BufCommit
+#define AT_MemReserve         BufReserve
+#define AT_MemCommitReserved  BufCommitReserved
+#define AT_MemGetReadSpan     BufGetReadSpan
+#define AT_MemConsume         BufConsume
+#define AT_MemReadByte        BufReadByte
+#define AT_MemPeekOffs        BufPeekOffs
+#define AT_MemFlushByte       BufFlushByte
+#define AT_MemRead            BufRead
+#define AT_MemCopy            BufCopy
+#define AT_MemFlush           BufFlush
+#define AT_MemFindByte        BufFindByte
+#define AT_MemFind            BufFind
+#define AT_MemCompareString   BufCompareString
+#define AT_MemMatchKey        BufMatchKey
+#define AT_MemFindLine        BufFindLine
+
+#define AT_MemBegin                       BufBegin
+#define AT_MemEnd                         BufEnd
+#define AT_MemGetReadSpanUnlocked         BufGetReadSpanUnlocked
+#define AT_MemPeekSpanUnlocked            BufPeekSpanUnlocked
+#define AT_MemConsumeUnlocked             BufConsumeUnlocked
+#define AT_MemPeekOffsUnlocked            BufPeekOffsUnlocked
+#define AT_MemFindByteUnlocked            BufFindByteUnlocked
+#define AT_MemFindByteRangeUnlocked       BufFindByteRangeUnlocked
+#define AT_MemFindLineUnlocked            BufFindLineUnlocked
+#define AT_MemCompareStringUnlocked       BufCompareStringUnlocked
+#endif
+
 
 /* AT command set version and variant used */
 #ifndef AT_VERSION
@@ -76,6 +169,7 @@
 #define AT_NOTIFY_READY                 15 /* The AT firmware is ready              */
 #define AT_NOTIFY_HTTP_RESPONSE         16 /* The AT firmware is ready              */
 #define AT_NOTIFY_HTTP_CONTENT         17 /* The AT firmware is ready              */
+#define AT_NOTIFY_RX_ERROR             18 /* Serial data lost, arg: interrupted parser state */
 
 /**
   AT parser notify callback function.
@@ -101,6 +195,7 @@ extern void AT_Notify (uint32_t event, void *arg);
 #define AT_RESP_READY              12  /* "ready"             */
 #define AT_RESP_READY2             13  /* "ready"             */
 #define AT_RESP_ERR_CODE           14  /* "ERR CODE:0x..."    */
+#define AT_RESP_RX_ERROR           15  /* (serial receive error) */
 #define AT_RESP_CONNECT           AT_RESP_ALREADY_CONNECTED  /* "ERR CODE:0x..."    */
 #define AT_RESP_UNKNOWN          0xFF  /* (unknown)           */
 
@@ -175,12 +270,95 @@ typedef struct {
   uint8_t  flow_control;  /* 0:none, 1:RTS, 2:CTS, 3:RTS/CTS */
 } AT_PARSER_COM_SERIAL;
 
+/* Line analysis state, kept while a line is incomplete */
+typedef struct {
+  uint32_t flags;       /* Line class and analysis flags (AT_LINE_n) */
+  uint32_t scan;        /* Offset of the first byte not yet searched for ':' */
+  int32_t  colon;       /* Offset of the first ':' or -1 */
+  int32_t  crlf;        /* Offset of the CRLF terminator or -1 */
+} AT_PARSER_LINE;
+
+/* URC dispatch table size, arguments per URC and URC line copy size
+   (lines not stored contiguously and longer than AT_URC_LINE_MAX are not dispatched) */
+#ifndef AT_URC_NUM
+#define AT_URC_NUM              8
+#endif
+#ifndef AT_URC_ARG_MAX
+#define AT_URC_ARG_MAX          8
+#endif
+#ifndef AT_URC_LINE_MAX
+#define AT_URC_LINE_MAX         128
+#endif
+
+/* Unsolicited result code, arguments point to received data */
+typedef struct {
+  const char *name;                   /* URC name (as subscribed) */
+  uint32_t    argc;                   /* Number of arguments */
+  const char *argv[AT_URC_ARG_MAX];   /* Arguments without quotes, not null terminated */
+  uint16_t    argl[AT_URC_ARG_MAX];   /* Argument lengths */
+} AT_URC;
+
+/**
+  URC handler function.
+
+  Arguments are valid only during the call.
+
+  \param[in]  urc    received URC
+  \param[in]  arg    argument passed to AT_Urc_Subscribe
+*/
+typedef void (*AT_URC_FUNC) (const AT_URC *urc, void *arg);
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+/* Command batch size and command string storage */
+#ifndef MOD_EG915U_CMD_BATCH_SIZE
+#define MOD_EG915U_CMD_BATCH_SIZE       8
+#endif
+#ifndef MOD_EG915U_CMD_BATCH_BUF_SIZE
+#define MOD_EG915U_CMD_BATCH_BUF_SIZE   512
+#endif
+
+#if (MOD_EG915U_CMD_BATCH_SIZE > 255) || (MOD_EG915U_CMD_BATCH_BUF_SIZE > 65535)
+#error "Command batch size exceeds AT_CMD_QUEUE limits"
+#endif
+
+/* Command batch state */
+#define AT_CMDQ_IDLE            0  /* No batch                              */
+#define AT_CMDQ_COLLECT         1  /* Commands are collected, not sent yet  */
+#define AT_CMDQ_SUBMIT          2  /* Commands are sent, responses pending  */
+#define AT_CMDQ_DONE            3  /* All commands completed                */
+#define AT_CMDQ_DRAIN           4  /* Batch ended, responses of commands in flight are discarded */
+
+/* Pipelined command */
+typedef struct {
+  uint8_t  cmd;         /* Command code */
+  uint8_t  resp;        /* Generic response, AT_RESP_UNKNOWN while pending */
+  uint16_t offs;        /* Command string offset in queue buffer */
+  uint16_t len;         /* Command string length (including CRLF) */
+  uint16_t rsvd;        /* Reserved */
+} AT_CMD_ENTRY;
+
+/* Command batch, responses are matched to commands in FIFO order */
+typedef struct {
+  AT_CMD_ENTRY entry[MOD_EG915U_CMD_BATCH_SIZE];
+  volatile uint8_t state; /* Batch state (AT_CMDQ_n) */
+  uint8_t  num;         /* Number of commands in batch */
+  uint8_t  end;         /* Number of commands to send */
+  uint8_t  sent;        /* Number of commands sent */
+  uint8_t  done;        /* Number of commands completed */
+  uint16_t used;        /* Number of bytes used in buf */
+  char     buf[MOD_EG915U_CMD_BATCH_BUF_SIZE];
+} AT_CMD_QUEUE;
+#endif
+
 /* Device control block */
 typedef struct {
-  BUF_LIST mem;         /* Parser memory buffer */
+  AT_PARSER_MEM mem;    /* Parser memory buffer */
   BUF_LIST resp;        /* Response data buffer */
+#if (MOD_EG915U_PARSER_RING_SIZE == 0)
+  BUF_LINE_INDEX lidx;  /* Parser buffer line index */
+#endif
   uint8_t  state;       /* Parser state */
-  uint8_t  cmd_sent;    /* Last command sent     */
+  uint8_t  cmd_sent;    /* Last command sent, CMD_UNKNOWN after its final response */
   uint8_t  gen_resp;    /* Generic response */
   uint8_t  msg_code;    /* Message code          */
   uint8_t  ctrl_code;   /* Control code          */
@@ -188,6 +366,11 @@ typedef struct {
   uint8_t  resp_len;    /* Response length */
   uint8_t  rsvd[2];     /* Reserved */
   uint32_t ipd_rx;      /* Number of bytes to receive (+IPD) */
+  AT_PARSER_LINE line;  /* Line analysis state */
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+  AT_CMD_QUEUE   cmdq;  /* Pipelined command batch */
+#endif
+  char     urc_line[AT_URC_LINE_MAX]; /* URC line copy (line not contiguous) */
 } AT_PARSER_HANDLE;
 
 
@@ -268,6 +451,20 @@ typedef enum {
 #define AT_STATE_SEND_DATA   7
 #define AT_STATE_RESP_CTRL   8
 #define AT_STATE_RESP_ECHO   9
+#define AT_STATE_RESYNC      10
+#define AT_STATE_NUM         11
+
+/* Parser state execution profile (MOD_EG915U_PARSER_PROFILE) */
+typedef struct {
+  uint32_t calls;       /* Number of state executions */
+  uint64_t cycles;      /* System timer cycles spent in state */
+} AT_PARSER_STATE_PROFILE;
+
+typedef struct {
+  uint64_t rx_bytes;    /* Number of bytes received into parser buffer */
+  uint32_t timer_freq;  /* System timer frequency [Hz] */
+  AT_PARSER_STATE_PROFILE state[AT_STATE_NUM];
+} AT_PARSER_PROFILE;
 
 
 
@@ -380,6 +577,16 @@ extern int32_t AT_Parser_SetSerialCfg (AT_PARSER_COM_SERIAL *info);
 extern void    AT_Parser_Execute      (void);
 extern void    AT_Parser_Reset        (void);
 
+/**
+  Retrieve parser state execution profile.
+
+  Counters are collected only when MOD_EG915U_PARSER_PROFILE is enabled.
+
+  \param[out] prof    pointer to profile structure
+  \return 0: ok, -1: profiling disabled
+*/
+extern int32_t AT_Parser_GetProfile (AT_PARSER_PROFILE *prof);
+
 /* Command/Response functions */
 
 /**
@@ -1055,6 +1262,91 @@ extern int32_t AT_Resp_StaMac (uint8_t mac[]);
 */
 extern int32_t AT_Resp_ErrCode (uint32_t *err_code);
 
+/**
+  Subscribe handler for unsolicited result code.
+
+  Handler is called from the parser (Modem thread) for each received line
+  +<name>:<args>, several handlers may subscribe the same name. Name string
+  must remain valid while subscribed. Handler must not block or send AT commands.
+
+  URC lines with names not known to the parser are dropped after delivery,
+  known command responses are delivered unless they answer the pending
+  command, and are processed as before.
+
+  \param[in]  name   URC name without '+' and ':' (e.g. "QIURC")
+  \param[in]  func   handler function
+  \param[in]  arg    handler argument
+  \return 0: OK, -1: invalid parameter or no free dispatch table entry
+*/
+extern int32_t AT_Urc_Subscribe (const char *name, AT_URC_FUNC func, void *arg);
+
+/**
+  Unsubscribe handler for unsolicited result code.
+
+  Handler can still be called once when the parser is dispatching a line
+  while the handler is unsubscribed.
+
+  \param[in]  name   URC name used with AT_Urc_Subscribe
+  \param[in]  func   handler function used with AT_Urc_Subscribe
+  \return 0: OK, -1: subscription not found
+*/
+extern int32_t AT_Urc_Unsubscribe (const char *name, AT_URC_FUNC func);
+
+/**
+  Convert URC argument to integer.
+
+  \param[in]  urc    URC passed to the handler
+  \param[in]  idx    argument index
+  \param[out] val    converted value
+  \return 0: OK, -1: no such argument or not a decimal number
+*/
+extern int32_t AT_Urc_ArgInt (const AT_URC *urc, uint32_t idx, int32_t *val);
+
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+/**
+  Start a command batch.
+
+  Commands issued with AT_Cmd_x functions until AT_Cmd_BatchSubmit are queued
+  instead of sent. Only commands answered with optional +CMD:data and a final
+  generic response can be queued, AT_Cmd_x returns -1 for other commands.
+
+  \return 0: OK, -1: batch already in progress or responses of the previous
+              batch not received yet
+*/
+extern int32_t AT_Cmd_BatchBegin (void);
+
+/**
+  Submit queued commands.
+
+  Commands are sent by the parser, up to MOD_EG915U_CMD_PIPELINE_DEPTH
+  commands are in flight. Generic responses are matched to commands in FIFO
+  order and AT_NOTIFY_RESPONSE_GENERIC is sent once all commands completed.
+
+  \return number of commands submitted, -1: no batch or batch empty
+*/
+extern int32_t AT_Cmd_BatchSubmit (void);
+
+/**
+  Get response of the command in the batch.
+
+  \param[in]  idx   command index, in order of AT_Cmd_x calls
+  \return generic response code AT_RESP_x, AT_RESP_UNKNOWN when not completed
+           -1: invalid index
+*/
+extern int32_t AT_Resp_Batch (uint32_t idx);
+
+/**
+  End command batch, commands not sent yet are dropped.
+
+  Responses of commands still in flight (i.e. after a timeout) are received
+  and discarded by the parser, they are not taken as response of the next
+  command.
+
+  \return number of completed commands
+*/
+extern int32_t AT_Cmd_BatchEnd (void);
+#endif
+
 /**
   Get number of bytes that can be sent.
 */
@@ -1065,6 +1357,28 @@ extern uint32_t AT_Send_GetFree (void);
 */
 extern uint32_t AT_Send_Data (const uint8_t *buf, uint32_t len);
 
+/**
+  Send data without copying (reply to data transmit request).
+
+  Buffer must remain unchanged until AT_Send_GetPending returns 0.
+*/
+extern uint32_t AT_Send_DataNoCopy (const uint8_t *buf, uint32_t len);
+
+/**
+  Get number of bytes sent with AT_Send_DataNoCopy and not transmitted yet.
+*/
+extern uint32_t AT_Send_GetPending (void);
+
+/**
+  Abort data transmit and release buffers passed to AT_Send_DataNoCopy.
+*/
+extern void AT_Send_Abort (void);
+
+/**
+  Send data from the list buffer (reply to data transmit request).
+*/
+extern uint32_t AT_Send_Buf (BUF_LIST *p, uint32_t len);
+
 
 
 extern int32_t AT_Cmd_SimMode (uint32_t at_cmode, char  * pin);
@@ -1086,6 +1400,8 @@ extern int32_t AT_Cmd_QHTTPREAD (uint16_t wait_time);
 extern int32_t AT_RespData_HTTP (uint8_t *buf, uint32_t len);
 extern int32_t AT_Cmd_SSL_Config (SSL_Config_t option, uint8_t ssl_context_id, void * data);
 extern int32_t AT_Cmd_ConfigUARTRate (uint32_t at_cmode, uint32_t baudrate);
+extern int32_t AT_Cmd_FlowControl (uint32_t at_cmode, uint32_t dce_by_dte, uint32_t dte_by_dce);
+extern int32_t AT_Cmd_NetRegStatus (uint32_t at_cmode, uint32_t n);
 
 
 #endif /* EG915U_H__ */
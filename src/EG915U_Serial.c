@@ -25,20 +25,67 @@
 #include <string.h>
 
 #include "EG915U_Serial.h"
+#include "EG915U_SerialTx.h"
 #include "Driver_USART.h"
 #include "cmsis_compiler.h"
 
 #include "Modem_EG915U_Config.h"
+#include "Modem_EG915U_Os.h"
 
 /* Serial buffer sizes */
 #ifndef SERIAL_TXBUF_SZ
-#define SERIAL_TXBUF_SZ   512
+#define SERIAL_TXBUF_SZ   1024
+#endif
+
+#if ((SERIAL_TXBUF_SZ & (SERIAL_TXBUF_SZ - 1)) != 0)
+#error "SERIAL_TXBUF_SZ must be a power of 2"
+#endif
+
+/* Number of transmit descriptors */
+#ifndef SERIAL_TXDESC_NUM
+#define SERIAL_TXDESC_NUM 8
+#endif
+
+/* Maximum transfer size of one caller buffer descriptor (Serial_SendBufNoCopy) */
+#ifndef SERIAL_TXEXT_SZ
+#define SERIAL_TXEXT_SZ   4096
+#endif
+
+#if (SERIAL_TXEXT_SZ > 65535)
+#error "SERIAL_TXEXT_SZ exceeds maximum driver transfer size"
 #endif
 
 #ifndef SERIAL_RXBUF_SZ
 #define SERIAL_RXBUF_SZ   512
 #endif
 
+/* Receive directly into blocks supplied with Serial_ReceiveBlock (0: use RxBuf) */
+#ifndef MOD_EG915U_SERIAL_RX_BLOCK
+#define MOD_EG915U_SERIAL_RX_BLOCK  0
+#endif
+
+/* Receive idle time in character times (software idle detection) */
+#ifndef MOD_EG915U_SERIAL_IDLE_CHARS
+#define MOD_EG915U_SERIAL_IDLE_CHARS     3
+#endif
+
+/* Maximum receive poll interval in ms while idle (software idle detection) */
+#ifndef MOD_EG915U_SERIAL_IDLE_POLL_MAX
+#define MOD_EG915U_SERIAL_IDLE_POLL_MAX  100
+#endif
+
+/* Serial trace capture (Serial_TraceDump) */
+#ifndef MOD_EG915U_SERIAL_TRACE
+#define MOD_EG915U_SERIAL_TRACE          0
+#define MOD_EG915U_SERIAL_TRACE_SIZE     4096
+#endif
+
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+#if ((MOD_EG915U_SERIAL_TRACE_SIZE & (MOD_EG915U_SERIAL_TRACE_SIZE - 1)) != 0)
+#error "MOD_EG915U_SERIAL_TRACE_SIZE must be a power of 2"
+#endif
+#endif
+
 /* Expansion macro used to create CMSIS Driver references */
 #define EXPAND_SYMBOL(name, port) name##port
 #define CREATE_SYMBOL(name, port) EXPAND_SYMBOL(name, port)
@@ -62,6 +109,7 @@ extern ARM_DRIVER_USART           CMSIS_USART_DRIVER;
 
 /* Static functions */
 static void UART_Callback (uint32_t event);
+static void IdleTimer     (void *arg);
 
 typedef struct {
   ARM_DRIVER_USART *drv;  /* UART driver       */
@@ -69,15 +117,301 @@ typedef struct {
   uint32_t baudrate;      /* UART driver speed */
   uint32_t rxc;           /* Rx buffer count   */
   uint32_t rxi;           /* Rx buffer index   */
-  uint32_t txi;           /* Tx buffer index   */
+  uint32_t rxe;           /* Rx error flags (SERIAL_RX_ERR_xxx)  */
   uint8_t  txb;           /* Tx busy flag      */
   uint8_t  r[3];          /* Reserved          */
 } SERIAL_COM;
 
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+/* Receive block */
+typedef struct {
+  uint8_t *buf;           /* Block data        */
+  uint32_t len;           /* Block length      */
+} SERIAL_RX_BLOCK;
+
+/*
+  Receive block queue
+
+  Blocks are queued by the thread (put), received by the driver (act) and
+  released by the thread (get). Indexes are free running.
+*/
+typedef struct {
+  SERIAL_RX_BLOCK bl[SERIAL_RX_BLOCK_NUM];
+  volatile uint32_t put;  /* Blocks queued     */
+  volatile uint32_t act;  /* Blocks received   */
+  uint32_t get;           /* Blocks released   */
+  uint32_t rdi;           /* Bytes released from the oldest block */
+  volatile uint8_t idle;  /* Receiver idle flag */
+  uint8_t  r[3];          /* Reserved          */
+} SERIAL_RXQ;
+
+static SERIAL_RXQ RxQ;
+#else
 static uint8_t RxBuf[SERIAL_RXBUF_SZ] __attribute__((section(USART_DRIVER_BSS)));
+#endif
 static uint8_t TxBuf[SERIAL_TXBUF_SZ] __attribute__((section(USART_DRIVER_BSS)));
 
-static SERIAL_COM Com;
+/* Transmit queue, next transfer is chained from the send complete event */
+static SERIAL_TXDESC TxDesc[SERIAL_TXDESC_NUM];
+static SERIAL_TXQ    TxQ;
+
+static volatile SERIAL_COM Com;
+
+static SERIAL_STATS Stats;
+
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+/*
+  Serial trace ring
+
+  Records (SERIAL_TRACE_REC followed by data) are written at head and the
+  oldest records are dropped at tail to make room. Indexes are free running.
+*/
+typedef struct {
+  uint32_t head;          /* Bytes written     */
+  uint32_t tail;          /* Bytes dropped     */
+  uint32_t tick;          /* Time of the last record */
+  uint8_t  stop;          /* Capture stopped (dump in progress) */
+  uint8_t  r[3];          /* Reserved          */
+} SERIAL_TRACE;
+
+static SERIAL_TRACE Trace;
+static uint8_t      TraceBuf[MOD_EG915U_SERIAL_TRACE_SIZE];
+
+/* Copy data into trace ring at index i */
+static void TracePut (uint32_t i, const uint8_t *buf, uint32_t len) {
+  uint32_t k, cnt;
+
+  k   = i & (MOD_EG915U_SERIAL_TRACE_SIZE - 1U);
+  cnt = MOD_EG915U_SERIAL_TRACE_SIZE - k;
+
+  if (cnt > len) {
+    cnt = len;
+  }
+
+  memcpy (&TraceBuf[k], buf, cnt);
+  memcpy (&TraceBuf[0], &buf[cnt], len - cnt);
+}
+
+/* Copy data from trace ring at index i */
+static void TraceGet (uint32_t i, uint8_t *buf, uint32_t len) {
+  uint32_t k, cnt;
+
+  k   = i & (MOD_EG915U_SERIAL_TRACE_SIZE - 1U);
+  cnt = MOD_EG915U_SERIAL_TRACE_SIZE - k;
+
+  if (cnt > len) {
+    cnt = len;
+  }
+
+  memcpy (buf, &TraceBuf[k], cnt);
+  memcpy (&buf[cnt], &TraceBuf[0], len - cnt);
+}
+
+/* Record serial data run, dir is 0 (receive) or SERIAL_TRACE_TX */
+static void TraceRecord (uint32_t dir, const uint8_t *buf, uint32_t len) {
+  SERIAL_TRACE_REC rec, old;
+  uint32_t n, t, dt;
+  int32_t lock;
+
+  while (len != 0U) {
+    n = len;
+
+    if (n > SERIAL_TRACE_LEN_MAX) {
+      n = SERIAL_TRACE_LEN_MAX;
+    }
+    if (n > (MOD_EG915U_SERIAL_TRACE_SIZE - sizeof(rec))) {
+      n = MOD_EG915U_SERIAL_TRACE_SIZE - sizeof(rec);
+    }
+
+    lock = osKernelLock();
+
+    if (Trace.stop == 0U) {
+      t  = osKernelGetTickCount();
+      dt = t - Trace.tick;
+
+      Trace.tick = t;
+
+      rec.dt      = (dt > 0xFFFFU) ? 0xFFFFU : (uint16_t)dt;
+      rec.len_dir = (uint16_t)(n | dir);
+
+      /* Drop oldest records until the new record fits */
+      while ((MOD_EG915U_SERIAL_TRACE_SIZE - (Trace.head - Trace.tail)) < (sizeof(rec) + n)) {
+        TraceGet (Trace.tail, (uint8_t *)&old, sizeof(old));
+
+        Trace.tail += sizeof(old) + (old.len_dir & SERIAL_TRACE_LEN_MAX);
+      }
+
+      TracePut (Trace.head, (const uint8_t *)&rec, sizeof(rec));
+      TracePut (Trace.head + sizeof(rec), buf, n);
+
+      Trace.head += sizeof(rec) + n;
+    }
+
+    (void)osKernelRestoreLock (lock);
+
+    buf += n;
+    len -= n;
+  }
+}
+#endif
+
+/*
+  Software receive idle detection
+
+  Used when the driver does not signal receive timeout. Timer polls receive
+  progress and signals data available once the progress stops for the idle
+  time. Poll interval is the idle time while data is flowing and doubles up
+  to the maximum interval while the line is idle.
+*/
+typedef struct {
+  osTimerId_t id;         /* Poll timer id     */
+  uint32_t cnt;           /* Receive progress at last poll  */
+  uint32_t tmin;          /* Idle time [ticks] */
+  uint32_t tmax;          /* Maximum poll interval [ticks]  */
+  volatile uint32_t tick; /* Poll interval [ticks]          */
+  uint8_t  pend;          /* Received data not signaled yet */
+  uint8_t  r[3];          /* Reserved          */
+} SERIAL_IDLE;
+
+static SERIAL_IDLE Idle;
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+/* Start receive into the block at the head of the queue, if any */
+static int32_t RxStart (void) {
+  SERIAL_RX_BLOCK *bl;
+  int32_t stat;
+
+  stat = ARM_DRIVER_OK;
+
+  if (RxQ.act != RxQ.put) {
+    bl = &RxQ.bl[RxQ.act % SERIAL_RX_BLOCK_NUM];
+
+    stat = Com.drv->Receive (bl->buf, bl->len);
+
+    /* Receiver remains idle if receive could not be started */
+    RxQ.idle = (stat == ARM_DRIVER_OK) ? 0U : 1U;
+  }
+  else {
+    /* No block queued, receiver waits for Serial_ReceiveBlock */
+    RxQ.idle = 1U;
+  }
+
+  return (stat);
+}
+#endif
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK == 0)
+/* Return number of unread bytes in RxBuf, data overwritten by the receiver is dropped */
+static uint32_t RxUnread (void) {
+  uint32_t rxc, n;
+
+  /* Receive complete event may update rxc meanwhile */
+  do {
+    rxc = Com.rxc;
+    n   = rxc + Com.drv->GetRxCount();
+  }
+  while (rxc != Com.rxc);
+
+  n -= Com.rxi;
+
+  if (n > SERIAL_RXBUF_SZ) {
+    /* Receiver lapped unread data, drop everything received so far */
+    Com.rxi += n;
+
+    Stats.overrun++;
+    Stats.lost += n;
+
+    (void)__atomic_fetch_or (&Com.rxe, SERIAL_RX_ERR_OVERRUN, __ATOMIC_RELAXED);
+
+    n = 0U;
+  }
+
+  return (n);
+}
+#endif
+
+/* Return receive progress signature, changes whenever data is received */
+static uint32_t RxProgress (void) {
+  uint32_t n;
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+  n = (RxQ.act << 16) + Com.drv->GetRxCount();
+#else
+  n = Com.rxc + Com.drv->GetRxCount();
+#endif
+
+  return (n);
+}
+
+/* Calculate idle detection intervals for current baud rate */
+static void IdleSetup (void) {
+  uint32_t freq;
+
+  freq = osKernelGetTickFreq();
+
+  /* Character time is 10 bits (start, 8 data, stop), round up to whole ticks */
+  Idle.tmin = ((MOD_EG915U_SERIAL_IDLE_CHARS * 10U * freq) + Com.baudrate - 1U) / Com.baudrate;
+
+  if (Idle.tmin == 0U) {
+    Idle.tmin = 1U;
+  }
+
+  Idle.tmax = (MOD_EG915U_SERIAL_IDLE_POLL_MAX * freq) / 1000U;
+
+  if (Idle.tmax < Idle.tmin) {
+    Idle.tmax = Idle.tmin;
+  }
+}
+
+/* Restart idle detection with the shortest poll interval */
+static void IdleKick (void) {
+
+  if ((Idle.id != NULL) && (Idle.tick != Idle.tmin)) {
+    Idle.tick = Idle.tmin;
+
+    osTimerStart (Idle.id, Idle.tick);
+  }
+}
+
+/**
+  Receive idle detection timer callback.
+*/
+static void IdleTimer (void *arg) {
+  uint32_t cnt, tick;
+
+  (void)arg;
+
+  cnt  = RxProgress();
+  tick = Idle.tick;
+
+  if (cnt != Idle.cnt) {
+    /* Data received, poll with idle time until the line is quiet */
+    Idle.cnt  = cnt;
+    Idle.pend = 1U;
+
+    tick = Idle.tmin;
+  }
+  else if (Idle.pend != 0U) {
+    /* No data for the idle time */
+    Idle.pend = 0U;
+
+    Serial_Cb (SERIAL_CB_RX_DATA_AVAILABLE);
+  }
+  else {
+    /* Line idle, back off */
+    tick *= 2U;
+
+    if (tick > Idle.tmax) {
+      tick = Idle.tmax;
+    }
+  }
+
+  if (tick != Idle.tick) {
+    Idle.tick = tick;
+
+    osTimerStart (Idle.id, tick);
+  }
+}
 
 /**
   Initialize serial interface.
@@ -92,8 +426,18 @@ int32_t Serial_Initialize (void) {
   Com.drv = pDrvUART;
   Com.rxc = 0U;
   Com.rxi = 0U;
-  Com.txi = 0U;
   Com.txb = 0U;
+  Com.rxe = 0U;
+
+  TxQueueInit (&TxQ, TxBuf, SERIAL_TXBUF_SZ, TxDesc, SERIAL_TXDESC_NUM, SERIAL_TXEXT_SZ);
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+  memset (&RxQ, 0x00, sizeof(RxQ));
+  RxQ.idle = 1U;
+#endif
+
+  memset (&Idle,  0x00, sizeof(Idle));
+  memset (&Stats, 0x00, sizeof(Stats));
 
   /* Setup standard UART mode: 8 bits, no parity, 1 stop bit */
   Com.mode = ARM_USART_MODE_ASYNCHRONOUS | ARM_USART_DATA_BITS_8 |
@@ -144,10 +488,12 @@ int32_t Serial_Initialize (void) {
     /* CMSIS-USART receiver enable failed */
     stat = -5;
   }
+#if (MOD_EG915U_SERIAL_RX_BLOCK == 0)
   else if (Com.drv->Receive (&RxBuf[0], SERIAL_RXBUF_SZ) != ARM_DRIVER_OK) {
     /* CMSIS-USART receive operation failed */
     stat = -6;
   }
+#endif
   else {
     /* Check if receive timeout signal event is available */
     if (capab.event_rx_timeout == 1U) {
@@ -155,8 +501,20 @@ int32_t Serial_Initialize (void) {
       stat = 1;
     }
     else {
-      /* Serial setup complete, application might require pooling GetRxCount */
-      stat = 0;
+      /* Detect receive idle by polling GetRxCount */
+      IdleSetup();
+
+      Idle.id   = osTimerNew (&IdleTimer, osTimerPeriodic, NULL, &Serial_Timer_Attr);
+      Idle.tick = Idle.tmin;
+
+      if ((Idle.id != NULL) && (osTimerStart (Idle.id, Idle.tick) == osOK)) {
+        /* Serial setup complete, event driven mode with software idle detection */
+        stat = 1;
+      }
+      else {
+        /* Serial setup complete, application might require pooling GetRxCount */
+        stat = 0;
+      }
     }
   }
 
@@ -171,10 +529,23 @@ int32_t Serial_Initialize (void) {
 */
 int32_t Serial_Uninitialize (void) {
 
+  if (Idle.id != NULL) {
+    /* Stop receive idle detection */
+    osTimerStop   (Idle.id);
+    osTimerDelete (Idle.id);
+
+    Idle.id = NULL;
+  }
+
   Com.drv->PowerControl (ARM_POWER_OFF);
   Com.drv->Uninitialize ();
 
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+  memset (&RxQ, 0x00, sizeof(RxQ));
+  RxQ.idle = 1U;
+#else
   memset (RxBuf, 0x00, SERIAL_RXBUF_SZ);
+#endif
   memset (TxBuf, 0x00, SERIAL_TXBUF_SZ);
 
   return (0);
@@ -257,9 +628,21 @@ int32_t Serial_SetMode (SERIAL_MODE *mode) {
     /* Abort current receive operation */
     status = Com.drv->Control (ARM_USART_ABORT_RECEIVE, NULL);
 
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+    if ((RxQ.act != RxQ.put) && (RxQ.get == RxQ.act)) {
+      /* Restart the active block after bytes already released */
+      RxQ.bl[RxQ.act % SERIAL_RX_BLOCK_NUM].buf += RxQ.rdi;
+      RxQ.bl[RxQ.act % SERIAL_RX_BLOCK_NUM].len -= RxQ.rdi;
+      RxQ.rdi = 0U;
+    }
+#endif
+
     Com.rxc = 0U;
     Com.rxi = 0U;
-    Com.txi = 0U;
+    /* Abort current send operation and drop queued data */
+    Com.drv->Control (ARM_USART_ABORT_SEND, 0U);
+
+    TxQueueFlush (&TxQ);
     Com.txb = 0U;
 
     if (status == ARM_DRIVER_OK) {
@@ -271,6 +654,12 @@ int32_t Serial_SetMode (SERIAL_MODE *mode) {
         Com.mode     = arg;
         Com.baudrate = br;
 
+        if (Idle.id != NULL) {
+          /* Idle time depends on baud rate */
+          IdleSetup();
+          IdleKick();
+        }
+
         /* Enable TX output */
         Com.drv->Control(ARM_USART_CONTROL_TX, 1);
 
@@ -278,7 +667,11 @@ int32_t Serial_SetMode (SERIAL_MODE *mode) {
         Com.drv->Control(ARM_USART_CONTROL_RX, 1);
 
         /* Start serial receive */
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+        status = RxStart();
+#else
         status = Com.drv->Receive (&RxBuf[0], SERIAL_RXBUF_SZ);
+#endif
       }
     }
 
@@ -290,53 +683,180 @@ int32_t Serial_SetMode (SERIAL_MODE *mode) {
   return (err);
 }
 
+/* Start next queued transfer, transmitter must be idle */
+static int32_t TxStart (void) {
+  SERIAL_TXDESC *d;
+  int32_t stat;
+
+  stat = ARM_DRIVER_OK;
+
+  d = TxQueuePeek (&TxQ);
+
+  if (d != NULL) {
+    Com.txb = 1U;
+
+    stat = Com.drv->Send (d->buf, d->len);
+
+    if (stat != ARM_DRIVER_OK) {
+      Com.txb = 0U;
+    }
+  }
+  else {
+    /* Queue empty */
+    Com.txb = 0U;
+  }
+
+  return (stat);
+}
+
+/* Start transmitter if idle, queued data is otherwise chained from the callback */
+static int32_t TxKick (void) {
+  int32_t stat;
+
+  stat = ARM_DRIVER_OK;
+
+  if (Com.txb == 0U) {
+    stat = TxStart();
+  }
+
+  /* Response is expected, poll receive with the idle time */
+  IdleKick();
+
+  return (stat);
+}
+
 /**
   Get number of bytes free in transmit buffer.
 
   \return number of bytes
 */
 uint32_t Serial_GetTxFree (void) {
-  uint32_t n;
-
-  if (Com.txb != 0U) {
-    n = 0;
-  } else {
-    n = SERIAL_TXBUF_SZ;
-  }
-
-  return (n);
+  return (TxQueueGetFree (&TxQ));
 }
 
 /**
   Try to send len of characters from the specified buffer.
 
-  If there is not enough space in the transmit buffer, number
-  of characters sent will be less than specified with len.
+  Data is copied into the transmit buffer and queued behind any transfer in
+  progress. If there is not enough space in the transmit buffer, number of
+  characters sent will be less than specified with len.
 
   \return number of bytes actually sent or -1 in case of error
 */
 int32_t Serial_SendBuf (const uint8_t *buf, uint32_t len) {
   uint32_t cnt;
   int32_t  n;
-  int32_t  stat;
 
-  cnt = len;
+  cnt = TxQueuePut (&TxQ, buf, len);
 
-  if (cnt > SERIAL_TXBUF_SZ) {
-    cnt = SERIAL_TXBUF_SZ;
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+  if (cnt != 0U) {
+    TraceRecord (SERIAL_TRACE_TX, buf, cnt);
   }
+#endif
 
-  memcpy (TxBuf, buf, cnt);
+  if (TxKick() == ARM_DRIVER_OK) {
+    n = (int32_t)cnt;
+  }
+  else {
+    n = -1;
+  }
 
-  Com.txb = 1U;
+  return n;
+}
 
-  stat = Com.drv->Send (&TxBuf[0], cnt);
 
-  if (stat == ARM_DRIVER_OK) {
-    n = (int32_t)cnt;
+/**
+  Send len characters directly from the specified buffer.
+
+  Buffer is queued behind any transfer in progress and passed to the driver
+  without copying, split into transfers of at most SERIAL_TXEXT_SZ bytes.
+  Less than len bytes are queued when transmit descriptors run out.
+  Buffer must not be modified until Serial_GetTxPending returns 0,
+  transmit complete callback is signaled for each transfer.
+
+  \return number of bytes queued or -1 in case of error
+*/
+int32_t Serial_SendBufNoCopy (const uint8_t *buf, uint32_t len) {
+  int32_t n;
+
+  n = (int32_t)TxQueuePutExt (&TxQ, buf, len);
+
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+  if (n != 0) {
+    TraceRecord (SERIAL_TRACE_TX, buf, (uint32_t)n);
+  }
+#endif
+
+  if (TxKick() != ARM_DRIVER_OK) {
+    n = -1;
+  }
+
+  return n;
+}
+
+
+/**
+  Get number of bytes queued with Serial_SendBufNoCopy and not transmitted yet.
+*/
+uint32_t Serial_GetTxPending (void) {
+  return (TxQueueGetPending (&TxQ));
+}
+
+
+/**
+  Abort current send operation and drop all queued data.
+*/
+void Serial_AbortSend (void) {
+
+  Com.drv->Control (ARM_USART_ABORT_SEND, 0U);
+
+  TxQueueFlush (&TxQ);
+  Com.txb = 0U;
+}
+
+
+/**
+  Try to send data described by cnt segments.
+
+  Segments are gathered directly into the transmit buffer, the caller does
+  not need to linearize the data first. If there is not enough space in the
+  transmit buffer, number of characters sent will be less than the total
+  length of the segments.
+
+  \return number of bytes actually sent or -1 in case of error
+*/
+int32_t Serial_SendSeg (const BUF_SEG *seg, uint32_t cnt) {
+  uint32_t i, len, sz;
+  int32_t  n;
+
+  sz = 0U;
+
+  for (i = 0U; i < cnt; i++) {
+    len = TxQueuePut (&TxQ, seg[i].buf, seg[i].len);
+
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+    if (len != 0U) {
+      TraceRecord (SERIAL_TRACE_TX, seg[i].buf, len);
+    }
+#endif
+
+    sz += len;
+
+    if (len != seg[i].len) {
+      /* Transmit buffer full */
+      break;
+    }
+  }
+
+  if (sz == 0U) {
+    /* Nothing to send */
+    n = 0;
+  }
+  else if (TxKick() == ARM_DRIVER_OK) {
+    n = (int32_t)sz;
   }
   else {
-    Com.txb = 0U;
     n = -1;
   }
 
@@ -344,6 +864,157 @@ int32_t Serial_SendBuf (const uint8_t *buf, uint32_t len) {
 }
 
 
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+/**
+  Queue a block for serial receive.
+
+  Blocks are received in the order queued. Driver chains the next queued
+  block from the receive complete event, the block must therefore remain
+  valid until it is released with Serial_ReleaseRx.
+
+  \param[in]  buf   block data
+  \param[in]  len   block length
+  \return 0:ok, -1:queue full or receive error (block is queued)
+*/
+int32_t Serial_ReceiveBlock (uint8_t *buf, uint32_t len) {
+  int32_t rval;
+
+  if ((buf == NULL) || (len == 0U) || ((RxQ.put - RxQ.get) == SERIAL_RX_BLOCK_NUM)) {
+    rval = -1;
+  }
+  else {
+    RxQ.bl[RxQ.put % SERIAL_RX_BLOCK_NUM].buf = buf;
+    RxQ.bl[RxQ.put % SERIAL_RX_BLOCK_NUM].len = len;
+
+    RxQ.put++;
+
+    rval = 0;
+
+    if (RxQ.idle != 0U) {
+      /* Receiver stopped, restart it with this block */
+      if (RxStart() != ARM_DRIVER_OK) {
+        rval = -1;
+      }
+    }
+  }
+
+  return (rval);
+}
+
+
+/**
+  Get number of blocks that can be queued with Serial_ReceiveBlock.
+*/
+uint32_t Serial_GetRxBlockFree (void) {
+  return (SERIAL_RX_BLOCK_NUM - (RxQ.put - RxQ.get));
+}
+
+
+/**
+  Retrieve received bytes of the oldest queued block that are not released yet.
+
+  \param[out] span  pointer to the first unreleased byte
+  \return number of bytes
+*/
+uint32_t Serial_GetRxSpan (uint8_t **span) {
+  SERIAL_RX_BLOCK *bl;
+  uint32_t act, n;
+
+  n = 0U;
+
+  if (RxQ.get != RxQ.put) {
+    bl = &RxQ.bl[RxQ.get % SERIAL_RX_BLOCK_NUM];
+
+    /* Receive count is valid only if the block did not complete meanwhile */
+    do {
+      act = RxQ.act;
+      n   = Com.drv->GetRxCount();
+    }
+    while (act != RxQ.act);
+
+    if ((RxQ.get != act) || (n > bl->len)) {
+      /* Block received completely */
+      n = bl->len;
+    }
+    else if (RxQ.idle != 0U) {
+      /* Receive into this block not started */
+      n = 0U;
+    }
+
+    *span = &bl->buf[RxQ.rdi];
+
+    n = (n > RxQ.rdi) ? (n - RxQ.rdi) : 0U;
+  }
+
+  return (n);
+}
+
+
+/**
+  Release num bytes of the span returned by Serial_GetRxSpan.
+
+  Block is removed from the queue once it is received and released completely.
+*/
+void Serial_ReleaseRx (uint32_t num) {
+
+  if (RxQ.get != RxQ.put) {
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+    TraceRecord (0U, &RxQ.bl[RxQ.get % SERIAL_RX_BLOCK_NUM].buf[RxQ.rdi], num);
+#endif
+
+    RxQ.rdi += num;
+
+    if ((RxQ.get != RxQ.act) && (RxQ.rdi >= RxQ.bl[RxQ.get % SERIAL_RX_BLOCK_NUM].len)) {
+      /* Block done */
+      RxQ.get++;
+      RxQ.rdi = 0U;
+    }
+  }
+}
+
+
+/**
+  Read len characters from the serial receive blocks and put them into buffer buf.
+
+  \return number of characters read
+*/
+int32_t Serial_ReadBuf(uint8_t *buf, uint32_t len) {
+  uint8_t *span;
+  uint32_t n, cnt;
+
+  n = 0U;
+
+  while (n < len) {
+    cnt = Serial_GetRxSpan (&span);
+
+    if (cnt == 0U) {
+      break;
+    }
+
+    if (cnt > (len - n)) {
+      cnt = len - n;
+    }
+
+    memcpy (&buf[n], span, cnt);
+
+    Serial_ReleaseRx (cnt);
+
+    n += cnt;
+  }
+
+  return (int32_t)n;
+}
+
+
+/**
+  Retrieve number of bytes to read from the oldest receive block
+*/
+uint32_t Serial_GetRxCount(void) {
+  uint8_t *span;
+
+  return (Serial_GetRxSpan (&span));
+}
+#else
 /**
   Read len characters from the serial receive buffers and put them into buffer buf.
 
@@ -353,8 +1024,7 @@ int32_t Serial_ReadBuf(uint8_t *buf, uint32_t len) {
   uint32_t n;
   uint32_t i, k;
 
-  n  = Com.rxc + Com.drv->GetRxCount();
-  n -= Com.rxi;
+  n = RxUnread();
 
   if (n > len) {
    n = len;
@@ -367,6 +1037,10 @@ int32_t Serial_ReadBuf(uint8_t *buf, uint32_t len) {
     buf[i] = RxBuf[k];
   }
 
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+  TraceRecord (0U, buf, n);
+#endif
+
   return (int32_t)n;
 }
 
@@ -375,14 +1049,49 @@ int32_t Serial_ReadBuf(uint8_t *buf, uint32_t len) {
   Retrieve total number of bytes to read
 */
 uint32_t Serial_GetRxCount(void) {
-  uint32_t n;
-  uint32_t u;
+  return (RxUnread());
+}
 
-  u  = Com.drv->GetRxCount();
-  n  = Com.rxc + u;
-  n -= Com.rxi;
+#endif
 
-  return (n);
+/**
+  Retrieve and clear receive errors detected since the last call.
+
+  Received data is not consistent when an error is reported, bytes were
+  dropped or corrupted on the line.
+
+  \return receive error flags (SERIAL_RX_ERR_xxx)
+*/
+uint32_t Serial_GetRxError (void) {
+
+#if (MOD_EG915U_SERIAL_RX_BLOCK == 0)
+  /* Check if receiver overwrote unread data */
+  (void)RxUnread();
+#endif
+
+  return (__atomic_exchange_n (&Com.rxe, 0U, __ATOMIC_RELAXED));
+}
+
+
+/**
+  Retrieve serial receive error statistics.
+
+  \param[out] stats  statistics counters
+  \return 0:ok, -1:invalid parameter
+*/
+int32_t Serial_GetStats (SERIAL_STATS *stats) {
+  int32_t rval;
+
+  if (stats == NULL) {
+    rval = -1;
+  }
+  else {
+    *stats = Stats;
+
+    rval = 0;
+  }
+
+  return (rval);
 }
 
 uint32_t Serial_GetTxCount(void) {
@@ -394,20 +1103,120 @@ uint32_t Serial_GetTxCount(void) {
 }
 
 
+#if (MOD_EG915U_SERIAL_TRACE != 0)
+/**
+  Dump serial trace.
+
+  Function func is called with consecutive parts of the trace: the trace
+  header (SERIAL_TRACE_HDR) followed by records from the oldest to the
+  newest. Capture is suspended during the dump, trace is not cleared.
+
+  \param[in]  func   dump function
+  \return number of bytes dumped or -1 on invalid parameter
+*/
+int32_t Serial_TraceDump (SERIAL_TRACE_FUNC func) {
+  SERIAL_TRACE_HDR hdr;
+  uint32_t i, k, cnt;
+  int32_t  rval, lock;
+
+  if (func == NULL) {
+    rval = -1;
+  }
+  else {
+    lock = osKernelLock();
+    Trace.stop = 1U;
+    (void)osKernelRestoreLock (lock);
+
+    hdr.magic     = SERIAL_TRACE_MAGIC;
+    hdr.tick_freq = osKernelGetTickFreq();
+
+    func ((const uint8_t *)&hdr, sizeof(hdr));
+
+    /* Trace ring wraps around, dump in up to two parts */
+    for (i = Trace.tail; i != Trace.head; i += cnt) {
+      k   = i & (MOD_EG915U_SERIAL_TRACE_SIZE - 1U);
+      cnt = MOD_EG915U_SERIAL_TRACE_SIZE - k;
+
+      if (cnt > (Trace.head - i)) {
+        cnt = Trace.head - i;
+      }
+
+      func (&TraceBuf[k], cnt);
+    }
+
+    rval = (int32_t)(sizeof(hdr) + (Trace.head - Trace.tail));
+
+    lock = osKernelLock();
+    Trace.stop = 0U;
+    (void)osKernelRestoreLock (lock);
+  }
+
+  return (rval);
+}
+#else
+/**
+  Dump serial trace (trace capture disabled).
+
+  \return -1
+*/
+int32_t Serial_TraceDump (SERIAL_TRACE_FUNC func) {
+  (void)func;
+
+  return (-1);
+}
+#endif
+
+
 /**
   Callback from the CMSIS USART driver
 */
 static void UART_Callback (uint32_t event) {
   int32_t stat;
-  uint32_t flags;
+  uint32_t flags, err;
 
   flags = 0U;
 
+  if (event & (ARM_USART_EVENT_RX_OVERFLOW      | ARM_USART_EVENT_RX_BREAK |
+               ARM_USART_EVENT_RX_FRAMING_ERROR | ARM_USART_EVENT_RX_PARITY_ERROR)) {
+    /* Received data lost or corrupted */
+    err = 0U;
+
+    if (event & ARM_USART_EVENT_RX_OVERFLOW) {
+      Stats.overrun++;
+      err |= SERIAL_RX_ERR_OVERRUN;
+    }
+    if (event & ARM_USART_EVENT_RX_FRAMING_ERROR) {
+      Stats.framing++;
+      err |= SERIAL_RX_ERR_FRAMING;
+    }
+    if (event & ARM_USART_EVENT_RX_PARITY_ERROR) {
+      Stats.parity++;
+      err |= SERIAL_RX_ERR_PARITY;
+    }
+    if (event & ARM_USART_EVENT_RX_BREAK) {
+      Stats.brk++;
+      err |= SERIAL_RX_ERR_BREAK;
+    }
+
+    (void)__atomic_fetch_or (&Com.rxe, err, __ATOMIC_RELAXED);
+
+    flags |= SERIAL_CB_RX_ERROR;
+  }
+
   if (event & (ARM_USART_EVENT_RX_TIMEOUT | ARM_USART_EVENT_RECEIVE_COMPLETE)) {
     flags |= SERIAL_CB_RX_DATA_AVAILABLE;
 
     if (event & ARM_USART_EVENT_RECEIVE_COMPLETE) {
+#if (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+      /* Block received, continue with the next queued block */
+      RxQ.act++;
+
+      stat = RxStart();
 
+      if (stat != ARM_DRIVER_OK) {
+        flags |= SERIAL_CB_RX_ERROR;
+      }
+#else
       /* Initiate new receive */
       stat = Com.drv->Receive (&RxBuf[0], SERIAL_RXBUF_SZ);
 
@@ -417,14 +1226,20 @@ static void UART_Callback (uint32_t event) {
 
       /* Increment counter of received bytes */
       Com.rxc += SERIAL_RXBUF_SZ;
+#endif
     }
   }
 
   if (event & ARM_USART_EVENT_SEND_COMPLETE) {
     flags |= SERIAL_CB_TX_DATA_COMPLETED;
 
-    /* Clear tx busy flag */
-    Com.txb = 0U;
+    /* Release transmit buffer space or caller buffer of the completed transfer */
+    TxQueueRelease (&TxQ);
+
+    /* Chain next queued transfer, clears tx busy flag when queue is empty */
+    if (TxStart() != ARM_DRIVER_OK) {
+      flags |= SERIAL_CB_TX_ERROR;
+    }
   }
 
   /* Send events */
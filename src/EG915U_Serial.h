@@ -27,6 +27,7 @@
 #define EG915U_SERIAL_H__
 
 #include <stdint.h>
+#include "BufList.h"
 
 /* Callback events */
 #define SERIAL_CB_RX_DATA_AVAILABLE    1U
@@ -34,6 +35,37 @@
 #define SERIAL_CB_RX_ERROR             4U
 #define SERIAL_CB_TX_ERROR             8U
 
+/* Receive errors (Serial_GetRxError) */
+#define SERIAL_RX_ERR_OVERRUN          1U  /* Received data lost       */
+#define SERIAL_RX_ERR_FRAMING          2U  /* Framing error            */
+#define SERIAL_RX_ERR_PARITY           4U  /* Parity error             */
+#define SERIAL_RX_ERR_BREAK            8U  /* Break detected           */
+
+/* Number of blocks queued for block receive (Serial_ReceiveBlock) */
+#ifndef SERIAL_RX_BLOCK_NUM
+#define SERIAL_RX_BLOCK_NUM            2U
+#endif
+
+/* Serial trace (Serial_TraceDump) */
+#define SERIAL_TRACE_MAGIC             0x43525453U /* "STRC" */
+#define SERIAL_TRACE_TX                0x8000U     /* Record direction flag (len_dir) */
+#define SERIAL_TRACE_LEN_MAX           0x7FFFU     /* Maximum record data length      */
+
+/* Serial trace header, starts the dump */
+typedef struct {
+  uint32_t magic;         /* SERIAL_TRACE_MAGIC                 */
+  uint32_t tick_freq;     /* Frequency of record time [Hz]      */
+} SERIAL_TRACE_HDR;
+
+/* Serial trace record, followed by record data */
+typedef struct {
+  uint16_t dt;            /* Ticks since previous record (saturated) */
+  uint16_t len_dir;       /* Data length | SERIAL_TRACE_TX           */
+} SERIAL_TRACE_REC;
+
+/* Serial trace dump function, called with consecutive parts of the trace */
+typedef void (*SERIAL_TRACE_FUNC) (const uint8_t *data, uint32_t len);
+
 /* Serial interface mode */
 typedef struct {
   uint32_t baudrate;      /* Configured baud rate */
@@ -43,13 +75,33 @@ typedef struct {
   uint8_t  flow_control;  /* 0:none, 1:RTS, 2:CTS, 3:RTS/CTS */
 } SERIAL_MODE;
 
+/* Serial receive error statistics */
+typedef struct {
+  uint32_t overrun;       /* Number of receive overruns       */
+  uint32_t framing;       /* Number of framing errors         */
+  uint32_t parity;        /* Number of parity errors          */
+  uint32_t brk;           /* Number of break conditions       */
+  uint32_t lost;          /* Number of received bytes dropped */
+} SERIAL_STATS;
+
 int32_t  Serial_Initialize (void);
 int32_t  Serial_Uninitialize (void);
 int32_t  Serial_GetMode (SERIAL_MODE *mode);
 int32_t  Serial_SetMode (SERIAL_MODE *mode);
 int32_t  Serial_SendBuf (const uint8_t *buf, uint32_t len);
+int32_t  Serial_SendSeg (const BUF_SEG *seg, uint32_t cnt);
+int32_t  Serial_SendBufNoCopy (const uint8_t *buf, uint32_t len);
+uint32_t Serial_GetTxPending (void);
+void     Serial_AbortSend (void);
 int32_t  Serial_ReadBuf(uint8_t *buf, uint32_t len);
 uint32_t Serial_GetRxCount(void);
+uint32_t Serial_GetRxError (void);
+int32_t  Serial_GetStats (SERIAL_STATS *stats);
+int32_t  Serial_TraceDump (SERIAL_TRACE_FUNC func);
+int32_t  Serial_ReceiveBlock (uint8_t *buf, uint32_t len);
+uint32_t Serial_GetRxBlockFree (void);
+uint32_t Serial_GetRxSpan (uint8_t **span);
+void     Serial_ReleaseRx (uint32_t num);
 uint32_t Serial_GetTxCount(void);
 uint32_t Serial_GetTxFree (void);
 
@@ -0,0 +1,196 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM
+ * -------------------------------------------------------------------------- */
+#include <string.h>
+
+#include "EG915U_SerialTx.h"
+
+/* Compiler barrier, descriptor is filled before it is published to the backend */
+#ifndef __COMPILER_BARRIER
+#define __COMPILER_BARRIER()  __asm volatile ("" ::: "memory")
+#endif
+
+/**
+  Initialize transmit queue.
+*/
+void TxQueueInit (SERIAL_TXQ *q, uint8_t *mem, uint32_t sz, SERIAL_TXDESC *desc, uint32_t num, uint32_t ext) {
+  q->mem  = mem;
+  q->sz   = sz;
+  q->desc = desc;
+  q->num  = num;
+  q->ext  = ext;
+
+  q->txi  = 0U;
+  q->txo  = 0U;
+  q->dput = 0U;
+  q->dget = 0U;
+
+  q->txx_put  = 0U;
+  q->txx_done = 0U;
+}
+
+/**
+  Drop all queued data.
+*/
+void TxQueueFlush (SERIAL_TXQ *q) {
+  q->txi  = q->txo;
+  q->dput = q->dget;
+
+  q->txx_put = q->txx_done;
+}
+
+/**
+  Copy data into transmit buffer and queue it, return number of bytes queued.
+*/
+uint32_t TxQueuePut (SERIAL_TXQ *q, const uint8_t *buf, uint32_t len) {
+  SERIAL_TXDESC *d;
+  uint32_t n, k, cnt;
+
+  n = 0U;
+
+  while ((n < len) && ((q->dput - q->dget) < q->num)) {
+    /* Free contiguous space in transmit buffer */
+    k   = q->txi & (q->sz - 1U);
+    cnt = q->sz - (q->txi - q->txo);
+
+    if (cnt > (q->sz - k)) {
+      cnt = q->sz - k;
+    }
+    if (cnt > (q->sz / 2U)) {
+      cnt = q->sz / 2U;
+    }
+    if (cnt > (len - n)) {
+      cnt = len - n;
+    }
+
+    if (cnt == 0U) {
+      /* Transmit buffer full */
+      break;
+    }
+
+    memcpy (&q->mem[k], &buf[n], cnt);
+
+    d = &q->desc[q->dput % q->num];
+
+    d->buf = &q->mem[k];
+    d->len = cnt;
+    d->ext = 0U;
+
+    q->txi += cnt;
+
+    __COMPILER_BARRIER();
+    q->dput++;
+
+    n += cnt;
+  }
+
+  return (n);
+}
+
+/**
+  Queue caller buffer in bounded transfers without copying, return number of bytes queued.
+*/
+uint32_t TxQueuePutExt (SERIAL_TXQ *q, const uint8_t *buf, uint32_t len) {
+  SERIAL_TXDESC *d;
+  uint32_t n, cnt;
+
+  n = 0U;
+
+  while ((n < len) && ((q->dput - q->dget) < q->num)) {
+    cnt = len - n;
+
+    if (cnt > q->ext) {
+      cnt = q->ext;
+    }
+
+    d = &q->desc[q->dput % q->num];
+
+    d->buf = &buf[n];
+    d->len = cnt;
+    d->ext = 1U;
+
+    q->txx_put += cnt;
+
+    __COMPILER_BARRIER();
+    q->dput++;
+
+    n += cnt;
+  }
+
+  return (n);
+}
+
+/**
+  Retrieve the oldest queued descriptor, NULL when queue is empty.
+*/
+SERIAL_TXDESC *TxQueuePeek (SERIAL_TXQ *q) {
+  SERIAL_TXDESC *d;
+
+  if (q->dget != q->dput) {
+    d = &q->desc[q->dget % q->num];
+  } else {
+    d = NULL;
+  }
+
+  return (d);
+}
+
+/**
+  Release transmit buffer space or caller buffer of the oldest descriptor.
+*/
+void TxQueueRelease (SERIAL_TXQ *q) {
+  SERIAL_TXDESC *d;
+
+  if (q->dget != q->dput) {
+    d = &q->desc[q->dget % q->num];
+
+    if (d->ext == 0U) {
+      q->txo += d->len;
+    } else {
+      q->txx_done += d->len;
+    }
+    q->dget++;
+  }
+}
+
+/**
+  Retrieve number of bytes free in transmit buffer.
+*/
+uint32_t TxQueueGetFree (SERIAL_TXQ *q) {
+  uint32_t n;
+
+  if ((q->dput - q->dget) == q->num) {
+    /* No free descriptor */
+    n = 0U;
+  } else {
+    n = q->sz - (q->txi - q->txo);
+  }
+
+  return (n);
+}
+
+/**
+  Retrieve number of bytes queued from caller buffers and not transmitted yet.
+*/
+uint32_t TxQueueGetPending (SERIAL_TXQ *q) {
+  return (q->txx_put - q->txx_done);
+}
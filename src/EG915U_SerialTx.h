@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM
+ * -------------------------------------------------------------------------- */
+
+#ifndef EG915U_SERIALTX_H__
+#define EG915U_SERIALTX_H__
+
+#include <stdint.h>
+
+/*
+  Transmit descriptor
+
+  Descriptors are queued by the thread and completed by the serial backend
+  (UART callback or I/O thread) in the order queued.
+*/
+typedef struct {
+  const uint8_t *buf;     /* Transfer data     */
+  uint32_t       len;     /* Transfer length   */
+  uint32_t       ext;     /* Caller owned data (not in transmit buffer) */
+} SERIAL_TXDESC;
+
+/*
+  Transmit queue
+
+  Data is either copied into the transmit buffer or queued from the caller
+  buffer. Indexes and counters are free running, thread owns txi, dput and
+  txx_put, the backend owns txo, dget and txx_done.
+*/
+typedef struct {
+  uint8_t          *mem;  /* Transmit buffer (power of two size) */
+  uint32_t          sz;   /* Transmit buffer size                */
+  SERIAL_TXDESC    *desc; /* Descriptor array                    */
+  uint32_t          num;  /* Number of descriptors               */
+  uint32_t          ext;  /* Max transfer size of a caller buffer descriptor */
+  volatile uint32_t txi;  /* Tx buffer index                     */
+  volatile uint32_t txo;  /* Tx buffer bytes released            */
+  volatile uint32_t dput; /* Tx descriptors queued               */
+  volatile uint32_t dget; /* Tx descriptors completed            */
+  volatile uint32_t txx_put;  /* Tx bytes queued from caller buffers    */
+  volatile uint32_t txx_done; /* Tx bytes completed from caller buffers */
+} SERIAL_TXQ;
+
+/**
+  Initialize transmit queue.
+
+  \param[in]  q       transmit queue
+  \param[in]  mem     transmit buffer, size must be a power of two
+  \param[in]  sz      transmit buffer size
+  \param[in]  desc    descriptor array
+  \param[in]  num     number of descriptors
+  \param[in]  ext     maximum transfer size of one caller buffer descriptor
+*/
+extern void TxQueueInit (SERIAL_TXQ *q, uint8_t *mem, uint32_t sz, SERIAL_TXDESC *desc, uint32_t num, uint32_t ext);
+
+/**
+  Drop all queued data.
+*/
+extern void TxQueueFlush (SERIAL_TXQ *q);
+
+/**
+  Copy data into transmit buffer and queue it.
+
+  One descriptor transfers at most half of the transmit buffer, the other
+  half remains free for queuing while the transfer is in progress.
+
+  \return number of bytes queued
+*/
+extern uint32_t TxQueuePut (SERIAL_TXQ *q, const uint8_t *buf, uint32_t len);
+
+/**
+  Queue caller buffer without copying, split into bounded transfers.
+
+  \return number of bytes queued
+*/
+extern uint32_t TxQueuePutExt (SERIAL_TXQ *q, const uint8_t *buf, uint32_t len);
+
+/**
+  Retrieve the oldest queued descriptor.
+
+  \return descriptor pointer or NULL when queue is empty
+*/
+extern SERIAL_TXDESC *TxQueuePeek (SERIAL_TXQ *q);
+
+/**
+  Release the oldest queued descriptor after its transfer completed.
+*/
+extern void TxQueueRelease (SERIAL_TXQ *q);
+
+/**
+  Retrieve number of bytes free in transmit buffer, 0 if no descriptor is free.
+*/
+extern uint32_t TxQueueGetFree (SERIAL_TXQ *q);
+
+/**
+  Retrieve number of bytes queued from caller buffers and not transmitted yet.
+*/
+extern uint32_t TxQueueGetPending (SERIAL_TXQ *q);
+
+#endif /* EG915U_SERIALTX_H__ */
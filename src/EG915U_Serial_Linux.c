@@ -0,0 +1,846 @@
+/* -----------------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Hussein zahaki. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * $Date:        5. April 2022
+ *
+ * Project:      GSM
+ * -------------------------------------------------------------------------- */
+
+/*
+  Linux serial backend
+
+  Implements the EG915U_Serial.h interface with termios on a tty device
+  (/dev/ttyUSB*, /dev/ttyACM*) or a pseudo terminal. Build this file instead
+  of EG915U_Serial.c, transmit queue is shared with it (EG915U_SerialTx.c).
+  Only the serial layer runs on Linux, the AT parser and modem driver still
+  require a CMSIS-RTOS2 implementation.
+
+  Device path is MOD_EG915U_SERIAL_DEVICE, it can be overridden at run time
+  with environment variable MOD_SERIAL_DEVICE (i.e. pty slave of a modem
+  simulator).
+
+  Device is opened non-blocking. I/O thread waits for the device with poll,
+  reads received data into RxBuf and writes queued transmit data, Serial_Cb
+  is called from the I/O thread.
+*/
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+#include "EG915U_Serial.h"
+#include "EG915U_SerialTx.h"
+
+#include "Modem_EG915U_Config.h"
+
+/* Serial device */
+#ifndef MOD_EG915U_SERIAL_DEVICE
+#define MOD_EG915U_SERIAL_DEVICE  "/dev/ttyUSB2"
+#endif
+
+/* Serial buffer sizes */
+#ifndef SERIAL_TXBUF_SZ
+#define SERIAL_TXBUF_SZ   4096
+#endif
+
+#if ((SERIAL_TXBUF_SZ & (SERIAL_TXBUF_SZ - 1)) != 0)
+#error "SERIAL_TXBUF_SZ must be a power of 2"
+#endif
+
+/* Number of transmit descriptors */
+#ifndef SERIAL_TXDESC_NUM
+#define SERIAL_TXDESC_NUM 8
+#endif
+
+/* Maximum transfer size of one caller buffer descriptor (Serial_SendBufNoCopy) */
+#ifndef SERIAL_TXEXT_SZ
+#define SERIAL_TXEXT_SZ   4096
+#endif
+
+#if (SERIAL_TXEXT_SZ > 65535)
+#error "SERIAL_TXEXT_SZ exceeds maximum driver transfer size"
+#endif
+
+#ifndef SERIAL_RXBUF_SZ
+#define SERIAL_RXBUF_SZ   4096
+#endif
+
+#if ((SERIAL_RXBUF_SZ & (SERIAL_RXBUF_SZ - 1)) != 0)
+#error "SERIAL_RXBUF_SZ must be a power of 2"
+#endif
+
+#if defined(MOD_EG915U_SERIAL_RX_BLOCK) && (MOD_EG915U_SERIAL_RX_BLOCK != 0)
+#error "Linux serial backend does not support receive into parser buffer blocks"
+#endif
+
+/* Poll interval [ms] while the device reports hang-up (pty peer closed) */
+#define SERIAL_HUP_POLL   100
+
+typedef struct {
+  int      fd;            /* Device file descriptor       */
+  int      wake[2];       /* I/O thread wake-up pipe      */
+  pthread_t thread;       /* I/O thread                   */
+  pthread_mutex_t mtx;    /* Serial state protection      */
+  SERIAL_MODE mode;       /* Current serial mode          */
+  uint32_t rxc;           /* Rx bytes received            */
+  uint32_t rxi;           /* Rx bytes read                */
+  uint32_t doff;          /* Bytes written from the current descriptor */
+  uint32_t rxe;           /* Rx error flags (SERIAL_RX_ERR_xxx)  */
+  struct serial_icounter_struct icnt; /* Last line error counters */
+  uint8_t  run;           /* I/O thread run flag          */
+  uint8_t  icnt_ok;       /* Line error counters supported */
+  uint8_t  r[2];          /* Reserved                     */
+} SERIAL_COM;
+
+static uint8_t RxBuf[SERIAL_RXBUF_SZ];
+static uint8_t TxBuf[SERIAL_TXBUF_SZ];
+
+/* Transmit queue, written by the caller and the I/O thread under the mutex */
+static SERIAL_TXDESC TxDesc[SERIAL_TXDESC_NUM];
+static SERIAL_TXQ    TxQ;
+
+static SERIAL_COM Com = { .fd = -1, .wake = { -1, -1 }, .mtx = PTHREAD_MUTEX_INITIALIZER };
+
+static SERIAL_STATS Stats;
+
+/* Convert baud rate to termios speed, 0 when not supported */
+static speed_t BaudToSpeed (uint32_t baudrate) {
+  speed_t sp;
+
+  switch (baudrate) {
+    case    9600U: sp =    B9600; break;
+    case   19200U: sp =   B19200; break;
+    case   38400U: sp =   B38400; break;
+    case   57600U: sp =   B57600; break;
+    case  115200U: sp =  B115200; break;
+    case  230400U: sp =  B230400; break;
+#ifdef B460800
+    case  460800U: sp =  B460800; break;
+#endif
+#ifdef B921600
+    case  921600U: sp =  B921600; break;
+#endif
+#ifdef B1000000
+    case 1000000U: sp = B1000000; break;
+#endif
+#ifdef B3000000
+    case 3000000U: sp = B3000000; break;
+#endif
+    default:       sp = 0;        break;
+  }
+
+  return (sp);
+}
+
+/* Apply serial mode to the device, 0:ok, -1:error */
+static int32_t TermSetup (const SERIAL_MODE *mode) {
+  struct termios tio;
+  speed_t sp;
+  int32_t rval;
+
+  rval = -1;
+  sp   = BaudToSpeed (mode->baudrate);
+
+  if ((sp != 0) && (tcgetattr (Com.fd, &tio) == 0)) {
+    cfmakeraw (&tio);
+
+    tio.c_cflag |= CLOCAL | CREAD;
+
+    tio.c_cflag &= ~CSIZE;
+    if      (mode->databits == 5U) { tio.c_cflag |= CS5; }
+    else if (mode->databits == 6U) { tio.c_cflag |= CS6; }
+    else if (mode->databits == 7U) { tio.c_cflag |= CS7; }
+    else                           { tio.c_cflag |= CS8; }
+
+    if (mode->stopbits == 2U) { tio.c_cflag |=  CSTOPB; }
+    else                      { tio.c_cflag &= ~CSTOPB; }
+
+    tio.c_cflag &= ~(PARENB | PARODD);
+    if      (mode->parity == 1U) { tio.c_cflag |= PARENB | PARODD; }
+    else if (mode->parity == 2U) { tio.c_cflag |= PARENB;          }
+
+    /* termios supports RTS/CTS only in pairs */
+    if (mode->flow_control == 3U) { tio.c_cflag |=  CRTSCTS; }
+    else                          { tio.c_cflag &= ~CRTSCTS; }
+
+    /* Reads never block, device is polled by the I/O thread */
+    tio.c_cc[VMIN]  = 0;
+    tio.c_cc[VTIME] = 0;
+
+    cfsetispeed (&tio, sp);
+    cfsetospeed (&tio, sp);
+
+    if (tcsetattr (Com.fd, TCSANOW, &tio) == 0) {
+      rval = 0;
+    }
+  }
+
+  return (rval);
+}
+
+/* Wake-up the I/O thread */
+static void IoKick (void) {
+  uint8_t b = 0U;
+
+  (void)write (Com.wake[1], &b, 1U);
+}
+
+/* Write queued transmit data, return SERIAL_CB_TX_xxx events. Mutex must be locked. */
+static uint32_t TxWrite (void) {
+  SERIAL_TXDESC *d;
+  ssize_t n;
+  uint32_t flags;
+
+  flags = 0U;
+
+  while ((d = TxQueuePeek (&TxQ)) != NULL) {
+    n = write (Com.fd, &d->buf[Com.doff], d->len - Com.doff);
+
+    if (n < 0) {
+      if ((errno != EAGAIN) && (errno != EINTR)) {
+        flags |= SERIAL_CB_TX_ERROR;
+      }
+      break;
+    }
+
+    Com.doff += (uint32_t)n;
+
+    if (Com.doff < d->len) {
+      /* Device buffer full, continue when writable */
+      break;
+    }
+
+    /* Release transmit buffer space or caller buffer of the completed transfer */
+    TxQueueRelease (&TxQ);
+    Com.doff = 0U;
+
+    flags |= SERIAL_CB_TX_DATA_COMPLETED;
+  }
+
+  return (flags);
+}
+
+/* Read available data into receive buffer, return SERIAL_CB_RX_xxx events. Mutex must be locked. */
+static uint32_t RxRead (void) {
+  ssize_t n;
+  uint32_t k, cnt, flags;
+
+  flags = 0U;
+
+  while ((Com.rxc - Com.rxi) < SERIAL_RXBUF_SZ) {
+    /* Free contiguous space in receive buffer */
+    k   = Com.rxc & (SERIAL_RXBUF_SZ - 1U);
+    cnt = SERIAL_RXBUF_SZ - (Com.rxc - Com.rxi);
+
+    if (cnt > (SERIAL_RXBUF_SZ - k)) {
+      cnt = SERIAL_RXBUF_SZ - k;
+    }
+
+    n = read (Com.fd, &RxBuf[k], cnt);
+
+    if (n <= 0) {
+      if ((n < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+        flags |= SERIAL_CB_RX_ERROR;
+      }
+      break;
+    }
+
+    Com.rxc += (uint32_t)n;
+
+    flags |= SERIAL_CB_RX_DATA_AVAILABLE;
+  }
+
+  return (flags);
+}
+
+/* Account line errors reported by the UART driver, return SERIAL_CB_RX_ERROR on new errors */
+static uint32_t RxLineErrors (void) {
+  struct serial_icounter_struct ic;
+  uint32_t err, flags;
+
+  flags = 0U;
+
+  if ((Com.icnt_ok != 0U) && (ioctl (Com.fd, TIOCGICOUNT, &ic) == 0)) {
+    err = 0U;
+
+    if (ic.overrun != Com.icnt.overrun) {
+      Stats.overrun += (uint32_t)(ic.overrun - Com.icnt.overrun);
+      err |= SERIAL_RX_ERR_OVERRUN;
+    }
+    if (ic.buf_overrun != Com.icnt.buf_overrun) {
+      Stats.overrun += (uint32_t)(ic.buf_overrun - Com.icnt.buf_overrun);
+      err |= SERIAL_RX_ERR_OVERRUN;
+    }
+    if (ic.frame != Com.icnt.frame) {
+      Stats.framing += (uint32_t)(ic.frame - Com.icnt.frame);
+      err |= SERIAL_RX_ERR_FRAMING;
+    }
+    if (ic.parity != Com.icnt.parity) {
+      Stats.parity += (uint32_t)(ic.parity - Com.icnt.parity);
+      err |= SERIAL_RX_ERR_PARITY;
+    }
+    if (ic.brk != Com.icnt.brk) {
+      Stats.brk += (uint32_t)(ic.brk - Com.icnt.brk);
+      err |= SERIAL_RX_ERR_BREAK;
+    }
+
+    Com.icnt = ic;
+
+    if (err != 0U) {
+      Com.rxe |= err;
+      flags   |= SERIAL_CB_RX_ERROR;
+    }
+  }
+
+  return (flags);
+}
+
+/**
+  Serial I/O thread.
+*/
+static void *IoThread (void *arg) {
+  struct pollfd pfd[2];
+  uint8_t drain[16];
+  uint32_t flags;
+  int tout;
+
+  (void)arg;
+
+  tout = -1;
+
+  while (Com.run != 0U) {
+    pthread_mutex_lock (&Com.mtx);
+
+    pfd[0].fd      = Com.fd;
+    pfd[0].events  = 0;
+    pfd[0].revents = 0;
+
+    if ((Com.rxc - Com.rxi) < SERIAL_RXBUF_SZ) {
+      /* Receive buffer not full (device buffers data otherwise) */
+      pfd[0].events |= POLLIN;
+    }
+    if (TxQueuePeek (&TxQ) != NULL) {
+      /* Transmit data queued */
+      pfd[0].events |= POLLOUT;
+    }
+
+    pthread_mutex_unlock (&Com.mtx);
+
+    if (tout > 0) {
+      /* Device hang-up, do not spin on it */
+      pfd[0].fd = -1;
+    }
+
+    pfd[1].fd      = Com.wake[0];
+    pfd[1].events  = POLLIN;
+    pfd[1].revents = 0;
+
+    if (poll (pfd, 2U, tout) < 0) {
+      continue;
+    }
+
+    if (pfd[1].revents & POLLIN) {
+      /* Woken-up by the send or read functions */
+      while (read (Com.wake[0], drain, sizeof(drain)) > 0);
+    }
+
+    tout  = -1;
+    flags = 0U;
+
+    pthread_mutex_lock (&Com.mtx);
+
+    if (pfd[0].revents & (POLLIN | POLLERR)) {
+      flags |= RxRead();
+      flags |= RxLineErrors();
+    }
+
+    if ((pfd[0].revents & POLLHUP) && ((flags & SERIAL_CB_RX_DATA_AVAILABLE) == 0U)) {
+      /* No peer on the pty or device removed */
+      tout = SERIAL_HUP_POLL;
+    }
+
+    if (TxQueuePeek (&TxQ) != NULL) {
+      flags |= TxWrite();
+    }
+
+    pthread_mutex_unlock (&Com.mtx);
+
+    if (flags != 0U) {
+      /* Send events */
+      Serial_Cb (flags);
+    }
+  }
+
+  return (NULL);
+}
+
+/**
+  Initialize serial interface.
+
+  \return 1:ok (event driven), negative value on error
+*/
+int32_t Serial_Initialize (void) {
+  const char *dev;
+  int32_t stat;
+
+  stat = 1;
+
+  dev = getenv ("MOD_SERIAL_DEVICE");
+
+  if (dev == NULL) {
+    dev = MOD_EG915U_SERIAL_DEVICE;
+  }
+
+  pthread_mutex_lock (&Com.mtx);
+
+  Com.rxc  = 0U;
+  Com.rxi  = 0U;
+  Com.doff = 0U;
+  Com.rxe  = 0U;
+
+  TxQueueInit (&TxQ, TxBuf, SERIAL_TXBUF_SZ, TxDesc, SERIAL_TXDESC_NUM, SERIAL_TXEXT_SZ);
+
+  memset (&Stats, 0x00, sizeof(Stats));
+
+  /* Setup standard UART mode: 8 bits, no parity, 1 stop bit, no flow control */
+  Com.mode.baudrate     = 115200U;
+  Com.mode.databits     = 8U;
+  Com.mode.stopbits     = 1U;
+  Com.mode.parity       = 0U;
+  Com.mode.flow_control = 0U;
+
+  Com.fd = open (dev, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+  if (Com.fd < 0) {
+    /* Device open failed */
+    stat = -1;
+  }
+  else if (TermSetup (&Com.mode) != 0) {
+    /* Device mode configuration failed */
+    stat = -3;
+  }
+  else if (pipe2 (Com.wake, O_NONBLOCK | O_CLOEXEC) != 0) {
+    /* I/O thread wake-up pipe not created */
+    stat = -5;
+  }
+  else {
+    /* Discard data received before initialization */
+    tcflush (Com.fd, TCIOFLUSH);
+
+    /* Line error counters are provided only by UART drivers */
+    Com.icnt_ok = (ioctl (Com.fd, TIOCGICOUNT, &Com.icnt) == 0) ? 1U : 0U;
+
+    Com.run = 1U;
+
+    if (pthread_create (&Com.thread, NULL, IoThread, NULL) != 0) {
+      /* I/O thread not created */
+      Com.run = 0U;
+      stat = -6;
+    }
+  }
+
+  pthread_mutex_unlock (&Com.mtx);
+
+  if (stat < 0) {
+    (void)Serial_Uninitialize();
+  }
+
+  return (stat);
+}
+
+
+/**
+  Uninitialize serial interface.
+
+  \return 0:ok
+*/
+int32_t Serial_Uninitialize (void) {
+
+  if (Com.run != 0U) {
+    /* Stop I/O thread */
+    Com.run = 0U;
+
+    IoKick();
+
+    pthread_join (Com.thread, NULL);
+  }
+
+  if (Com.wake[0] >= 0) {
+    close (Com.wake[0]);
+    close (Com.wake[1]);
+
+    Com.wake[0] = -1;
+    Com.wake[1] = -1;
+  }
+
+  if (Com.fd >= 0) {
+    close (Com.fd);
+
+    Com.fd = -1;
+  }
+
+  return (0);
+}
+
+int32_t Serial_GetMode (SERIAL_MODE *mode) {
+  int32_t err;
+
+  err = 1;
+
+  if (mode != NULL) {
+    *mode = Com.mode;
+
+    err = 0;
+  }
+
+  return (err);
+}
+
+
+int32_t Serial_SetMode (SERIAL_MODE *mode) {
+  int32_t err;
+
+  err = 1;
+
+  if (mode != NULL) {
+    pthread_mutex_lock (&Com.mtx);
+
+    /* Abort current send operation, drop queued and unread data */
+    tcflush (Com.fd, TCIOFLUSH);
+
+    Com.rxi  = Com.rxc;
+    Com.doff = 0U;
+
+    TxQueueFlush (&TxQ);
+
+    if (TermSetup (mode) == 0) {
+      /* Update mode */
+      Com.mode = *mode;
+
+      err = 0;
+    }
+
+    pthread_mutex_unlock (&Com.mtx);
+  }
+
+  return (err);
+}
+
+/* Write queued data without blocking, remaining data is written by the I/O thread. Mutex must be locked. */
+static uint32_t TxKick (void) {
+  uint32_t flags;
+
+  flags = TxWrite();
+
+  if (TxQueuePeek (&TxQ) != NULL) {
+    /* Device buffer full, I/O thread waits until writable */
+    IoKick();
+  }
+
+  return (flags);
+}
+
+/**
+  Get number of bytes free in transmit buffer.
+
+  \return number of bytes
+*/
+uint32_t Serial_GetTxFree (void) {
+  uint32_t n;
+
+  pthread_mutex_lock (&Com.mtx);
+  n = TxQueueGetFree (&TxQ);
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (n);
+}
+
+
+/**
+  Try to send len of characters from the specified buffer.
+
+  \return number of bytes actually sent or -1 in case of error
+*/
+int32_t Serial_SendBuf (const uint8_t *buf, uint32_t len) {
+  uint32_t cnt, flags;
+  int32_t  n;
+
+  pthread_mutex_lock (&Com.mtx);
+
+  cnt   = TxQueuePut (&TxQ, buf, len);
+  flags = TxKick();
+
+  pthread_mutex_unlock (&Com.mtx);
+
+  if (flags & SERIAL_CB_TX_ERROR) {
+    n = -1;
+  } else {
+    n = (int32_t)cnt;
+  }
+
+  if (flags != 0U) {
+    Serial_Cb (flags);
+  }
+
+  return n;
+}
+
+
+/**
+  Send len characters directly from the specified buffer.
+
+  Buffer is split into transfers of at most SERIAL_TXEXT_SZ bytes, less than
+  len bytes are queued when transmit descriptors run out.
+  Buffer must not be modified until Serial_GetTxPending returns 0.
+
+  \return number of bytes queued or -1 in case of error
+*/
+int32_t Serial_SendBufNoCopy (const uint8_t *buf, uint32_t len) {
+  uint32_t flags;
+  int32_t  n;
+
+  pthread_mutex_lock (&Com.mtx);
+
+  n = (int32_t)TxQueuePutExt (&TxQ, buf, len);
+
+  flags = TxKick();
+
+  pthread_mutex_unlock (&Com.mtx);
+
+  if (flags & SERIAL_CB_TX_ERROR) {
+    n = -1;
+  }
+
+  if (flags != 0U) {
+    Serial_Cb (flags);
+  }
+
+  return n;
+}
+
+
+/**
+  Get number of bytes queued with Serial_SendBufNoCopy and not transmitted yet.
+*/
+uint32_t Serial_GetTxPending (void) {
+  uint32_t n;
+
+  pthread_mutex_lock (&Com.mtx);
+  n = TxQueueGetPending (&TxQ);
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (n);
+}
+
+
+/**
+  Abort current send operation and drop all queued data.
+*/
+void Serial_AbortSend (void) {
+
+  pthread_mutex_lock (&Com.mtx);
+
+  tcflush (Com.fd, TCOFLUSH);
+
+  TxQueueFlush (&TxQ);
+  Com.doff = 0U;
+
+  pthread_mutex_unlock (&Com.mtx);
+}
+
+
+/**
+  Try to send data described by cnt segments.
+
+  \return number of bytes actually sent or -1 in case of error
+*/
+int32_t Serial_SendSeg (const BUF_SEG *seg, uint32_t cnt) {
+  uint32_t i, len, sz, flags;
+  int32_t  n;
+
+  sz    = 0U;
+  flags = 0U;
+
+  pthread_mutex_lock (&Com.mtx);
+
+  for (i = 0U; i < cnt; i++) {
+    len = TxQueuePut (&TxQ, seg[i].buf, seg[i].len);
+
+    sz += len;
+
+    if (len != seg[i].len) {
+      /* Transmit buffer full */
+      break;
+    }
+  }
+
+  if (sz != 0U) {
+    flags = TxKick();
+  }
+
+  pthread_mutex_unlock (&Com.mtx);
+
+  if (flags & SERIAL_CB_TX_ERROR) {
+    n = -1;
+  } else {
+    n = (int32_t)sz;
+  }
+
+  if (flags != 0U) {
+    Serial_Cb (flags);
+  }
+
+  return n;
+}
+
+
+/**
+  Read len characters from the serial receive buffer and put them into buffer buf.
+
+  \return number of characters read
+*/
+int32_t Serial_ReadBuf (uint8_t *buf, uint32_t len) {
+  uint32_t n, k, cnt;
+  uint8_t  full;
+
+  pthread_mutex_lock (&Com.mtx);
+
+  n    = Com.rxc - Com.rxi;
+  full = (n == SERIAL_RXBUF_SZ) ? 1U : 0U;
+
+  if (n > len) {
+    n = len;
+  }
+
+  /* Copy in up to two parts, receive buffer wraps around */
+  k   = Com.rxi & (SERIAL_RXBUF_SZ - 1U);
+  cnt = SERIAL_RXBUF_SZ - k;
+
+  if (cnt > n) {
+    cnt = n;
+  }
+
+  memcpy (&buf[0],   &RxBuf[k], cnt);
+  memcpy (&buf[cnt], &RxBuf[0], n - cnt);
+
+  Com.rxi += n;
+
+  if ((full != 0U) && (n != 0U)) {
+    /* I/O thread stopped reading the device, resume */
+    IoKick();
+  }
+
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (int32_t)n;
+}
+
+
+/**
+  Retrieve total number of bytes to read
+*/
+uint32_t Serial_GetRxCount (void) {
+  uint32_t n;
+
+  pthread_mutex_lock (&Com.mtx);
+  n = Com.rxc - Com.rxi;
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (n);
+}
+
+
+/**
+  Retrieve and clear receive errors detected since the last call.
+
+  \return receive error flags (SERIAL_RX_ERR_xxx)
+*/
+uint32_t Serial_GetRxError (void) {
+  uint32_t err;
+
+  pthread_mutex_lock (&Com.mtx);
+  err = Com.rxe;
+  Com.rxe = 0U;
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (err);
+}
+
+
+/**
+  Retrieve serial receive error statistics.
+
+  \param[out] stats  statistics counters
+  \return 0:ok, -1:invalid parameter
+*/
+int32_t Serial_GetStats (SERIAL_STATS *stats) {
+  int32_t rval;
+
+  if (stats == NULL) {
+    rval = -1;
+  }
+  else {
+    pthread_mutex_lock (&Com.mtx);
+    *stats = Stats;
+    pthread_mutex_unlock (&Com.mtx);
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+
+uint32_t Serial_GetTxCount (void) {
+  uint32_t n;
+
+  pthread_mutex_lock (&Com.mtx);
+  n = Com.doff;
+  pthread_mutex_unlock (&Com.mtx);
+
+  return (n);
+}
+
+
+/**
+  Dump serial trace (not supported, capture traffic with the host tools).
+
+  \return -1
+*/
+int32_t Serial_TraceDump (SERIAL_TRACE_FUNC func) {
+  (void)func;
+
+  return (-1);
+}
+
+
+/**
+  Event callback.
+*/
+__attribute__((weak)) void Serial_Cb (uint32_t event) {
+  (void)event;
+}
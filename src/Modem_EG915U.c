@@ -71,15 +71,17 @@ void AT_Notify (uint32_t event, void *arg) {
   uint32_t temp_len = 0;
   static uint8_t  rx_sock = 0;
   static uint32_t rx_num = 0;
+  static uint32_t rx_size = 0;
   uint8_t rx_flush_flg = 0;
 
   uint32_t *u32;
+  uintptr_t *uptr;
   uint8_t mac[6];
   int32_t ex;
   uint8_t  n;
   uint32_t conn_id, len;
-	int32_t buffer;
-  uint32_t addr;
+  uint8_t *span;
+  uintptr_t addr;
   AT_DATA_LINK_CONN conn;
   MOD_SOCKET *sock;
   uint32_t stat;
@@ -97,10 +99,58 @@ void AT_Notify (uint32_t event, void *arg) {
     osEventFlagsSet (pCtrl->evflags_id, MOD_WAIT_RESP_GENERIC);
 
   }
+  else if (event == AT_NOTIFY_RX_ERROR) {
+    /* Response may be lost, fail command in progress (AT_RESP_RX_ERROR) */
+    if (pCtrl->wait_gen != 0U) {
+      osEventFlagsSet (pCtrl->evflags_id, MOD_WAIT_RESP_GENERIC);
+    }
+
+    stat = (uint32_t)*(uintptr_t *)arg;
+
+    if (stat == AT_STATE_RECV_DATA) {
+      if (rx_sock != SOCKET_INVALID) {
+        /* Packet is incomplete, set header to the number of bytes received */
+        sock = &Socket[rx_sock];
+        len  = rx_size - rx_num;
+
+        /* Packet is not read before it is complete, header is still buffered */
+        BufBegin (&sock->mem);
+
+        addr = BufGetCount (&sock->mem) - (len + 2U);
+
+        for (n = 0U; n < 2U; n++) {
+          if (BufPeekSpanUnlocked ((uint32_t)addr + n, &span, &sock->mem) != 0U) {
+            *span = ((uint8_t *)&len)[n];
+          }
+        }
+
+        BufEnd (&sock->mem);
+
+        osEventFlagsSet (pCtrl->evflags_id, MOD_WAIT_RX_DONE(rx_sock));
+      }
+
+      /* Receive ended */
+      rx_sock = SOCKET_INVALID;
+      rx_num  = 0U;
+    }
+    else if (stat == AT_STATE_RESP_HTTP_CONTENT) {
+      /* HTTP content is incomplete, abort the read in progress */
+      for (n = 0U; n < MOD_PDPSOCKET_NUM; n++) {
+        if (PDPSocket[n].state == SOCKET_STATE_CONNECTED) {
+          osEventFlagsSet (PDPSocket[n].evflags_id, SOCK_WAIT_HTTP_RESP_ABORT);
+          break;
+        }
+      }
+
+      /* Restart with the first content buffer */
+      rx_sock = 0U;
+      rx_num  = 0U;
+    }
+  }
   else if (event == AT_NOTIFY_HTTP_CONTENT ) {
-    u32 = (uint32_t *)arg;
-    addr = *u32;
-    *(uint32_t *)arg = 1; // true means continue current state
+    uptr = (uintptr_t *)arg;
+    addr = *uptr;
+    *uptr = 1; // true means continue current state
 
     /* Find socket */
     for (n = 0U; n < MOD_SOCKET_NUM; n++) {
@@ -141,7 +191,7 @@ void AT_Notify (uint32_t event, void *arg) {
               temp_len = sock->rx_len - sock->tout_rx; 
             }
 
-						temp_len = (uint32_t)BufRead ((uint8_t *)sock->rx_mem[rx_sock] + rx_num, 
+						temp_len = (uint32_t)AT_MemRead ((uint8_t *)sock->rx_mem[rx_sock] + rx_num, 
                                                 temp_len, 
                                                 &(((AT_PARSER_HANDLE *)addr)->mem));
 
@@ -151,12 +201,19 @@ void AT_Notify (uint32_t event, void *arg) {
             switch(rx_flush_flg){
               case RX_FLUSH_FULL:
 
-                for(;sock->tout_rx < sock->rx_len; sock->tout_rx++, rx_num++){
-                  buffer = (uint32_t)BufPeekByte (&(((AT_PARSER_HANDLE *)addr)->mem));
-                  if(buffer < 0){
+                /* Copy remaining content in contiguous runs */
+                while(sock->tout_rx < sock->rx_len){
+                  len = AT_MemGetReadSpan (&span, &(((AT_PARSER_HANDLE *)addr)->mem));
+                  if(len == 0){
                     break;
                   }
-                  ((uint8_t *)sock->rx_mem[rx_sock])[rx_num] = buffer;
+                  if(len > (sock->rx_len - sock->tout_rx)){
+                    len = sock->rx_len - sock->tout_rx;
+                  }
+                  memcpy ((uint8_t *)sock->rx_mem[rx_sock] + rx_num, span, len);
+                  AT_MemConsume (len, &(((AT_PARSER_HANDLE *)addr)->mem));
+                  sock->tout_rx += len;
+                  rx_num += len;
                 }
                 
               case RX_FLUSH_PARTIAL:   
@@ -176,7 +233,7 @@ void AT_Notify (uint32_t event, void *arg) {
                 //                         /*current data size*/rx_num);
                 if(sock->tout_rx >= sock->rx_len){
                   osEventFlagsSet (sock->evflags_id, SOCK_WAIT_HTTP_RESP_COMPLETE);
-                  *(uint32_t *)arg = 0; // true means continue current state
+                  *uptr = 0; // true means continue current state
                 }
                 else{
                   osEventFlagsSet (sock->evflags_id, SOCK_WAIT_HTTP_RESP_PARTIAL);                                        
@@ -193,10 +250,10 @@ void AT_Notify (uint32_t event, void *arg) {
               rx_flush_flg = RX_FLUSH_FULL; 
               temp_len = sock->rx_len - sock->tout_rx; 
             }
-            sock->tout_rx += (uint32_t)BufRead ((uint8_t *)sock->rx_mem[0] + sock->tout_rx, temp_len, &(((AT_PARSER_HANDLE *)addr)->mem));
+            sock->tout_rx += (uint32_t)AT_MemRead ((uint8_t *)sock->rx_mem[0] + sock->tout_rx, temp_len, &(((AT_PARSER_HANDLE *)addr)->mem));
             
             if(rx_flush_flg && (sock->rx_len == sock->tout_rx)){
-              *(uint32_t *)arg = 0; // true means continue current state
+              *uptr = 0; // true means continue current state
 							osEventFlagsSet (sock->evflags_id, SOCK_WAIT_HTTP_RESP_COMPLETE);
 						}
           }
@@ -233,45 +290,54 @@ void AT_Notify (uint32_t event, void *arg) {
         /* Found corresponding socket */
         sock = &Socket[n];
 
+        /* Check space and write header under a single lock */
+        BufBegin (&sock->mem);
+
         /* Check if there is enough memory to receive incomming packet */
-        rx_num = BufGetFree(&sock->mem);
+        rx_num = BufGetFreeUnlocked (&sock->mem);
 
         if (rx_num >= (len + 2U)) {
           /* Enough space, remember receiving socket */
           rx_sock = n;
 
           /* Set packet header (16-bit size) */
-          BufWrite ((uint8_t *)&len, 2U, &sock->mem);
+          BufWriteUnlocked ((uint8_t *)&len, 2U, &sock->mem);
 
           /* Return number of bytes to receive */
           *u32 = len;
         }
+
+        BufEnd (&sock->mem);
       }
       
       /* Set number of bytes to copy (or dump) */
-      rx_num = len;
+      rx_num  = len;
+      rx_size = len;
     }
   }
   else if (event == AT_NOTIFY_CONNECTION_RX_DATA) {
     /* Read source buffer address */
-    u32 = (uint32_t *)arg;
-    addr = *u32;
+    uptr = (uintptr_t *)arg;
+    addr = *uptr;
 
     /* Copy received data */
     if (rx_sock != SOCKET_INVALID) {
       sock = &Socket[rx_sock];
 
       /* Copy data */
-      len = BufCopy (&sock->mem, (BUF_LIST *)addr, rx_num);
+      len = AT_MemCopy (&sock->mem, (AT_PARSER_MEM *)addr, rx_num);
     }
     else {
-      len = BufFlush (rx_num, (BUF_LIST *)addr);
+      len = AT_MemFlush (rx_num, (AT_PARSER_MEM *)addr);
+
+      /* Account dropped socket data */
+      Modem_PoolDrop (MOD_POOL_SOCKET, len);
     }
 
     rx_num -= len;
 
     /* Return number of bytes left to receive */
-    *u32 = rx_num;
+    *uptr = rx_num;
 
     if (rx_sock != SOCKET_INVALID) {
       /* All data received? */
@@ -425,44 +491,7 @@ void AT_Notify (uint32_t event, void *arg) {
     ex = AT_Resp_CtrlConn (&conn_id);
 
     if (ex == 0) {
-      /* Set connection id as free */
-      ConnId_Free (conn_id);
-
-      /* Find corresponding socket and change its state */
-      for (n = 0U; n < MOD_SOCKET_NUM; n++) {
-        if (Socket[n].conn_id == conn_id) {
-          /* Correct connection id found */
-          Socket[n].conn_id = CONN_ID_INVALID;
-
-          if (Socket[n].backlog == SOCKET_INVALID) {
-            /* This is client socket */
-            if (Socket[n].state == SOCKET_STATE_CLOSING) {
-              /* Connection close initiated in SocketClose */
-              Socket[n].state = SOCKET_STATE_FREE;
-            } else {
-              /* Remote peer closed the connection */
-              Socket[n].state = SOCKET_STATE_CLOSED;
-            }
-          } else {
-            if (Socket[n].state == SOCKET_STATE_CLOSING ||
-              (Socket[n].state == SOCKET_STATE_CONNECTED && !Socket[n].accepted))
-            {
-              /* Connection close initiated in SocketClose */
-              /* Listening socket, set state back to listen */
-              Socket[n].state = SOCKET_STATE_LISTEN;
-            } else {
-              /* Remote peer closed the connection */
-              Socket[n].state = SOCKET_STATE_CLOSED;
-            }
-          }
-          break;
-        }
-      }
-
-      if (n != MOD_SOCKET_NUM) {
-        /* Set event */
-        osEventFlagsSet (pCtrl->evflags_id, MOD_WAIT_CONN_CLOSE(n));
-      }
+      Socket_ConnClosed (conn_id);
     }
   }
   else if (event == AT_NOTIFY_STATION_CONNECTED) {
@@ -518,6 +547,113 @@ void AT_Notify (uint32_t event, void *arg) {
 }
 
 
+/**
+  Update socket state when network connection is closed.
+
+  \param[in]  conn_id  Connection id
+*/
+static void Socket_ConnClosed (uint32_t conn_id) {
+  uint32_t n;
+
+  /* Set connection id as free */
+  ConnId_Free (conn_id);
+
+  /* Find corresponding socket and change its state */
+  for (n = 0U; n < MOD_SOCKET_NUM; n++) {
+    if (Socket[n].conn_id == conn_id) {
+      /* Correct connection id found */
+      Socket[n].conn_id = CONN_ID_INVALID;
+
+      if (Socket[n].backlog == SOCKET_INVALID) {
+        /* This is client socket */
+        if (Socket[n].state == SOCKET_STATE_CLOSING) {
+          /* Connection close initiated in SocketClose */
+          Socket[n].state = SOCKET_STATE_FREE;
+        } else {
+          /* Remote peer closed the connection */
+          Socket[n].state = SOCKET_STATE_CLOSED;
+        }
+      } else {
+        if (Socket[n].state == SOCKET_STATE_CLOSING ||
+          (Socket[n].state == SOCKET_STATE_CONNECTED && !Socket[n].accepted))
+        {
+          /* Connection close initiated in SocketClose */
+          /* Listening socket, set state back to listen */
+          Socket[n].state = SOCKET_STATE_LISTEN;
+        } else {
+          /* Remote peer closed the connection */
+          Socket[n].state = SOCKET_STATE_CLOSED;
+        }
+      }
+      break;
+    }
+  }
+
+  if (n != MOD_SOCKET_NUM) {
+    /* Set event */
+    osEventFlagsSet (pCtrl->evflags_id, MOD_WAIT_CONN_CLOSE(n));
+  }
+}
+
+
+/**
+  +QIURC unsolicited result code handler.
+
+  Handles "closed",<connectID> and "pdpdeact",<contextID> reports.
+
+  \param[in]  urc   Received URC
+  \param[in]  arg   Subscription argument (not used)
+*/
+static void Urc_QIURC (const AT_URC *urc, void *arg) {
+  int32_t  id;
+  uint32_t n;
+
+  (void)arg;
+
+  if ((urc->argc >= 2U) && (AT_Urc_ArgInt (urc, 1U, &id) == 0)) {
+    if ((urc->argl[0] == 6U) && (memcmp (urc->argv[0], "closed", 6U) == 0)) {
+      if ((id >= 0) && (id < CONN_ID_INVALID)) {
+        /* Remote peer closed the connection */
+        Socket_ConnClosed ((uint32_t)id);
+      }
+    }
+    else if ((urc->argl[0] == 8U) && (memcmp (urc->argv[0], "pdpdeact", 8U) == 0)) {
+      /* Network deactivated the PDP context */
+      pCtrl->flags &= ~MOD_FLAGS_STATION_GOT_IP;
+
+      for (n = 0U; n < MOD_PDPSOCKET_NUM; n++) {
+        if ((PDPSocket[n].state != SOCKET_STATE_FREE) && (PDPSocket[n].conn_id == (uint32_t)id)) {
+          PDPSocket[n].state = SOCKET_STATE_CLOSED;
+        }
+      }
+    }
+  }
+}
+
+
+/**
+  +CEREG unsolicited result code handler.
+
+  Network registration status <stat> is 1 (home network) or 5 (roaming) when registered.
+
+  \param[in]  urc   Received URC
+  \param[in]  arg   Subscription argument (not used)
+*/
+static void Urc_CEREG (const AT_URC *urc, void *arg) {
+  int32_t stat;
+
+  (void)arg;
+
+  if (AT_Urc_ArgInt (urc, 0U, &stat) == 0) {
+    if ((stat == 1) || (stat == 5)) {
+      pCtrl->flags |= MOD_FLAGS_STATION_CONNECTED;
+    } else {
+      pCtrl->flags &= ~(MOD_FLAGS_STATION_CONNECTED | MOD_FLAGS_STATION_GOT_IP);
+    }
+  }
+}
+
+
 /**
   Wait for response with timeout.
 
@@ -526,7 +662,7 @@ void AT_Notify (uint32_t event, void *arg) {
            0: response arrived
 */
 static int32_t Modem_Wait (uint32_t event, uint32_t timeout) {
-  int32_t rval;
+  int32_t rval, lock;
   uint32_t flags;
 
   if (timeout == 0U) {
@@ -534,8 +670,25 @@ static int32_t Modem_Wait (uint32_t event, uint32_t timeout) {
     timeout = osWaitForever;
   }
 
+  /* Response pending, Modem thread pools serial interface until it arrives */
+  lock = osKernelLock();
+  pCtrl->wait_cnt++;
+  if (event & MOD_WAIT_RESP_GENERIC) {
+    pCtrl->wait_gen++;
+  }
+  (void)osKernelRestoreLock (lock);
+
+  Modem_ThreadKick();
+
   flags = osEventFlagsWait (pCtrl->evflags_id, event, osFlagsWaitAny, timeout);
 
+  lock = osKernelLock();
+  pCtrl->wait_cnt--;
+  if (event & MOD_WAIT_RESP_GENERIC) {
+    pCtrl->wait_gen--;
+  }
+  (void)osKernelRestoreLock (lock);
+
   if ((flags & osFlagsError) == 0) {
     /* Got response */
     rval = 0;
@@ -555,13 +708,99 @@ static int32_t Modem_Wait (uint32_t event, uint32_t timeout) {
 }
 
 
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+/**
+  Submit command batch (AT_Cmd_BatchBegin) and wait until all commands complete.
+
+  \return -1: no response, timeout
+           0: all commands responded with OK
+    positive: number of failed commands
+*/
+static int32_t Modem_BatchWait (void) {
+  int32_t rval, num, i;
+
+  rval = 0;
+  num  = AT_Cmd_BatchSubmit();
+
+  if (num > 0) {
+    /* Parser sends the commands, wait once for the last response */
+    if (Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_RESP_TIMEOUT * (uint32_t)num) != 0) {
+      rval = -1;
+    }
+    else {
+      for (i = 0; i < num; i++) {
+        if (AT_Resp_Batch ((uint32_t)i) != AT_RESP_OK) {
+          rval++;
+        }
+      }
+    }
+  }
+
+  AT_Cmd_BatchEnd();
+
+  return (rval);
+}
+#endif
+
+
+/**
+  Send data from the caller buffer without copying it into the serial
+  transmit buffer. Function returns when the serial driver no longer
+  accesses the buffer.
+
+  \return -1: timeout, transmit aborted
+    positive: number of bytes sent
+*/
+static int32_t Modem_SendNoCopy (const uint8_t *buf, uint32_t len) {
+  AT_PARSER_COM_SERIAL info;
+  int32_t rval;
+  uint32_t n, num, tout;
+
+  rval = 0;
+  n    = 0U;
+
+  if ((AT_Parser_GetSerialCfg (&info) != 0) || (info.baudrate < 1000U)) {
+    info.baudrate = MOD_SERIAL_BAUDRATE;
+  }
+
+  osEventFlagsClear (pCtrl->evflags_id, MOD_WAIT_TX_DONE);
+
+  while ((rval == 0) && ((n < len) || (AT_Send_GetPending() != 0U))) {
+    if (n < len) {
+      /* Queue as much of the buffer as transmit descriptors allow */
+      num = AT_Send_DataNoCopy (&buf[n], len - n);
+      n  += num;
+    }
+
+    if ((n < len) || (AT_Send_GetPending() != 0U)) {
+      /* Wait for a transfer to complete, allow for the bytes in flight (10 bits per byte) */
+      tout = MOD_RESP_TIMEOUT + ((AT_Send_GetPending() * 10U) / (info.baudrate / 1000U));
+
+      if (Modem_Wait (MOD_WAIT_TX_DONE, tout) != 0) {
+        rval = -1;
+      }
+    }
+  }
+
+  if (rval != 0) {
+    /* Make sure buffer is released */
+    AT_Send_Abort();
+  }
+  else {
+    rval = (int32_t)len;
+  }
+
+  return (rval);
+}
+
+
 /**
   MODEM thread.
 */
 void Modem_Thread (void *arg) {
   int32_t ex;
   uint32_t flags;
-  uint32_t tout;
+  uint32_t tout, poll;
 
   (void)arg;
 
@@ -573,9 +812,23 @@ void Modem_Thread (void *arg) {
   }
 
   /* Set pooling timeout interval */
-  tout = MOD_THREAD_POOLING_TIMEOUT;
+  poll = MOD_THREAD_POOLING_MIN;
 
   while (1) {
+    if (ex == 0) {
+      /* Serial interface does not signal received data, pool at fixed interval */
+      tout = MOD_THREAD_POOLING_TIMEOUT;
+    }
+    else if (pCtrl->wait_cnt == 0U) {
+      /* Event driven and nothing in flight, sleep until signaled */
+      tout = osWaitForever;
+      poll = MOD_THREAD_POOLING_MIN;
+    }
+    else {
+      /* Response pending, pool as a fallback to the serial events */
+      tout = poll;
+    }
+
     /* Wait for thread flags until timeout expires */
     flags = osThreadFlagsWait (MOD_THREAD_FLAGS, osFlagsWaitAny, tout);
 
@@ -587,6 +840,17 @@ void Modem_Thread (void *arg) {
         /* Self-terminate */
         osThreadTerminate (osThreadGetId());
       }
+
+      /* Event path works, restart with the shortest interval */
+      poll = MOD_THREAD_POOLING_MIN;
+    }
+    else {
+      /* Nothing signaled, back off */
+      poll *= 2U;
+
+      if (poll > MOD_THREAD_POOLING_TIMEOUT) {
+        poll = MOD_THREAD_POOLING_TIMEOUT;
+      }
     }
 
     AT_Parser_Execute();
@@ -645,6 +909,14 @@ static int32_t MOD_Initialize (MOD_SignalEvent_t cb_event) {
     mp_attr = Socket_MemPool_Attr;
     pCtrl->mempool_id = osMemoryPoolNew (SOCKET_BUFFER_BLOCK_COUNT, SOCKET_BUFFER_BLOCK_SIZE, &mp_attr);
 
+#if (SOCKET_LARGE_BLOCK_COUNT != 0)
+    /* Create large block memory pool */
+    mp_attr = Socket_MemPoolLg_Attr;
+    pCtrl->mempool_lg = osMemoryPoolNew (SOCKET_LARGE_BLOCK_COUNT, SOCKET_LARGE_BLOCK_SIZE, &mp_attr);
+#else
+    pCtrl->mempool_lg = NULL;
+#endif
+
     /* Create event flags object */
     ef_attr = Modem_EventFlags_Attr;
     pCtrl->evflags_id = osEventFlagsNew (&ef_attr);
@@ -658,6 +930,7 @@ static int32_t MOD_Initialize (MOD_SignalEvent_t cb_event) {
     pCtrl->memmtx_id = osMutexNew (&mtx_attr);
 
     if ((pCtrl->mempool_id == NULL) ||
+        ((pCtrl->mempool_lg == NULL) && (SOCKET_LARGE_BLOCK_COUNT != 0)) ||
         (pCtrl->evflags_id == NULL) ||
         (pCtrl->mutex_id   == NULL) ||
         (pCtrl->memmtx_id  == NULL)) {
@@ -689,6 +962,10 @@ static int32_t MOD_Initialize (MOD_SignalEvent_t cb_event) {
         (void)osMemoryPoolDelete (pCtrl->mempool_id);
       }
 
+      if (pCtrl->mempool_lg != NULL) {
+        (void)osMemoryPoolDelete (pCtrl->mempool_lg);
+      }
+
       if (pCtrl->evflags_id != NULL) {
         (void)osEventFlagsDelete (pCtrl->evflags_id);
       }
@@ -704,6 +981,13 @@ static int32_t MOD_Initialize (MOD_SignalEvent_t cb_event) {
     else {
       /* Successfully initialized */
       pCtrl->flags = MOD_FLAGS_INIT;
+
+      Modem_PoolRegister (MOD_POOL_SOCKET,       pCtrl->mempool_id);
+      Modem_PoolRegister (MOD_POOL_SOCKET_LARGE, pCtrl->mempool_lg);
+
+      /* Subscribe to socket and network registration URCs */
+      (void)AT_Urc_Subscribe ("QIURC", Urc_QIURC, NULL);
+      (void)AT_Urc_Subscribe ("CEREG", Urc_CEREG, NULL);
     }
   }
   
@@ -756,6 +1040,12 @@ static int32_t MOD_Uninitialize (void) {
     }
   }
 
+  (void)AT_Urc_Unsubscribe ("QIURC", Urc_QIURC);
+  (void)AT_Urc_Unsubscribe ("CEREG", Urc_CEREG);
+
+  Modem_PoolRegister (MOD_POOL_SOCKET,       NULL);
+  Modem_PoolRegister (MOD_POOL_SOCKET_LARGE, NULL);
+
   if (pCtrl->mempool_id != NULL) {
     if (osMemoryPoolDelete (pCtrl->mempool_id) != osOK) {
       /* Memory pool delete failed */
@@ -763,6 +1053,13 @@ static int32_t MOD_Uninitialize (void) {
     }
   }
 
+  if (pCtrl->mempool_lg != NULL) {
+    if (osMemoryPoolDelete (pCtrl->mempool_lg) != osOK) {
+      /* Memory pool delete failed */
+      rval = MOD_DRIVER_ERROR;
+    }
+  }
+
   if (rval == MOD_DRIVER_OK) {
     /* Clear resource variables */
     pCtrl->flags     = 0U;
@@ -946,6 +1243,15 @@ static int32_t MOD_PowerControl (MOD_POWER_STATE state) {
             }
           }
 
+          if (ex == 0) {
+            /* Enable network registration URC (+CEREG: <stat>) */
+            if (AT_Cmd_NetRegStatus (AT_CMODE_SET, 1U) == 0) {
+              /* Registration status is then polled only, ignore failure */
+              (void)Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_RESP_TIMEOUT);
+              (void)AT_Resp_Generic();
+            }
+          }
+
           if (ex == 0) {
             /* Driver is powered */
             pCtrl->flags |= MOD_FLAGS_POWER;
@@ -1674,7 +1980,7 @@ static int32_t MOD_SocketCreate (int32_t af, int32_t type, int32_t protocol) {
           Socket[n].tout_tx  = 0U;
 
           /* Setup socket memory */
-          BufInit (pCtrl->mempool_id, pCtrl->memmtx_id, &Socket[n].mem);
+          BufInitAlloc (&Modem_PoolAllocator, pCtrl->mempool_id, pCtrl->mempool_lg, pCtrl->memmtx_id, &Socket[n].mem);
           break;
         }
       }
@@ -2302,7 +2608,7 @@ static int32_t MOD_SocketRecvFrom (int32_t socket, void *buf, uint32_t len, uint
   int32_t ex, rval;
   MOD_SOCKET *sock;
   uint8_t *pu8 = (uint8_t *)buf;
-  uint32_t n, cnt, num;
+  uint32_t n, cnt, num, hdr;
 
   Modem_ThreadKick();
 
@@ -2444,14 +2750,24 @@ static int32_t MOD_SocketRecvFrom (int32_t socket, void *buf, uint32_t len, uint
           break;
       }
       if (sock->rx_len == 0) {
-        /* Read packet header */
+        /* Read packet header once the whole packet is in the buffer */
+        BufBegin (&sock->mem);
+
         if (BufGetCount (&sock->mem) >= 2U) {
           /* Header is in the buffer */
-          if (BufRead ((uint8_t *)&sock->rx_len, 2U, &sock->mem) != 2U) {
-            /* Buffer error */
-            rval = ARM_SOCKET_ERROR;
+          hdr = 0U;
+          ((uint8_t *)&hdr)[0] = (uint8_t)BufPeekOffsUnlocked (0U, &sock->mem);
+          ((uint8_t *)&hdr)[1] = (uint8_t)BufPeekOffsUnlocked (1U, &sock->mem);
+
+          if (BufGetCount (&sock->mem) >= (hdr + 2U)) {
+            if (BufReadUnlocked ((uint8_t *)&sock->rx_len, 2U, &sock->mem) != 2U) {
+              /* Buffer error */
+              rval = ARM_SOCKET_ERROR;
+            }
           }
         }
+
+        BufEnd (&sock->mem);
       }
 
       if (sock->rx_len == 0) {
@@ -2555,6 +2871,11 @@ static int32_t MOD_SocketRecvFrom (int32_t socket, void *buf, uint32_t len, uint
       /* Mutex error, override previous return value */
       rval = ARM_SOCKET_ERROR;
     }
+
+    if (n != 0U) {
+      /* Socket buffer space released, resume parser waiting for it */
+      Modem_ThreadKick();
+    }
   }
 
   return (rval);
@@ -2609,7 +2930,7 @@ static int32_t MOD_SocketSend (int32_t socket, const void *buf, uint32_t len) {
 */
 static int32_t MOD_SocketSendTo (int32_t socket, const void *buf, uint32_t len, const uint8_t *ip, uint32_t ip_len, uint16_t port) {
   int32_t ex, rval;
-  uint32_t num, cnt, n;
+  uint32_t num, cnt;
   MOD_SOCKET   *sock;
   const uint8_t *pu8    = (const uint8_t *)buf;
   const uint8_t *r_ip   = NULL;
@@ -2797,36 +3118,18 @@ static int32_t MOD_SocketSendTo (int32_t socket, const void *buf, uint32_t len,
             rval = ARM_SOCKET_ERROR;
           }
           else {
-            /* Start sending actual data to device */
+            /* Start sending actual data to device, caller buffer is sent directly */
             /* Set number of bytes sent */
             num = 0U;
 
-            while (num < len) {
-              /* Determine amount of data to send */
-              cnt = AT_Send_GetFree();
-
-              if (cnt == 0U) {
-                /* Tx buffer full, wait until tx buffer available */
-                ex = Modem_Wait (MOD_WAIT_TX_DONE, MOD_RESP_TIMEOUT);
-
-                if (ex == 0) {
-                  /* Data transfer completed */
-                  cnt = AT_Send_GetFree();
-                }
-                else {
-                  /* Device internal error */
-                  rval = ARM_SOCKET_ERROR;
-                  break;
-                }
-              }
-
-              if (cnt > (len - num)) {
-                cnt = (len - num);
-              }
-
-              osEventFlagsClear (pCtrl->evflags_id, MOD_WAIT_TX_DONE);
+            ex = Modem_SendNoCopy (pu8, len);
 
-              num += AT_Send_Data (&pu8[num], cnt);
+            if (ex < 0) {
+              /* Device internal error */
+              rval = ARM_SOCKET_ERROR;
+            }
+            else {
+              num = (uint32_t)ex;
             }
 
             /* Data sent, wait for SEND OK or SEND FAIL responses */
@@ -2900,36 +3203,15 @@ static int32_t MOD_SocketSendTo (int32_t socket, const void *buf, uint32_t len,
             rval = ARM_SOCKET_ERROR;
           }
           else {
-            /* Start sending actual data to device */
-            while (cnt != 0) {
-              /* Determine amount of data to put into tx buffer */
-              n = AT_Send_GetFree();
-
-              if (n == 0U) {
-                /* Tx buffer full, wait until tx buffer available */
-                ex = Modem_Wait (MOD_WAIT_TX_DONE, MOD_RESP_TIMEOUT);
-
-                if (ex == 0) {
-                  /* Data transfer completed */
-                  n = AT_Send_GetFree();
-                }
-                else {
-                  /* Device internal error */
-                  rval = ARM_SOCKET_ERROR;
-                  break;
-                }
-              }
+            /* Start sending actual data to device, caller buffer is sent directly */
+            ex = Modem_SendNoCopy (&pu8[num], cnt);
 
-              if (n > cnt) {
-                n = cnt;
-              }
-
-              osEventFlagsClear (pCtrl->evflags_id, MOD_WAIT_TX_DONE);
-
-              n = AT_Send_Data (&pu8[num], n);
-
-              num += n;
-              cnt -= n;
+            if (ex < 0) {
+              /* Device internal error */
+              rval = ARM_SOCKET_ERROR;
+            }
+            else {
+              num += (uint32_t)ex;
             }
 
             /* Data sent, wait for SEND OK or SEND FAIL responses */
@@ -4361,16 +4643,84 @@ static int32_t MOD_HTTP (int32_t socket, MOD_HTTP_t * httpd){
       ex = 0;
     }
     else {
-      ex = MOD_HTTP_SetOption(HTTP_OPTION_CONTEXT_ID, (void *)sock->conn_id);
-      
+#if (MOD_EG915U_CMD_PIPELINE_DEPTH > 1)
+      /* Configure HTTP(S) context with one command batch */
+      if (osMutexAcquire (pCtrl->mutex_id, osWaitForever) != osOK) {
+        ex = -1;
+      }
+      else {
+        ex = AT_Cmd_BatchBegin();
+
+        if (ex == 0) {
+          ex |= AT_Cmd_HTTP_Config (HTTP_OPTION_CONTEXT_ID, (void *)sock->conn_id);
+
+          if (httpd->header) {
+            ex |= AT_Cmd_HTTP_Config (HTTP_OPTION_REQUESTHEADER, (void *)HTTP_SETOPTION_ENABLE);
+          }
+
+          if (httpd->response_header) {
+            ex |= AT_Cmd_HTTP_Config (HTTP_OPTION_RESPONSEHEADER, (void *)HTTP_SETOPTION_ENABLE);
+          }
+
+          if (httpd->url[4] == 's') { //enable SSL config TODO:
+            uint32_t SSL_context_id = 1;
+            ex |= AT_Cmd_HTTP_Config (HTTP_OPTION_SSLCTXID, (void *)SSL_context_id);
+            ex |= AT_Cmd_SSL_Config (SSL_CONFIG_VERSION, SSL_context_id, (void *)SSL_PARAM_VERSION_ALL);
+            ex |= AT_Cmd_SSL_Config (SSL_CONFIG_CIPHER_SUITE, SSL_context_id, (void *)SSL_PARAM_CIPHER_SUPPORT_ALL);
+            ex |= AT_Cmd_SSL_Config (SSL_CONFIG_SECLEVEL, SSL_context_id, (void *)SSL_PARAM_SECLEVEL_FREE);
+            // MOD_SSL_SetOption(SSL_CONFIG_CACERT, SSL_context_id, (void *)"UFS:cacert.pem");
+            // MOD_SSL_SetOption(SSL_CONFIG_CLIENTCERT, SSL_context_id, (void *)"UFS:clientcert.pem");
+            // MOD_SSL_SetOption(SSL_CONFIG_CLIENTKEY, SSL_context_id, (void *)"UFS:clientkey.pem");
+          }
+
+          if (ex == 0) {
+            /* Wait once for all responses */
+            ex = (Modem_BatchWait() == 0) ? 0 : -1;
+          }
+          else {
+            /* Command could not be queued */
+            AT_Cmd_BatchEnd();
+          }
+        }
+
+        if (osMutexRelease (pCtrl->mutex_id) != osOK) {
+          ex = -1;
+        }
+      }
+#else
+      /* Configure HTTP(S) context, one command at a time */
+      ex = MOD_HTTP_SetOption (HTTP_OPTION_CONTEXT_ID, (void *)sock->conn_id);
+
+      if ((ex == 0) && httpd->header) {
+        ex = MOD_HTTP_SetOption (HTTP_OPTION_REQUESTHEADER, (void *)HTTP_SETOPTION_ENABLE);
+      }
+
+      if ((ex == 0) && httpd->response_header) {
+        ex = MOD_HTTP_SetOption (HTTP_OPTION_RESPONSEHEADER, (void *)HTTP_SETOPTION_ENABLE);
+      }
+
+      if ((ex == 0) && (httpd->url[4] == 's')) { //enable SSL config TODO:
+        uint32_t SSL_context_id = 1;
+        ex = MOD_HTTP_SetOption (HTTP_OPTION_SSLCTXID, (void *)SSL_context_id);
+
+        if (ex == 0) {
+          ex = MOD_SSL_SetOption (SSL_CONFIG_VERSION, SSL_context_id, (void *)SSL_PARAM_VERSION_ALL);
+        }
+        if (ex == 0) {
+          ex = MOD_SSL_SetOption (SSL_CONFIG_CIPHER_SUITE, SSL_context_id, (void *)SSL_PARAM_CIPHER_SUPPORT_ALL);
+        }
+        if (ex == 0) {
+          ex = MOD_SSL_SetOption (SSL_CONFIG_SECLEVEL, SSL_context_id, (void *)SSL_PARAM_SECLEVEL_FREE);
+        }
+      }
+#endif
+
 			if(httpd->data && !httpd->data_length)
           httpd->data_length = strlen((const char *)httpd->data);
 			
       if(httpd->header){
         HTTP_HeaderTypeDef header;
 
-        ex = MOD_HTTP_SetOption(HTTP_OPTION_REQUESTHEADER, (void *)HTTP_SETOPTION_ENABLE);
-
         header.fields = httpd->header->fields;
         header.nfield = httpd->header->nfield;
         header.url = (char *)httpd->url;
@@ -4379,26 +4729,9 @@ static int32_t MOD_HTTP (int32_t socket, MOD_HTTP_t * httpd){
         header.content_length = httpd->data_length;
         tmp = HTTPHeader(httpd->header->buffer, &header);
         }
-        
-        
-      if(httpd->response_header)
-        ex = MOD_HTTP_SetOption(HTTP_OPTION_RESPONSEHEADER, (void *)HTTP_SETOPTION_ENABLE);
-      
 
-      if(httpd->url[4] == 's'){ //enable SSL config TODO:
-        uint32_t SSL_context_id = 1;
-        MOD_HTTP_SetOption(HTTP_OPTION_SSLCTXID, (void *)SSL_context_id);
-        MOD_SSL_SetOption(SSL_CONFIG_VERSION, SSL_context_id, (void *)SSL_PARAM_VERSION_ALL);
-        MOD_SSL_SetOption(SSL_CONFIG_CIPHER_SUITE, SSL_context_id, (void *)SSL_PARAM_CIPHER_SUPPORT_ALL);
-        MOD_SSL_SetOption(SSL_CONFIG_SECLEVEL, SSL_context_id, (void *)SSL_PARAM_SECLEVEL_FREE);
-        // MOD_SSL_SetOption(SSL_CONFIG_CACERT, SSL_context_id, (void *)"UFS:cacert.pem");
-        // MOD_SSL_SetOption(SSL_CONFIG_CLIENTCERT, SSL_context_id, (void *)"UFS:clientcert.pem");
-        // MOD_SSL_SetOption(SSL_CONFIG_CLIENTKEY, SSL_context_id, (void *)"UFS:clientkey.pem");
-
-      }
 
-
-      if(httpd->url){
+      if((ex == 0) && httpd->url){
         // char *path = strchr(strstr((char *)httpd->url, "//") + 2, '/');
         // char tmp = *path;
         // *path = 0;
@@ -4654,7 +4987,6 @@ static int32_t MOD_HTTP_GET_Open (int32_t socket, uint32_t data_length, uint32_t
 
 static int32_t MOD_HTTP_Send (int32_t socket, uint8_t  *data, uint32_t len) {
   int32_t  ex, rval = 0;
-  uint32_t cnt, num;
   MOD_SOCKET *sock;
 
   ex = -1;
@@ -4679,36 +5011,12 @@ static int32_t MOD_HTTP_Send (int32_t socket, uint8_t  *data, uint32_t len) {
     rval = ARM_SOCKET_ERROR;
   }
   else{
-    /* Start sending actual data to device */
-    /* Set number of bytes sent */
-    num = 0U;
-
-    while (num < len) {
-      /* Determine amount of data to send */
-      cnt = AT_Send_GetFree();
-
-      if (cnt == 0U) {
-        /* Tx buffer full, wait until tx buffer available */
-        ex = Modem_Wait (MOD_WAIT_TX_DONE, MOD_RESP_TIMEOUT);
-
-        if (ex == 0) {
-          /* Data transfer completed */
-          cnt = AT_Send_GetFree();
-        }
-        else {
-          /* Device internal error */
-          rval = ARM_SOCKET_ERROR;
-          break;
-        }
-      }
+    /* Start sending actual data to device, caller buffer is sent directly */
+    ex = Modem_SendNoCopy (data, len);
 
-      if (cnt > (len - num)) {
-        cnt = (len - num);
-      }
-
-      osEventFlagsClear (pCtrl->evflags_id, MOD_WAIT_TX_DONE);
-
-      num += AT_Send_Data ((uint8_t *)&data[num], cnt);
+    if (ex < 0) {
+      /* Device internal error */
+      rval = ARM_SOCKET_ERROR;
     }
     if (osMutexRelease (pCtrl->mutex_id) != osOK) {
       /* Mutex error, override previous return value */
@@ -4831,6 +5139,8 @@ static int32_t MOD_HTTP_End ( int32_t socket,
               sock->tout_rx = 0;
               sock->current.count = 0;
 
+              osEventFlagsClear (sock->evflags_id, SOCK_WAIT_HTTP_RESP_ABORT);
+
               if(AT_Cmd_QHTTPREAD(timeout) != 0){
                 ex = -1;
               }
@@ -4847,13 +5157,20 @@ static int32_t MOD_HTTP_End ( int32_t socket,
                 while(1){
 
                   val = osEventFlagsWait (sock->evflags_id, 
-                                          SOCK_WAIT_HTTP_RESP_PARTIAL | SOCK_WAIT_HTTP_RESP_COMPLETE, 
+                                          SOCK_WAIT_HTTP_RESP_PARTIAL | SOCK_WAIT_HTTP_RESP_COMPLETE | SOCK_WAIT_HTTP_RESP_ABORT, 
                                           osFlagsWaitAny, 
                                           osWaitForever);
 
 									if(val & osFlagsError/*Flag is NULL*/){
 										continue;
 									}									
+
+                  if(val & SOCK_WAIT_HTTP_RESP_ABORT){
+                    /* Serial data lost, content is incomplete */
+                    rval = MOD_DRIVER_ERROR;
+                    ex   = -3;
+                    break;
+                  }
                   
                   if(sock->response_callback){
                     sock->response_callback(sock->current.mem,
@@ -4872,15 +5189,12 @@ static int32_t MOD_HTTP_End ( int32_t socket,
               
                 if (ex == 0) {
                   ex = Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_RESP_TIMEOUT); // OK
-                }
-                else{
-                  osEventFlagsSet (sock->evflags_id, SOCK_WAIT_HTTP_RESP_FAIL);
-                }
 
-                ex = Modem_Wait (MOD_WAIT_HTTP_RESPONSE, MOD_RESP_TIMEOUT) ; // wait for +QHTTPRREAD
+                  ex = Modem_Wait (MOD_WAIT_HTTP_RESPONSE, MOD_RESP_TIMEOUT) ; // wait for +QHTTPRREAD
 
-                if(ex == 0)
-                  ex = AT_Resp_HTTPErrCode ((uint32_t *)&rval, NULL, NULL);
+                  if(ex == 0)
+                    ex = AT_Resp_HTTPErrCode ((uint32_t *)&rval, NULL, NULL);
+                }
 
                   
               }
@@ -5006,6 +5320,27 @@ static int32_t MOD_Release (void) {
 
 }
 
+/**
+  Retrieve memory pool usage statistics.
+
+  \param[in]     pool     memory pool (MOD_POOL_xxx)
+  \param[out]    stats    pointer to statistics structure
+  \return        execution status
+                   - \ref MOD_DRIVER_OK                : Operation successful
+                   - \ref MOD_DRIVER_ERROR_PARAMETER   : Parameter error (invalid pool or NULL stats pointer)
+*/
+static int32_t MOD_GetPoolStats (uint32_t pool, MOD_POOL_STATS *stats) {
+  int32_t rval;
+
+  if (Modem_PoolGetStats (pool, stats) == 0) {
+    rval = MOD_DRIVER_OK;
+  } else {
+    rval = MOD_DRIVER_ERROR_PARAMETER;
+  }
+
+  return (rval);
+}
+
 /* Exported MOD_DRIVER# */
 MOD_DRIVER MOD_DRIVER_(MOD_DRIVER_NUMBER) = {
   MOD_GetVersion,
@@ -5022,6 +5357,7 @@ MOD_DRIVER MOD_DRIVER_(MOD_DRIVER_NUMBER) = {
   MOD_HTTP,
   MOD_Release,
   MOD_SSL_SetOption,
+  MOD_GetPoolStats,
 };
 
 static int32_t ResetModule (void) {
@@ -5069,16 +5405,29 @@ static int32_t SetupCommunication (void) {
   int32_t state;
   uint32_t k;
   uint32_t stop_par_flowc;
+#if (MOD_SERIAL_BAUD_NEGOTIATE != 0)
+  uint32_t fc;
+#endif
   AT_PARSER_COM_SERIAL info;
-  const uint32_t br[] = {MOD_SERIAL_BAUDRATE, 115200,
-                                               230400,  460800,  921600,
-                                              1000000, 1500000, 2000000,
-                                                57600,   38400,   19200, 9600};
+  uint32_t br[] = {MOD_SERIAL_BAUDRATE, 115200,
+                                         230400,  460800,  921600,
+                                        1000000, 1500000, 2000000,
+                                          57600,   38400,   19200, 9600};
   k     =  0;
   state =  1;
 
+  if (Modem_BaudrateLoad() != 0U) {
+    /* Try last good baud rate first */
+    br[0] = Modem_BaudrateLoad();
+  }
+
   ex = AT_Parser_GetSerialCfg (&info);
 
+#if (MOD_SERIAL_BAUD_NEGOTIATE != 0)
+  /* Flow control selected by the serial driver, enabled after negotiation */
+  fc = info.flow_control;
+#endif
+
   if (ex == 0) {
     /* Set interface mode */
     info.databits     = 8U;
@@ -5171,6 +5520,20 @@ static int32_t SetupCommunication (void) {
     }
   }
 
+#if (MOD_SERIAL_BAUD_NEGOTIATE != 0)
+  if (ex == 0) {
+    /* Communication established, step up to the maximum baud rate */
+    info.flow_control = (uint8_t)fc;
+
+    ex = NegotiateBaudrate (&info);
+  }
+#endif
+
+  if (ex == 0) {
+    /* Remember working baud rate for the next power up */
+    Modem_BaudrateStore (info.baudrate);
+  }
+
   if (ex == 0) {
     rval = MOD_DRIVER_OK;
   } else {
@@ -5180,6 +5543,177 @@ static int32_t SetupCommunication (void) {
   return (rval);
 }
 
+#if (MOD_SERIAL_BAUD_NEGOTIATE != 0)
+/**
+  Check serial link at the current baud rate.
+
+  Each of MOD_BAUD_CHECK_NUM test commands must be answered with OK.
+
+  \return 0: link ok, -1: link error
+*/
+static int32_t LinkCheck (void) {
+  int32_t ex;
+  uint32_t i;
+
+  ex = 0;
+
+  for (i = 0U; (i < MOD_BAUD_CHECK_NUM) && (ex == 0); i++) {
+    ex = AT_Cmd_TestAT();
+
+    if (ex == 0) {
+      /* Wait until response arrives */
+      ex = Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_BAUD_PROBE_TIMEOUT);
+
+      if (ex == 0) {
+        if (AT_Resp_Generic() != AT_RESP_OK) {
+          /* Corrupted command or response */
+          ex = -1;
+        }
+      }
+      else {
+        /* No response, discard partially received data */
+        AT_Parser_Reset();
+      }
+    }
+  }
+
+  if (ex != 0) {
+    ex = -1;
+  }
+
+  return (ex);
+}
+
+/**
+  Switch modem and host serial interface to the specified baud rate and check the link.
+
+  \param[in]  info      host serial interface configuration
+  \param[in]  baudrate  baud rate to set
+  \return 0: link ok at new baud rate, -1: error
+*/
+static int32_t SetBaudrate (AT_PARSER_COM_SERIAL *info, uint32_t baudrate) {
+  int32_t ex;
+
+  ex = AT_Cmd_ConfigUARTRate (AT_CMODE_SET, baudrate);
+
+  if (ex == 0) {
+    /* Modem answers at the current rate and switches afterwards */
+    ex = Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_BAUD_PROBE_TIMEOUT);
+
+    if (ex == 0) {
+      if (AT_Resp_Generic() != AT_RESP_OK) {
+        /* Baud rate not supported by the modem */
+        ex = -1;
+      }
+    }
+  }
+
+  if (ex == 0) {
+    /* Allow the modem to switch, then follow with the host interface */
+    osDelay (20U);
+
+    info->baudrate = baudrate;
+
+    ex = AT_Parser_SetSerialCfg (info);
+  }
+
+  if (ex == 0) {
+    ex = LinkCheck();
+  }
+
+  if (ex != 0) {
+    ex = -1;
+  }
+
+  return (ex);
+}
+
+/**
+  Negotiate the highest usable baud rate.
+
+  Hardware flow control is enabled first when requested in info, then the
+  baud rate is stepped up to MOD_SERIAL_BAUDRATE_MAX. When the link check
+  fails, modem and host fall back to the last good baud rate.
+
+  \param[in,out] info  host serial interface configuration
+  \return 0: ok, -1: communication lost
+*/
+static int32_t NegotiateBaudrate (AT_PARSER_COM_SERIAL *info) {
+  static const uint32_t br[] = { 115200, 230400, 460800, 921600, 1000000, 3000000 };
+  uint32_t good, k;
+  int32_t ex;
+
+  ex = 0;
+
+  if (info->flow_control == 3U) {
+    /* Serial driver supports RTS/CTS, enable it on both sides */
+    ex = AT_Cmd_FlowControl (AT_CMODE_SET, 2U, 2U);
+
+    if (ex == 0) {
+      ex = Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_BAUD_PROBE_TIMEOUT);
+
+      if ((ex == 0) && (AT_Resp_Generic() != AT_RESP_OK)) {
+        ex = -1;
+      }
+    }
+
+    if (ex == 0) {
+      ex = AT_Parser_SetSerialCfg (info);
+    }
+
+    if (ex == 0) {
+      ex = LinkCheck();
+    }
+
+    if (ex != 0) {
+      /* Continue without flow control */
+      info->flow_control = 0U;
+
+      AT_Parser_SetSerialCfg (info);
+
+      if (AT_Cmd_FlowControl (AT_CMODE_SET, 0U, 0U) == 0) {
+        (void)Modem_Wait (MOD_WAIT_RESP_GENERIC, MOD_BAUD_PROBE_TIMEOUT);
+      }
+
+      ex = LinkCheck();
+    }
+  }
+  else {
+    /* Flow control not used */
+    info->flow_control = 0U;
+
+    ex = AT_Parser_SetSerialCfg (info);
+  }
+
+  good = info->baudrate;
+
+  for (k = 0U; (ex == 0) && (k < (sizeof(br)/sizeof(br[0]))); k++) {
+    if ((br[k] > good) && (br[k] <= MOD_SERIAL_BAUDRATE_MAX)) {
+      if (SetBaudrate (info, br[k]) == 0) {
+        /* Link ok at higher rate */
+        good = br[k];
+      }
+      else {
+        /* Link errors, back off to the last good rate */
+        ex = SetBaudrate (info, good);
+
+        if (ex != 0) {
+          /* Command lost, modem might still use the new rate */
+          info->baudrate = br[k];
+
+          if (AT_Parser_SetSerialCfg (info) == 0) {
+            ex = SetBaudrate (info, good);
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  return (ex);
+}
+#endif
+
 static int32_t IsUnspecifiedIP (const uint8_t ip[]) {
   int32_t rval;
 
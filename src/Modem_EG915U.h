@@ -34,6 +34,24 @@
 #include "EG915U.h"
 
 #define MOD_SERIAL_BAUDRATE        MOD_EG915U_SERIAL_BAUDRATE
+
+/* Serial baud rate negotiation */
+#ifndef MOD_EG915U_SERIAL_BAUD_NEGOTIATE
+#define MOD_EG915U_SERIAL_BAUD_NEGOTIATE  0
+#define MOD_EG915U_SERIAL_BAUDRATE_MAX    MOD_EG915U_SERIAL_BAUDRATE
+#endif
+#define MOD_SERIAL_BAUD_NEGOTIATE  MOD_EG915U_SERIAL_BAUD_NEGOTIATE
+#define MOD_SERIAL_BAUDRATE_MAX    MOD_EG915U_SERIAL_BAUDRATE_MAX
+
+/* Baud rate probe response timeout [ms] */
+#ifndef MOD_BAUD_PROBE_TIMEOUT
+#define MOD_BAUD_PROBE_TIMEOUT     (200)
+#endif
+
+/* Number of test commands of the serial link check */
+#ifndef MOD_BAUD_CHECK_NUM
+#define MOD_BAUD_CHECK_NUM         (4)
+#endif
 #define MOD_DRIVER_NUMBER          MOD_EG915U_DRIVER_NUMBER
 
 /* Command response timeout [ms] (default) */
@@ -56,6 +74,11 @@
 #define MOD_THREAD_POOLING_TIMEOUT (20)
 #endif 
 
+/* Modem thread shortest pooling interval while waiting for response [ms] */
+#ifndef MOD_THREAD_POOLING_MIN
+#define MOD_THREAD_POOLING_MIN     (2)
+#endif
+
 /*  default channel (used when channel not specified in Activate) */
 #ifndef MOD_AP_CHANNEL
 #define MOD_AP_CHANNEL             (2)
@@ -97,6 +120,7 @@
 #define SOCK_WAIT_HTTP_RESP_FAIL    (1UL << 1)
 #define SOCK_WAIT_HTTP_RESP_PARTIAL (1UL << 2)
 #define SOCK_WAIT_HTTP_RESP_PARTIAL_END (1UL << 3)
+#define SOCK_WAIT_HTTP_RESP_ABORT   (1UL << 4)
 
 
 
@@ -197,6 +221,7 @@ typedef struct {
   osThreadId_t           thread_id;   /* Data processing thread id   */
   osEventFlagsId_t       evflags_id;  /* Event flags object id       */
   osMemoryPoolId_t       mempool_id;  /* Socket memory pool id       */
+  osMemoryPoolId_t       mempool_lg;  /* Socket large block pool id  */
   osMutexId_t            mutex_id;    /* Socket access guard         */
   osMutexId_t            memmtx_id;   /* Memory access mutex         */
   MOD_OPTIONS           options;     /* Set/GetOption value storage */
@@ -207,6 +232,8 @@ typedef struct {
   char                   ap_pass[33]; /* AP password                 */
   uint16_t               packdump;    /* Number of dumped rx packets */
   uint16_t               flags;       /* Driver state flags          */
+  uint32_t               wait_cnt;    /* Threads waiting for response */
+  uint32_t               wait_gen;    /* Threads waiting for generic response */
 } MOD_CTRL;
 
 extern MOD_DRIVER MOD_DRIVER_(MOD_DRIVER_NUMBER);
@@ -255,12 +282,20 @@ static int32_t MOD_HTTP_End ( int32_t socket,
                               uint32_t len, 
                               uint32_t timeout);
 static int32_t MOD_SSL_SetOption(SSL_Config_t option, uint8_t ssl_context_id, void * data);
+static int32_t MOD_GetPoolStats (uint32_t pool, MOD_POOL_STATS *stats);
 
 /* Static helpers */
 static void     Modem_Thread        (void *arg) __attribute__((noreturn));
 static int32_t  Modem_Wait          (uint32_t event, uint32_t timeout);
+static void     Modem_ThreadKick    (void);
 static int32_t  ResetModule        (void);
 static int32_t  SetupCommunication (void);
+#if (MOD_SERIAL_BAUD_NEGOTIATE != 0)
+static int32_t  LinkCheck          (void);
+static int32_t  SetBaudrate        (AT_PARSER_COM_SERIAL *info, uint32_t baudrate);
+static int32_t  NegotiateBaudrate  (AT_PARSER_COM_SERIAL *info);
+#endif
+static int32_t  Modem_SendNoCopy   (const uint8_t *buf, uint32_t len);
 static int32_t  IsUnspecifiedIP    (const uint8_t ip[]);
 static int32_t  GetCurrentMAC      (uint32_t interface, uint8_t mac[]);
 static int32_t  GetCurrentIpAddr   (uint32_t interface, uint8_t ip[], uint8_t gw[], uint8_t mask[]);
@@ -270,6 +305,9 @@ static uint32_t SetOpt             (void *opt_val, uint32_t val, uint32_t opt_le
 static uint32_t ConnId_Alloc       (void);
 static void     ConnId_Free        (uint32_t conn_id);
 static void     ConnId_Accept      (uint32_t conn_id);
+static void     Socket_ConnClosed  (uint32_t conn_id);
+static void     Urc_QIURC          (const AT_URC *urc, void *arg);
+static void     Urc_CEREG          (const AT_URC *urc, void *arg);
 static int32_t  MOD_Release        (void);
 
 #endif /* MOD_EG915U_H__ */
@@ -22,12 +22,15 @@
  *
  * Project:      GSM
  * -------------------------------------------------------------------------- */
+#include <string.h>
+
 #include "Modem_EG915U_Os.h"
 
 #define THREAD_CC_ATTR     __attribute__((section(".bss.os.thread.cb")))
 #define MEMPOOL_CC_ATTR    __attribute__((section(".bss.os.mempool.cb")))
 #define EVENTFLAGS_CC_ATTR __attribute__((section(".bss.os.evflags.cb")))
 #define MUTEX_CC_ATTR      __attribute__((section(".bss.os.mutex.cb")))
+#define TIMER_CC_ATTR      __attribute__((section(".bss.os.timer.cb")))
 
 /* --------------------------------------------------------------------------*/
 
@@ -68,6 +71,24 @@ const osMemoryPoolAttr_t Socket_MemPool_Attr = {
   .mp_size   = sizeof(Socket_MemPoolArr)
 };
 
+#if (SOCKET_LARGE_BLOCK_COUNT != 0)
+#define SOCKET_MEMPOOLLG_ARR_SIZE  OS_MEMPOOL_MEM_SIZE(SOCKET_LARGE_BLOCK_COUNT, SOCKET_LARGE_BLOCK_SIZE)
+
+/* Large block Memory Pool control block and memory space */
+static uint8_t Socket_MemPoolLgCb[OS_MEMPOOL_CB_SIZE]         __ALIGNED(4) MEMPOOL_CC_ATTR;
+static uint8_t Socket_MemPoolLgArr[SOCKET_MEMPOOLLG_ARR_SIZE] __ALIGNED(4);
+
+/* Large block memory pool for socket data storage */
+const osMemoryPoolAttr_t Socket_MemPoolLg_Attr = {
+  .name      = "Modem Socket Large",
+  .attr_bits = 0U,
+  .cb_mem    = Socket_MemPoolLgCb,
+  .cb_size   = sizeof(Socket_MemPoolLgCb),
+  .mp_mem    = Socket_MemPoolLgArr,
+  .mp_size   = sizeof(Socket_MemPoolLgArr)
+};
+#endif
+
 /* --------------------------------------------------------------------------*/
 
 #define MOD_MUTEX_ATTRIBUTES  osMutexPrioInherit
@@ -99,6 +120,31 @@ const osMemoryPoolAttr_t AT_Parser_MemPool_Attr = {
   .mp_size   = sizeof(AT_Parser_MemPoolArr),
 };
 
+#if (PARSER_LARGE_BLOCK_COUNT != 0)
+#define ATPARSER_MEMPOOLLG_ARR_SIZE   OS_MEMPOOL_MEM_SIZE(PARSER_LARGE_BLOCK_COUNT, PARSER_LARGE_BLOCK_SIZE)
+
+/* Large block Memory Pool control block and memory space */
+static uint8_t AT_Parser_MemPoolLgCb[OS_MEMPOOL_CB_SIZE]           __ALIGNED(4) MEMPOOL_CC_ATTR;
+static uint8_t AT_Parser_MemPoolLgArr[ATPARSER_MEMPOOLLG_ARR_SIZE] __ALIGNED(4) ;
+
+/* Large block Memory Pool for AT command parser */
+const osMemoryPoolAttr_t AT_Parser_MemPoolLg_Attr = {
+  .name      = "Modem Parser Large",
+  .attr_bits = 0U,
+  .cb_mem    = AT_Parser_MemPoolLgCb,
+  .cb_size   = sizeof(AT_Parser_MemPoolLgCb),
+  .mp_mem    = AT_Parser_MemPoolLgArr,
+  .mp_size   = sizeof(AT_Parser_MemPoolLgArr),
+};
+#endif
+
+/* --------------------------------------------------------------------------*/
+
+#if (PARSER_RING_SIZE != 0)
+/* Ring buffer storage for AT command parser */
+uint8_t AT_Parser_RingArr[PARSER_RING_SIZE] __ALIGNED(4);
+#endif
+
 /* --------------------------------------------------------------------------*/
 
 static uint8_t Modem_EventFlagsCb[OS_EVENTFLAGS_CB_SIZE] __ALIGNED(4) EVENTFLAGS_CC_ATTR;
@@ -119,3 +165,210 @@ const osMutexAttr_t BufList_Mutex_Attr = {
   .cb_mem    = BufList_MutexCb,
   .cb_size   = sizeof(BufList_MutexCb)
 };
+
+/* --------------------------------------------------------------------------*/
+
+static uint8_t Serial_TimerCb[OS_TIMER_CB_SIZE] __ALIGNED(4) TIMER_CC_ATTR;
+
+const osTimerAttr_t Serial_Timer_Attr = {
+  .name    = "Serial Idle",
+  .cb_mem  = Serial_TimerCb,
+  .cb_size = sizeof(Serial_TimerCb)
+};
+
+/* --------------------------------------------------------------------------*/
+
+/* Pool utilization threshold for high_time accounting [%] */
+#define POOL_HIGH_PERCENT   90U
+
+/* Memory pool statistics slot */
+typedef struct {
+  osMemoryPoolId_t mp_id;         /* Memory pool id                        */
+  MOD_POOL_STATS   st;            /* Statistics                            */
+  uint32_t         t_high;        /* Ticks spent above threshold           */
+  uint32_t         t_enter;       /* Tick count when threshold was crossed */
+  uint32_t         high;          /* Above threshold flag                  */
+} POOL_TELEMETRY;
+
+static POOL_TELEMETRY Pool_Tm[MOD_POOL_NUM];
+
+/* Find statistics slot of the memory pool */
+static POOL_TELEMETRY *PoolFind (osMemoryPoolId_t mp_id) {
+  POOL_TELEMETRY *tm;
+  uint32_t i;
+
+  tm = NULL;
+
+  for (i = 0U; i < MOD_POOL_NUM; i++) {
+    if ((Pool_Tm[i].mp_id != NULL) && (Pool_Tm[i].mp_id == mp_id)) {
+      tm = &Pool_Tm[i];
+      break;
+    }
+  }
+
+  return (tm);
+}
+
+/* Update usage counters after allocation or release, called with kernel locked */
+static void PoolUpdate (POOL_TELEMETRY *tm) {
+  uint32_t used, high, tick;
+
+  used = osMemoryPoolGetCount (tm->mp_id);
+
+  tm->st.used = used;
+
+  if (used > tm->st.peak) {
+    tm->st.peak = used;
+  }
+
+  high = ((used * 100U) > (tm->st.block_count * POOL_HIGH_PERCENT)) ? 1U : 0U;
+
+  if (high != tm->high) {
+    tick = osKernelGetTickCount();
+
+    if (high != 0U) {
+      tm->t_enter = tick;
+    } else {
+      tm->t_high += tick - tm->t_enter;
+    }
+    tm->high = high;
+  }
+}
+
+static void *Tm_Alloc (void *pool) {
+  POOL_TELEMETRY *tm;
+  void *block;
+  int32_t lock;
+
+  block = osMemoryPoolAlloc ((osMemoryPoolId_t)pool, 0U);
+
+  tm = PoolFind ((osMemoryPoolId_t)pool);
+
+  if (tm != NULL) {
+    lock = osKernelLock();
+
+    if (block == NULL) {
+      tm->st.alloc_fail++;
+    } else {
+      PoolUpdate (tm);
+    }
+
+    (void)osKernelRestoreLock (lock);
+  }
+
+  return (block);
+}
+
+static int32_t Tm_Free (void *pool, void *block) {
+  POOL_TELEMETRY *tm;
+  int32_t rval, lock;
+
+  if (osMemoryPoolFree ((osMemoryPoolId_t)pool, block) == osOK) {
+    tm = PoolFind ((osMemoryPoolId_t)pool);
+
+    if (tm != NULL) {
+      lock = osKernelLock();
+      PoolUpdate (tm);
+      (void)osKernelRestoreLock (lock);
+    }
+    rval = 0;
+  } else {
+    rval = -1;
+  }
+
+  return (rval);
+}
+
+static uint32_t Tm_GetSpace (void *pool) {
+  return (osMemoryPoolGetSpace ((osMemoryPoolId_t)pool));
+}
+
+static uint32_t Tm_GetBlockSize (void *pool) {
+  return (osMemoryPoolGetBlockSize ((osMemoryPoolId_t)pool));
+}
+
+/* Memory pool block allocator with usage statistics */
+const BUF_ALLOCATOR Modem_PoolAllocator = {
+  Tm_Alloc,
+  Tm_Free,
+  Tm_GetSpace,
+  Tm_GetBlockSize
+};
+
+/* Attach memory pool to statistics slot */
+void Modem_PoolRegister (uint32_t pool, osMemoryPoolId_t mp_id) {
+  POOL_TELEMETRY *tm;
+
+  if (pool < MOD_POOL_NUM) {
+    tm = &Pool_Tm[pool];
+
+    memset (tm, 0, sizeof(POOL_TELEMETRY));
+
+    if (mp_id != NULL) {
+      tm->st.block_size  = osMemoryPoolGetBlockSize (mp_id);
+      tm->st.block_count = osMemoryPoolGetCapacity  (mp_id);
+      tm->mp_id          = mp_id;
+    }
+  }
+}
+
+/* Account dropped received data */
+void Modem_PoolDrop (uint32_t pool, uint32_t num) {
+  int32_t lock;
+
+  if (pool < MOD_POOL_NUM) {
+    lock = osKernelLock();
+    Pool_Tm[pool].st.drop_bytes += num;
+    (void)osKernelRestoreLock (lock);
+  }
+}
+
+/* Retrieve memory pool statistics */
+int32_t Modem_PoolGetStats (uint32_t pool, MOD_POOL_STATS *stats) {
+  POOL_TELEMETRY *tm;
+  uint64_t ticks;
+  uint32_t freq;
+  int32_t  rval, lock;
+
+  if ((pool >= MOD_POOL_NUM) || (stats == NULL)) {
+    rval = -1;
+  }
+  else {
+    tm = &Pool_Tm[pool];
+
+    lock = osKernelLock();
+
+    *stats = tm->st;
+
+    ticks = tm->t_high;
+
+    if (tm->high != 0U) {
+      /* Still above threshold, include current period */
+      ticks += osKernelGetTickCount() - tm->t_enter;
+    }
+
+    (void)osKernelRestoreLock (lock);
+
+    freq = osKernelGetTickFreq();
+
+    if (freq != 0U) {
+      stats->high_time = (uint32_t)((ticks * 1000U) / freq);
+    }
+
+    rval = 0;
+  }
+
+  return (rval);
+}
+
+/* --------------------------------------------------------------------------*/
+
+/* Retrieve last good serial baud rate, 0 if not available */
+__WEAK uint32_t Modem_BaudrateLoad (void) {
+  return (0U);
+}
+
+/* Store last good serial baud rate */
+__WEAK void Modem_BaudrateStore (uint32_t baudrate) {
+  (void)baudrate;
+}
@@ -31,6 +31,8 @@
 #include "RTE_Components.h"
 
 #include "Modem_EG915U_Config.h"
+#include "DRIVER_MODEM.h"
+#include "BufAllocator.h"
 
 /* Convert priority number to CMSIS-RTOS2 priority value */
 #define CMSIS_RTOS2_PRIORITY(n)      \
@@ -53,6 +55,27 @@
 #define PARSER_BUFFER_BLOCK_SIZE      MOD_EG915U_PARSER_BLOCK_SIZE
 #define PARSER_BUFFER_BLOCK_COUNT     MOD_EG915U_PARSER_BLOCK_COUNT
 
+/* Large block memory pools (block count 0: large blocks not used) */
+#ifndef MOD_EG915U_SOCKET_LARGE_BLOCK_COUNT
+#define MOD_EG915U_SOCKET_LARGE_BLOCK_SIZE   0
+#define MOD_EG915U_SOCKET_LARGE_BLOCK_COUNT  0
+#endif
+#define SOCKET_LARGE_BLOCK_SIZE       MOD_EG915U_SOCKET_LARGE_BLOCK_SIZE
+#define SOCKET_LARGE_BLOCK_COUNT      MOD_EG915U_SOCKET_LARGE_BLOCK_COUNT
+
+#ifndef MOD_EG915U_PARSER_LARGE_BLOCK_COUNT
+#define MOD_EG915U_PARSER_LARGE_BLOCK_SIZE   0
+#define MOD_EG915U_PARSER_LARGE_BLOCK_COUNT  0
+#endif
+#define PARSER_LARGE_BLOCK_SIZE       MOD_EG915U_PARSER_LARGE_BLOCK_SIZE
+#define PARSER_LARGE_BLOCK_COUNT      MOD_EG915U_PARSER_LARGE_BLOCK_COUNT
+
+/* Serial parser ring buffer size (0: parser uses memory pool blocks) */
+#ifndef MOD_EG915U_PARSER_RING_SIZE
+#define MOD_EG915U_PARSER_RING_SIZE   0
+#endif
+#define PARSER_RING_SIZE              MOD_EG915U_PARSER_RING_SIZE
+
 
 #if defined(RTE_CMSIS_RTOS2_RTX5)
   #include "rtx_os.h"
@@ -70,6 +93,9 @@
   /* Event Flags control block size */
   #define OS_EVENTFLAGS_CB_SIZE                   osRtxEventFlagsCbSize
 
+  /* Timer control block size */
+  #define OS_TIMER_CB_SIZE                        osRtxTimerCbSize
+
 #elif defined(RTE_CMSIS_RTOS2_FreeRTOS)
   #include "FreeRTOS.h"
 
@@ -87,6 +113,9 @@
 
   /* Event Flags control block size */
   #define OS_EVENTFLAGS_CB_SIZE                   (sizeof(StaticEventGroup_t))
+
+  /* Timer control block size */
+  #define OS_TIMER_CB_SIZE                        (sizeof(StaticTimer_t))
 #endif
 
 /* Thread for pooling and parsing engine execution */
@@ -95,6 +124,9 @@ extern const osThreadAttr_t     Modem_Thread_Attr;
 /* Event flags for signaling events */
 extern const osEventFlagsAttr_t Modem_EventFlags_Attr;
 
+/* Timer for serial receive idle detection */
+extern const osTimerAttr_t      Serial_Timer_Attr;
+
 /* Mutex for socket access protection */
 extern const osMutexAttr_t      Socket_Mutex_Attr;
 
@@ -104,7 +136,38 @@ extern const osMemoryPoolAttr_t Socket_MemPool_Attr;
 /* Memory pool for serial parser */
 extern const osMemoryPoolAttr_t AT_Parser_MemPool_Attr;
 
+#if (SOCKET_LARGE_BLOCK_COUNT != 0)
+/* Large block memory pool for socket data storage */
+extern const osMemoryPoolAttr_t Socket_MemPoolLg_Attr;
+#endif
+
+#if (PARSER_LARGE_BLOCK_COUNT != 0)
+/* Large block memory pool for serial parser */
+extern const osMemoryPoolAttr_t AT_Parser_MemPoolLg_Attr;
+#endif
+
+/* Last good serial baud rate storage (weak, override to persist across power cycles) */
+extern uint32_t Modem_BaudrateLoad  (void);
+extern void     Modem_BaudrateStore (uint32_t baudrate);
+
 /* Memory access mutex */
 extern const osMutexAttr_t      BufList_Mutex_Attr;
 
+/* Memory pool block allocator with usage statistics (MOD_POOL_xxx) */
+extern const BUF_ALLOCATOR      Modem_PoolAllocator;
+
+/* Attach memory pool to statistics slot, NULL detaches */
+extern void    Modem_PoolRegister (uint32_t pool, osMemoryPoolId_t mp_id);
+
+/* Account received data dropped due to insufficient pool space */
+extern void    Modem_PoolDrop     (uint32_t pool, uint32_t num);
+
+/* Retrieve memory pool statistics, 0:ok, -1:invalid pool */
+extern int32_t Modem_PoolGetStats (uint32_t pool, MOD_POOL_STATS *stats);
+
+#if (PARSER_RING_SIZE != 0)
+/* Ring buffer storage for serial parser */
+extern uint8_t                  AT_Parser_RingArr[PARSER_RING_SIZE];
+#endif
+
 #endif /* MOD_EG915U_OS_H__ */